@@ -0,0 +1,304 @@
+#pragma once
+
+#include "execution.hpp"
+#include "pixel_buffer.hpp"
+#include "simd.hpp"
+#include "types_basic.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+namespace pigment {
+
+    // Blend modes on straight (not premultiplied) 8-bit RGBA, following the W3C Compositing and Blending
+    // model: the blend function B(Cb, Cs) mixes backdrop and source where both are present, and the result
+    // is composited source-over onto the backdrop:
+    //
+    //   as  = alpha(top) * opacity * mask
+    //   Cs' = (1 - ab) * Cs + ab * B(Cb, Cs)
+    //   ao  = as + ab * (1 - as)
+    //   Co  = (as * Cs' + (1 - as) * ab * Cb) / ao
+    //
+    // Separable modes apply B to each channel. Hue, Saturation, Color and Luminosity work in HSL: the result
+    // takes the named components from the top layer and the rest from the bottom one. Arithmetic is single
+    // precision; the buffer kernels run at every simd::Level and give exactly the per-pixel results.
+    namespace blend {
+
+        enum class Mode {
+            Normal,
+            Multiply,
+            Screen,
+            Overlay,
+            Darken,
+            Lighten,
+            ColorDodge,
+            ColorBurn,
+            HardLight,
+            SoftLight,
+            Difference,
+            Exclusion,
+            Hue,
+            Saturation,
+            Color,
+            Luminosity
+        };
+
+        inline constexpr Mode all_modes[] = {Mode::Normal,     Mode::Multiply,  Mode::Screen,     Mode::Overlay,
+                                             Mode::Darken,     Mode::Lighten,   Mode::ColorDodge, Mode::ColorBurn,
+                                             Mode::HardLight,  Mode::SoftLight, Mode::Difference, Mode::Exclusion,
+                                             Mode::Hue,        Mode::Saturation, Mode::Color,     Mode::Luminosity};
+
+        inline const char *mode_name(Mode mode) {
+            switch (mode) {
+            case Mode::Normal: return "normal";
+            case Mode::Multiply: return "multiply";
+            case Mode::Screen: return "screen";
+            case Mode::Overlay: return "overlay";
+            case Mode::Darken: return "darken";
+            case Mode::Lighten: return "lighten";
+            case Mode::ColorDodge: return "color-dodge";
+            case Mode::ColorBurn: return "color-burn";
+            case Mode::HardLight: return "hard-light";
+            case Mode::SoftLight: return "soft-light";
+            case Mode::Difference: return "difference";
+            case Mode::Exclusion: return "exclusion";
+            case Mode::Hue: return "hue";
+            case Mode::Saturation: return "saturation";
+            case Mode::Color: return "color";
+            case Mode::Luminosity: return "luminosity";
+            }
+            return "unknown";
+        }
+
+        constexpr bool is_separable(Mode mode) { return mode < Mode::Hue; }
+
+        namespace kernels {
+            using simd::detail::Lanes;
+            using simd::detail::Planes;
+            using simd::detail::Source;
+            using simd::detail::narrow_u8;
+            using simd::detail::planes;
+            using simd::detail::widen_u8;
+
+
+            // Bytes to floats in [0, 1]; the integer widening goes through 16-bit lanes
+            template <int W> PIGMENT_SIMD_INLINE void load(const uint8_t *p, typename Lanes<W>::f32 &out) {
+                typename Lanes<W>::u32 x;
+                widen_u8<W>(p, x);
+                if constexpr (W == 1) {
+                    out = static_cast<float>(x);
+                } else {
+                    out = PIGMENT_SIMD_CONVERT((typename Lanes<W>::i32)x, typename Lanes<W>::f32);
+                }
+                out = out / 255.0f;
+            }
+
+            // [0, 1] back to bytes, rounding half up and clamping
+            template <int W> PIGMENT_SIMD_INLINE void store(uint8_t *p, const typename Lanes<W>::f32 &value) {
+                using F = typename Lanes<W>::f32;
+                const F zero{};
+                F x = value * 255.0f + 0.5f;
+                x = x < 0.0f ? zero : x;
+                x = x > 255.0f ? zero + 255.0f : x;
+                typename Lanes<W>::u32 v;
+                if constexpr (W == 1) {
+                    v = static_cast<uint32_t>(x);
+                } else {
+                    v = (typename Lanes<W>::u32)PIGMENT_SIMD_CONVERT(x, typename Lanes<W>::i32);
+                }
+                narrow_u8<W>(p, v);
+            }
+
+            // B(cb, cs) for one channel of a separable mode
+            template <Mode M, int W>
+            PIGMENT_SIMD_INLINE void separable(const typename Lanes<W>::f32 &cb, const typename Lanes<W>::f32 &cs,
+                                               typename Lanes<W>::f32 &out) {
+                using F = typename Lanes<W>::f32;
+                const F zero{};
+                const F one = zero + 1.0f;
+                if constexpr (M == Mode::Normal) {
+                    out = cs;
+                } else if constexpr (M == Mode::Multiply) {
+                    out = cb * cs;
+                } else if constexpr (M == Mode::Screen) {
+                    out = cb + cs - cb * cs;
+                } else if constexpr (M == Mode::Overlay || M == Mode::HardLight) {
+                    // Overlay is HardLight with the layers swapped
+                    const F &base = M == Mode::Overlay ? cs : cb;
+                    const F &light = M == Mode::Overlay ? cb : cs;
+                    F twice = light * 2.0f;
+                    F dark = base * twice;
+                    twice = twice - 1.0f;
+                    F bright = base + twice - base * twice;
+                    out = light <= 0.5f ? dark : bright;
+                } else if constexpr (M == Mode::Darken) {
+                    out = cs < cb ? cs : cb;
+                } else if constexpr (M == Mode::Lighten) {
+                    out = cs > cb ? cs : cb;
+                } else if constexpr (M == Mode::ColorDodge || M == Mode::ColorBurn) {
+                    // min(1, cb / (1 - cs)) and 1 - min(1, (1 - cb) / cs), with the divisor floored instead of
+                    // special-cased: a zero numerator still wins, as the spec requires
+                    const F floor = zero + 1e-6f;
+                    F num = M == Mode::ColorDodge ? cb : one - cb;
+                    F den = M == Mode::ColorDodge ? one - cs : cs;
+                    den = den < floor ? floor : den;
+                    F q = num / den;
+                    q = q > 1.0f ? one : q;
+                    out = M == Mode::ColorDodge ? q : one - q;
+                } else if constexpr (M == Mode::SoftLight) {
+                    // D(cb) = sqrt(cb) above 0.25, by Newton's method from a linear guess (exact to float
+                    // precision after three steps on [0.25, 1])
+                    F x = cb > 0.25f ? cb : zero + 0.25f;
+                    F root = 0.41f + 0.59f * x;
+                    for (int step = 0; step < 3; ++step) {
+                        root = 0.5f * (root + x / root);
+                    }
+                    F d = cb <= 0.25f ? ((16.0f * cb - 12.0f) * cb + 4.0f) * cb : root;
+                    F dark = cb - (1.0f - 2.0f * cs) * cb * (1.0f - cb);
+                    F bright = cb + (2.0f * cs - 1.0f) * (d - cb);
+                    out = cs <= 0.5f ? dark : bright;
+                } else if constexpr (M == Mode::Difference) {
+                    out = cb > cs ? cb - cs : cs - cb;
+                } else if constexpr (M == Mode::Exclusion) {
+                    out = cb + cs - 2.0f * cb * cs;
+                }
+            }
+
+            template <Mode M, int W>
+            PIGMENT_SIMD_INLINE void blend_block(const Source &top, const Planes &bottom, const uint8_t *mask,
+                                                 size_t i, float opacity) {
+                using F = typename Lanes<W>::f32;
+                const F zero{};
+                F as, ab, m;
+                load<W>(top.c[3] + i, as);
+                load<W>(bottom.c[3] + i, ab);
+                as = as * opacity;
+                if (mask != nullptr) {
+                    load<W>(mask + i, m);
+                    as = as * m;
+                }
+
+                F cs[3], cb[3], mixed[3];
+                for (int k = 0; k < 3; ++k) {
+                    load<W>(top.c[k] + i, cs[k]);
+                    load<W>(bottom.c[k] + i, cb[k]);
+                }
+                if constexpr (is_separable(M)) {
+                    for (int k = 0; k < 3; ++k) {
+                        separable<M, W>(cb[k], cs[k], mixed[k]);
+                    }
+                } else {
+                    F hs, ss, ls, hb, sb, lb;
+                    simd::detail::hsl_from_lanes<W>(cs[0], cs[1], cs[2], hs, ss, ls);
+                    simd::detail::hsl_from_lanes<W>(cb[0], cb[1], cb[2], hb, sb, lb);
+                    const F &h = M == Mode::Hue || M == Mode::Color ? hs : hb;
+                    const F &s = M == Mode::Saturation || M == Mode::Color ? ss : sb;
+                    const F &l = M == Mode::Luminosity ? ls : lb;
+                    simd::detail::hsl_to_lanes<W>(h, s, l, mixed[0], mixed[1], mixed[2]);
+                }
+
+                F ao = as + ab - as * ab;
+                F inv = 1.0f / (ao > 0.0f ? ao : zero + 1.0f);
+                F under = (1.0f - as) * ab;
+                for (int k = 0; k < 3; ++k) {
+                    F src = cs[k] + ab * (mixed[k] - cs[k]);
+                    F co = (as * src + under * cb[k]) * inv;
+                    store<W>(bottom.c[k] + i, ao > 0.0f ? co : zero);
+                }
+                store<W>(bottom.c[3] + i, ao);
+            }
+
+            template <Mode M, int W>
+            PIGMENT_SIMD_INLINE void blend_run(const Source &top, const Planes &bottom, const uint8_t *mask, size_t n,
+                                               float opacity) {
+                size_t i = 0;
+                for (; i + W <= n; i += W) {
+                    blend_block<M, W>(top, bottom, mask, i, opacity);
+                }
+                for (; i < n; ++i) {
+                    blend_block<M, 1>(top, bottom, mask, i, opacity);
+                }
+            }
+
+            // One instantiation per mode, so the mode is resolved once per call instead of per block
+#define PIGMENT_BLEND_CASE(M, W)                                                                                   \
+    case Mode::M:                                                                                                  \
+        return blend_run<Mode::M, W>(top, bottom, mask, n, opacity);
+
+#define PIGMENT_BLEND_DEFINE(suffix, W, ...)                                                                       \
+    __VA_ARGS__ inline void blend_##suffix(Mode mode, const Source &top, const Planes &bottom, const uint8_t *mask, \
+                                           size_t n, float opacity) {                                              \
+        switch (mode) {                                                                                            \
+            PIGMENT_BLEND_CASE(Normal, W)                                                                          \
+            PIGMENT_BLEND_CASE(Multiply, W)                                                                        \
+            PIGMENT_BLEND_CASE(Screen, W)                                                                          \
+            PIGMENT_BLEND_CASE(Overlay, W)                                                                         \
+            PIGMENT_BLEND_CASE(Darken, W)                                                                          \
+            PIGMENT_BLEND_CASE(Lighten, W)                                                                         \
+            PIGMENT_BLEND_CASE(ColorDodge, W)                                                                      \
+            PIGMENT_BLEND_CASE(ColorBurn, W)                                                                       \
+            PIGMENT_BLEND_CASE(HardLight, W)                                                                       \
+            PIGMENT_BLEND_CASE(SoftLight, W)                                                                       \
+            PIGMENT_BLEND_CASE(Difference, W)                                                                      \
+            PIGMENT_BLEND_CASE(Exclusion, W)                                                                       \
+            PIGMENT_BLEND_CASE(Hue, W)                                                                             \
+            PIGMENT_BLEND_CASE(Saturation, W)                                                                      \
+            PIGMENT_BLEND_CASE(Color, W)                                                                           \
+            PIGMENT_BLEND_CASE(Luminosity, W)                                                                      \
+        }                                                                                                          \
+    }
+
+            PIGMENT_BLEND_DEFINE(scalar, 1, )
+#if PIGMENT_SIMD_X86
+            PIGMENT_BLEND_DEFINE(sse41, 4, __attribute__((target("sse4.1"))))
+            PIGMENT_BLEND_DEFINE(avx2, 8, __attribute__((target("avx2"))))
+            PIGMENT_BLEND_DEFINE(avx512, 16, __attribute__((target("avx512f"))))
+#endif
+
+#undef PIGMENT_BLEND_DEFINE
+#undef PIGMENT_BLEND_CASE
+
+            inline void blend(Mode mode, const Source &top, const Planes &bottom, const uint8_t *mask, size_t n,
+                              float opacity, simd::Level level) {
+                PIGMENT_SIMD_SELECT(level, blend, mode, top, bottom, mask, n, opacity)
+            }
+        } // namespace kernels
+
+        // `top` blended onto `bottom`. `mask` (0-255) scales the top layer's alpha like `opacity` does.
+        inline RGBA8 apply(Mode mode, const RGBA8 &top, const RGBA8 &bottom, double opacity = 1.0,
+                           uint8_t mask = 255) {
+            uint8_t t[4] = {top.r, top.g, top.b, top.a};
+            uint8_t b[4] = {bottom.r, bottom.g, bottom.b, bottom.a};
+            kernels::blend(mode, {{t, t + 1, t + 2, t + 3}}, {{b, b + 1, b + 2, b + 3}}, &mask, 1,
+                           static_cast<float>(std::clamp(opacity, 0.0, 1.0)), simd::Level::Scalar);
+            return RGBA8(b[0], b[1], b[2], b[3]);
+        }
+
+        // Blends `top` onto `bottom` in place. `mask`, when not empty, holds one coverage byte per pixel in
+        // row-major order.
+        template <execution::ExecutionPolicy Policy>
+        void apply(const Policy &policy, Mode mode, const PixelBuffer &top, PixelBuffer &bottom, double opacity = 1.0,
+                   std::span<const uint8_t> mask = {}, simd::Level level = simd::detected_level()) {
+            if (top.width() != bottom.width() || top.height() != bottom.height()) {
+                throw std::invalid_argument("blend: images differ in size");
+            }
+            if (!mask.empty() && mask.size() != bottom.size()) {
+                throw std::invalid_argument("blend: mask size does not match the images");
+            }
+            const float alpha = static_cast<float>(std::clamp(opacity, 0.0, 1.0));
+            execution::for_each_chunk(policy, bottom.size(), execution::chunk_for<RGBA8>(), [&](size_t lo, size_t hi) {
+                kernels::blend(mode, kernels::planes(top, lo), kernels::planes(bottom, lo),
+                               mask.empty() ? nullptr : mask.data() + lo, hi - lo, alpha, level);
+            });
+        }
+
+        inline void apply(Mode mode, const PixelBuffer &top, PixelBuffer &bottom, double opacity = 1.0,
+                          std::span<const uint8_t> mask = {}, simd::Level level = simd::detected_level()) {
+            apply(execution::seq, mode, top, bottom, opacity, mask, level);
+        }
+
+    } // namespace blend
+} // namespace pigment
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "execution.hpp"
+#include "pixel_buffer.hpp"
+#include "simd.hpp"
+#include "transfer.hpp"
+#include "types_basic.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace pigment {
+    namespace utils {
+
+        namespace detail {
+            // Machado, Oliveira & Fernandes (2009) simulation matrices for linear RGB, indexed by cone
+            // (protan, deutan, tritan) and severity in steps of 0.1. Each row sums to one, so grays are kept.
+            inline constexpr float machado[3][11][9] = {
+                {
+                    {1.000000f, 0.000000f, 0.000000f, 0.000000f, 1.000000f, 0.000000f, 0.000000f, 0.000000f, 1.000000f},
+                    {0.856167f, 0.182038f, -0.038205f, 0.029342f, 0.955115f, 0.015544f, -0.002880f, -0.001563f, 1.004443f},
+                    {0.734766f, 0.334872f, -0.069637f, 0.051840f, 0.919198f, 0.028963f, -0.004928f, -0.004209f, 1.009137f},
+                    {0.630323f, 0.465641f, -0.095964f, 0.069181f, 0.890046f, 0.040773f, -0.006308f, -0.007724f, 1.014032f},
+                    {0.539009f, 0.579343f, -0.118352f, 0.082546f, 0.866121f, 0.051332f, -0.007136f, -0.011959f, 1.019095f},
+                    {0.458064f, 0.679578f, -0.137642f, 0.092785f, 0.846313f, 0.060902f, -0.007494f, -0.016807f, 1.024301f},
+                    {0.385450f, 0.769005f, -0.154455f, 0.100526f, 0.829802f, 0.069673f, -0.007442f, -0.022190f, 1.029632f},
+                    {0.319627f, 0.849633f, -0.169261f, 0.106241f, 0.815969f, 0.077790f, -0.007025f, -0.028051f, 1.035076f},
+                    {0.259411f, 0.923008f, -0.182420f, 0.110296f, 0.804340f, 0.085364f, -0.006276f, -0.034346f, 1.040622f},
+                    {0.203876f, 0.990338f, -0.194214f, 0.112975f, 0.794542f, 0.092483f, -0.005222f, -0.041043f, 1.046265f},
+                    {0.152286f, 1.052583f, -0.204868f, 0.114503f, 0.786281f, 0.099216f, -0.003882f, -0.048116f, 1.051998f},
+                },
+                {
+                    {1.000000f, 0.000000f, 0.000000f, 0.000000f, 1.000000f, 0.000000f, 0.000000f, 0.000000f, 1.000000f},
+                    {0.866435f, 0.177704f, -0.044139f, 0.049567f, 0.939063f, 0.011370f, -0.003453f, 0.007233f, 0.996220f},
+                    {0.760729f, 0.319078f, -0.079807f, 0.090568f, 0.889315f, 0.020117f, -0.006027f, 0.013325f, 0.992702f},
+                    {0.675425f, 0.433850f, -0.109275f, 0.125303f, 0.847755f, 0.026942f, -0.007950f, 0.018572f, 0.989378f},
+                    {0.605511f, 0.528560f, -0.134071f, 0.155318f, 0.812366f, 0.032316f, -0.009376f, 0.023176f, 0.986200f},
+                    {0.547494f, 0.607765f, -0.155259f, 0.181692f, 0.781742f, 0.036566f, -0.010410f, 0.027275f, 0.983136f},
+                    {0.498864f, 0.674741f, -0.173604f, 0.205199f, 0.754872f, 0.039929f, -0.011131f, 0.030969f, 0.980162f},
+                    {0.457771f, 0.731899f, -0.189670f, 0.226409f, 0.731012f, 0.042579f, -0.011595f, 0.034333f, 0.977261f},
+                    {0.422823f, 0.781057f, -0.203881f, 0.245752f, 0.709602f, 0.044646f, -0.011843f, 0.037423f, 0.974421f},
+                    {0.392952f, 0.823610f, -0.216562f, 0.263559f, 0.690210f, 0.046232f, -0.011910f, 0.040281f, 0.971630f},
+                    {0.367322f, 0.860646f, -0.227968f, 0.280085f, 0.672501f, 0.047413f, -0.011820f, 0.042940f, 0.968881f},
+                },
+                {
+                    {1.000000f, 0.000000f, 0.000000f, 0.000000f, 1.000000f, 0.000000f, 0.000000f, 0.000000f, 1.000000f},
+                    {0.926670f, 0.092514f, -0.019184f, 0.021191f, 0.964503f, 0.014306f, 0.008437f, 0.054813f, 0.936750f},
+                    {0.895720f, 0.133330f, -0.029050f, 0.029997f, 0.945400f, 0.024603f, 0.013027f, 0.104707f, 0.882266f},
+                    {0.905871f, 0.127791f, -0.033662f, 0.026856f, 0.941251f, 0.031893f, 0.013410f, 0.148296f, 0.838294f},
+                    {0.948035f, 0.089490f, -0.037526f, 0.014364f, 0.946792f, 0.038844f, 0.010853f, 0.193991f, 0.795156f},
+                    {1.017277f, 0.027029f, -0.044306f, -0.006113f, 0.958479f, 0.047634f, 0.006379f, 0.248708f, 0.744913f},
+                    {1.104996f, -0.046633f, -0.058363f, -0.032137f, 0.971635f, 0.060503f, 0.001336f, 0.317922f, 0.680742f},
+                    {1.193214f, -0.109812f, -0.083402f, -0.058496f, 0.979410f, 0.079086f, -0.002346f, 0.403492f, 0.598854f},
+                    {1.257728f, -0.139648f, -0.118081f, -0.078003f, 0.975409f, 0.102594f, -0.003316f, 0.501214f, 0.502102f},
+                    {1.278864f, -0.125333f, -0.153531f, -0.084748f, 0.957674f, 0.127074f, -0.000989f, 0.601151f, 0.399838f},
+                    {1.255528f, -0.076749f, -0.178779f, -0.078411f, 0.930809f, 0.147602f, 0.004733f, 0.691367f, 0.303900f},
+                },
+            };
+
+            // Everything a simulation pass needs, resolved once per call
+            struct CvdKernel {
+                float m[9];
+                const float *decode;
+                const uint8_t *encode;
+            };
+
+            using simd::detail::Lanes;
+
+            // Decode bytes to linear light, one table lookup per lane
+            template <int W>
+            PIGMENT_SIMD_INLINE void cvd_decode(const float *table, const uint8_t *p, typename Lanes<W>::f32 &out) {
+                if constexpr (W == 1) {
+                    out = table[*p];
+                } else {
+                    float lanes[W];
+                    for (int j = 0; j < W; ++j) {
+                        lanes[j] = table[p[j]];
+                    }
+                    std::memcpy(&out, lanes, sizeof(out));
+                }
+            }
+
+            // Clamp to [0, 1], quantize to 16 bits and encode back to sRGB bytes
+            template <int W>
+            PIGMENT_SIMD_INLINE void cvd_encode(const uint8_t *table, const typename Lanes<W>::f32 &value, uint8_t *p) {
+                using F = typename Lanes<W>::f32;
+                const F zero{};
+                F v = value < 0.0f ? zero : value;
+                v = v > 1.0f ? zero + 1.0f : v;
+                v = v * static_cast<float>(transfer::detail::encode8_steps) + 0.5f;
+                if constexpr (W == 1) {
+                    *p = table[static_cast<int32_t>(v)];
+                } else {
+                    const auto q = PIGMENT_SIMD_CONVERT(v, typename Lanes<W>::i32);
+                    for (int j = 0; j < W; ++j) {
+                        p[j] = table[q[j]];
+                    }
+                }
+            }
+
+            template <int W>
+            PIGMENT_SIMD_INLINE void cvd_block(const CvdKernel &k, const uint8_t *const *in, uint8_t *const *out,
+                                               size_t i) {
+                using F = typename Lanes<W>::f32;
+                F r, g, b;
+                cvd_decode<W>(k.decode, in[0] + i, r);
+                cvd_decode<W>(k.decode, in[1] + i, g);
+                cvd_decode<W>(k.decode, in[2] + i, b);
+                cvd_encode<W>(k.encode, k.m[0] * r + k.m[1] * g + k.m[2] * b, out[0] + i);
+                cvd_encode<W>(k.encode, k.m[3] * r + k.m[4] * g + k.m[5] * b, out[1] + i);
+                cvd_encode<W>(k.encode, k.m[6] * r + k.m[7] * g + k.m[8] * b, out[2] + i);
+            }
+
+#define PIGMENT_CVD_DEFINE(suffix, W, ...)                                                                         \
+    __VA_ARGS__ inline void cvd_##suffix(const CvdKernel &k, const uint8_t *const *in, uint8_t *const *out,          \
+                                         size_t n) {                                                               \
+        size_t i = 0;                                                                                              \
+        for (; i + W <= n; i += W) {                                                                               \
+            cvd_block<W>(k, in, out, i);                                                                           \
+        }                                                                                                          \
+        for (; i < n; ++i) {                                                                                       \
+            cvd_block<1>(k, in, out, i);                                                                           \
+        }                                                                                                          \
+    }
+
+            PIGMENT_CVD_DEFINE(scalar, 1, )
+#if PIGMENT_SIMD_X86
+            PIGMENT_CVD_DEFINE(sse41, 4, __attribute__((target("sse4.1"))))
+            PIGMENT_CVD_DEFINE(avx2, 8, __attribute__((target("avx2"))))
+            PIGMENT_CVD_DEFINE(avx512, 16, __attribute__((target("avx512f"))))
+#endif
+
+#undef PIGMENT_CVD_DEFINE
+
+            // Simulates `n` pixels from the R, G, B planes `in` into `out`; alpha is left to the caller
+            inline void cvd(const CvdKernel &k, const uint8_t *const *in, uint8_t *const *out, size_t n,
+                            simd::Level level) {
+                PIGMENT_SIMD_SELECT(level, cvd, k, in, out, n)
+            }
+        } // namespace detail
+
+        // Color vision deficiency simulation after Machado et al. (2009): a 3x3 matrix applied in linear light.
+        // Severity runs from 0 (normal vision) to 1 (dichromacy) and picks between the published matrices,
+        // which are tabulated in steps of 0.1 and interpolated in between. The type selects the affected cone;
+        // -opia and -omaly types only differ in their default severity.
+        struct ColorBlindness {
+            enum Type {
+                PROTANOPIA,    // Red blind
+                DEUTERANOPIA,  // Green blind
+                TRITANOPIA,    // Blue blind
+                PROTANOMALY,   // Red weak
+                DEUTERANOMALY, // Green weak
+                TRITANOMALY    // Blue weak
+            };
+
+            // Row-major, linear RGB in and out
+            using Matrix = std::array<float, 9>;
+
+            static constexpr double default_severity(Type type) { return type < PROTANOMALY ? 1.0 : 0.5; }
+
+            static Matrix matrix(Type type, double severity) {
+                const double s = severity > 0.0 ? std::min(severity, 1.0) * 10.0 : 0.0;
+                const int step = std::min(static_cast<int>(s), 9);
+                const double t = s - step;
+                const float *lo = detail::machado[type % 3][step];
+                const float *hi = detail::machado[type % 3][step + 1];
+                Matrix m;
+                for (int k = 0; k < 9; ++k) {
+                    m[k] = static_cast<float>(lo[k] + (hi[k] - lo[k]) * t);
+                }
+                return m;
+            }
+
+            static RGB simulate(const RGB &color, Type type) { return simulate(color, type, default_severity(type)); }
+
+            static RGB simulate(const RGB &color, Type type, double severity) {
+                auto channel = [](int v) { return static_cast<uint8_t>(std::clamp(v, 0, 255)); };
+                const uint8_t in[3] = {channel(color.r), channel(color.g), channel(color.b)};
+                uint8_t out[3];
+                const uint8_t *const in_planes[3] = {in, in + 1, in + 2};
+                uint8_t *const out_planes[3] = {out, out + 1, out + 2};
+                detail::cvd(kernel(type, severity), in_planes, out_planes, 1, simd::Level::Scalar);
+                return RGB(out[0], out[1], out[2], color.a);
+            }
+
+            // Whole image in one matrix pass, with exactly the per-color results; `out` may be `in`
+            template <execution::ExecutionPolicy Policy>
+            static void simulate(const Policy &policy, const PixelBuffer &in, PixelBuffer &out, Type type,
+                                 double severity, simd::Level level = simd::detected_level()) {
+                if (&out != &in && (out.width() != in.width() || out.height() != in.height())) {
+                    out = PixelBuffer(in.width(), in.height());
+                }
+                const detail::CvdKernel k = kernel(type, severity);
+                const uint8_t *a = in.plane(PixelBuffer::A);
+                uint8_t *a_out = out.plane(PixelBuffer::A);
+                execution::for_each_chunk(policy, in.size(), execution::chunk_for<RGBA8>(), [&](size_t lo, size_t hi) {
+                    const uint8_t *const src[3] = {in.plane(PixelBuffer::R) + lo, in.plane(PixelBuffer::G) + lo,
+                                                   in.plane(PixelBuffer::B) + lo};
+                    uint8_t *const dst[3] = {out.plane(PixelBuffer::R) + lo, out.plane(PixelBuffer::G) + lo,
+                                             out.plane(PixelBuffer::B) + lo};
+                    detail::cvd(k, src, dst, hi - lo, level);
+                    if (a_out != a) {
+                        std::memcpy(a_out + lo, a + lo, hi - lo);
+                    }
+                });
+            }
+
+            static void simulate(const PixelBuffer &in, PixelBuffer &out, Type type, double severity,
+                                 simd::Level level = simd::detected_level()) {
+                simulate(execution::seq, in, out, type, severity, level);
+            }
+
+            template <execution::ExecutionPolicy Policy>
+            static void simulate(const Policy &policy, PixelBuffer &image, Type type, double severity,
+                                 simd::Level level = simd::detected_level()) {
+                simulate(policy, image, image, type, severity, level);
+            }
+
+            static void simulate(PixelBuffer &image, Type type, double severity,
+                                 simd::Level level = simd::detected_level()) {
+                simulate(execution::seq, image, image, type, severity, level);
+            }
+
+          private:
+            static detail::CvdKernel kernel(Type type, double severity) {
+                detail::CvdKernel k;
+                const Matrix m = matrix(type, severity);
+                std::copy(m.begin(), m.end(), k.m);
+                k.decode = transfer::detail::decode_table_f32().data();
+                k.encode = transfer::detail::encode8_table().data();
+                return k;
+            }
+        };
+
+    } // namespace utils
+} // namespace pigment
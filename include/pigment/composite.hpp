@@ -0,0 +1,389 @@
+#pragma once
+
+#include "execution.hpp"
+#include "pixel_buffer.hpp"
+#include "simd.hpp"
+#include "types_basic.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+namespace pigment {
+
+    // Porter-Duff compositing on premultiplied 8-bit RGBA. A premultiplied pixel stores each color channel
+    // already multiplied by alpha (c' = c * a / 255), which makes every operator a weighted sum of source
+    // and destination:
+    //
+    //   result = src * Fa + dst * Fb        (all four channels)
+    //
+    //   Over   Fa = 1        Fb = 1 - As
+    //   In     Fa = Ad       Fb = 0
+    //   Out    Fa = 1 - Ad   Fb = 0
+    //   Atop   Fa = Ad       Fb = 1 - As
+    //   Xor    Fa = 1 - Ad   Fb = 1 - As
+    //
+    // Products are divided by 255 with rounding to nearest. The buffer functions run integer SIMD kernels
+    // (selected like the simd:: batch kernels) and give exactly the per-pixel results of the scalar
+    // functions. flatten() composites a stack of layers tile by tile: each canvas tile stays in cache while
+    // every layer is applied to it, and no intermediate image is made per layer.
+    namespace composite {
+
+        enum class Op { Over, In, Out, Atop, Xor };
+
+        namespace detail {
+            // round(x / 255) for 0 <= x <= 65535
+            constexpr uint32_t div255(uint32_t x) { return (x + 128 + ((x + 128) >> 8)) >> 8; }
+
+            constexpr uint32_t factor_src(Op op, uint32_t dst_alpha) {
+                switch (op) {
+                case Op::In:
+                case Op::Atop: return dst_alpha;
+                case Op::Out:
+                case Op::Xor: return 255 - dst_alpha;
+                default: return 255;
+                }
+            }
+
+            constexpr uint32_t factor_dst(Op op, uint32_t src_alpha) {
+                return op == Op::In || op == Op::Out ? 0 : 255 - src_alpha;
+            }
+
+            // src * fa + dst * fb, saturated for inputs that are not validly premultiplied
+            constexpr uint8_t weigh(uint32_t src, uint32_t fa, uint32_t dst, uint32_t fb) {
+                return static_cast<uint8_t>(div255(std::min<uint32_t>(src * fa + dst * fb, 255 * 255)));
+            }
+        } // namespace detail
+
+        constexpr RGBA8 premultiply(const RGBA8 &c) {
+            return RGBA8(static_cast<uint8_t>(detail::div255(c.r * uint32_t(c.a))),
+                         static_cast<uint8_t>(detail::div255(c.g * uint32_t(c.a))),
+                         static_cast<uint8_t>(detail::div255(c.b * uint32_t(c.a))), c.a);
+        }
+
+        // Rounds to nearest; fully transparent pixels become transparent black
+        constexpr RGBA8 unpremultiply(const RGBA8 &c) {
+            if (c.a == 0) {
+                return RGBA8(0, 0, 0, 0);
+            }
+            auto channel = [&](uint8_t v) {
+                return static_cast<uint8_t>(std::min<uint32_t>(255, (v * 255u + c.a / 2u) / c.a));
+            };
+            return RGBA8(channel(c.r), channel(c.g), channel(c.b), c.a);
+        }
+
+        // src op dst, both premultiplied. `opacity` (0-255) scales the source first.
+        constexpr RGBA8 apply(Op op, const RGBA8 &src, const RGBA8 &dst, uint8_t opacity = 255) {
+            const RGBA8 s(static_cast<uint8_t>(detail::div255(src.r * uint32_t(opacity))),
+                          static_cast<uint8_t>(detail::div255(src.g * uint32_t(opacity))),
+                          static_cast<uint8_t>(detail::div255(src.b * uint32_t(opacity))),
+                          static_cast<uint8_t>(detail::div255(src.a * uint32_t(opacity))));
+            const uint32_t fa = detail::factor_src(op, dst.a), fb = detail::factor_dst(op, s.a);
+            return RGBA8(detail::weigh(s.r, fa, dst.r, fb), detail::weigh(s.g, fa, dst.g, fb),
+                         detail::weigh(s.b, fa, dst.b, fb), detail::weigh(s.a, fa, dst.a, fb));
+        }
+
+        namespace kernels {
+            using simd::detail::Lanes;
+            using simd::detail::Planes;
+            using simd::detail::Source;
+            using simd::detail::narrow_u8;
+            using simd::detail::planes;
+            using simd::detail::widen_u8;
+
+            // The integer kernels work in 16-bit lanes: every product of two bytes, and the clamped sums, fit
+            template <int W> PIGMENT_SIMD_INLINE void load(const uint8_t *p, typename Lanes<W>::u16 &out) {
+                typename Lanes<W>::u8 v;
+                std::memcpy(&v, p, sizeof(v));
+                if constexpr (W == 1) {
+                    out = v;
+                } else {
+                    out = PIGMENT_SIMD_CONVERT(v, typename Lanes<W>::u16);
+                }
+            }
+
+            template <int W> PIGMENT_SIMD_INLINE void store(uint8_t *p, const typename Lanes<W>::u16 &x) {
+                typename Lanes<W>::u8 v;
+                if constexpr (W == 1) {
+                    v = static_cast<uint8_t>(x);
+                } else {
+                    v = PIGMENT_SIMD_CONVERT(x, typename Lanes<W>::u8);
+                }
+                std::memcpy(p, &v, sizeof(v));
+            }
+
+            // round(x / 255) for x <= 255 * 255; no intermediate exceeds 16 bits
+            template <int W> PIGMENT_SIMD_INLINE void div255(typename Lanes<W>::u16 &x) {
+                using U = typename Lanes<W>::u16;
+                x = static_cast<U>(x + 128);
+                x = static_cast<U>((x + (x >> 8)) >> 8);
+            }
+
+
+            template <int W> PIGMENT_SIMD_INLINE void premultiply_block(const Planes &p, size_t i) {
+                typename Lanes<W>::u16 a, x;
+                load<W>(p.c[3] + i, a);
+                for (int k = 0; k < 3; ++k) {
+                    load<W>(p.c[k] + i, x);
+                    x = x * a;
+                    div255<W>(x);
+                    store<W>(p.c[k] + i, x);
+                }
+            }
+
+            // Division in single precision: 255 * c / a is never within float rounding of a half, so
+            // truncating q + 0.5 rounds exactly like the integer formula
+            template <int W> PIGMENT_SIMD_INLINE void unpremultiply_block(const Planes &p, size_t i) {
+                using U = typename Lanes<W>::u32;
+                using I = typename Lanes<W>::i32;
+                using F = typename Lanes<W>::f32;
+                U a, x;
+                widen_u8<W>(p.c[3] + i, a);
+                F fa;
+                if constexpr (W == 1) {
+                    fa = static_cast<float>(a);
+                } else {
+                    fa = PIGMENT_SIMD_CONVERT((I)a, F);
+                }
+                const F zero{};
+                for (int k = 0; k < 3; ++k) {
+                    widen_u8<W>(p.c[k] + i, x);
+                    F q;
+                    if constexpr (W == 1) {
+                        q = a == 0 ? 0.0f : std::min(static_cast<float>(x * 255u) / fa, 255.0f) + 0.5f;
+                        x = static_cast<uint32_t>(q);
+                    } else {
+                        q = PIGMENT_SIMD_CONVERT((I)(x * 255u), F) / (fa == zero ? zero + 1.0f : fa);
+                        q = (q > 255.0f ? zero + 255.0f : q) + 0.5f;
+                        q = fa == zero ? zero : q;
+                        x = (U)PIGMENT_SIMD_CONVERT(q, I);
+                    }
+                    narrow_u8<W>(p.c[k] + i, x);
+                }
+            }
+
+            template <int W>
+            PIGMENT_SIMD_INLINE void porter_duff_block(Op op, const Source &src, const Planes &dst, size_t i,
+                                                       uint32_t opacity) {
+                using U = typename Lanes<W>::u16;
+                const U zero{};
+                const U full = static_cast<U>(zero + 255);
+                const U limit = static_cast<U>(zero + 255 * 255);
+                U sa, da, fa, fb, s, d, x, y;
+                load<W>(src.c[3] + i, sa);
+                sa = static_cast<U>(sa * static_cast<uint16_t>(opacity));
+                div255<W>(sa);
+                load<W>(dst.c[3] + i, da);
+                fa = op == Op::Over ? full : (op == Op::In || op == Op::Atop ? da : static_cast<U>(full - da));
+                fb = op == Op::In || op == Op::Out ? zero : static_cast<U>(full - sa);
+                for (int k = 0; k < 4; ++k) {
+                    if (k < 3) {
+                        load<W>(src.c[k] + i, s);
+                        s = static_cast<U>(s * static_cast<uint16_t>(opacity));
+                        div255<W>(s);
+                    } else {
+                        s = sa;
+                    }
+                    load<W>(dst.c[k] + i, d);
+                    // Both products are at most 255 * 255; the sum saturates there (it can only exceed it for
+                    // input that is not premultiplied) without leaving 16 bits
+                    x = static_cast<U>(s * fa);
+                    y = static_cast<U>(d * fb);
+                    const U room = static_cast<U>(limit - x);
+                    x = static_cast<U>(x + (y < room ? y : room));
+                    div255<W>(x);
+                    store<W>(dst.c[k] + i, x);
+                }
+            }
+
+#define PIGMENT_COMPOSITE_DEFINE(suffix, W, ...)                                                                   \
+    __VA_ARGS__ inline void premultiply_##suffix(const Planes &p, size_t n) {                                      \
+        size_t i = 0;                                                                                              \
+        for (; i + (W) <= n; i += (W))                                                                             \
+            premultiply_block<W>(p, i);                                                                            \
+        for (; i < n; ++i)                                                                                         \
+            premultiply_block<1>(p, i);                                                                            \
+    }                                                                                                              \
+    __VA_ARGS__ inline void unpremultiply_##suffix(const Planes &p, size_t n) {                                    \
+        size_t i = 0;                                                                                              \
+        for (; i + (W) <= n; i += (W))                                                                             \
+            unpremultiply_block<W>(p, i);                                                                          \
+        for (; i < n; ++i)                                                                                         \
+            unpremultiply_block<1>(p, i);                                                                          \
+    }                                                                                                              \
+    __VA_ARGS__ inline void porter_duff_##suffix(Op op, const Source &src, const Planes &dst, size_t n,            \
+                                                 uint32_t opacity) {                                               \
+        size_t i = 0;                                                                                              \
+        for (; i + (W) <= n; i += (W))                                                                             \
+            porter_duff_block<W>(op, src, dst, i, opacity);                                                        \
+        for (; i < n; ++i)                                                                                         \
+            porter_duff_block<1>(op, src, dst, i, opacity);                                                        \
+    }
+
+            PIGMENT_COMPOSITE_DEFINE(scalar, 1, )
+#if PIGMENT_SIMD_X86
+            PIGMENT_COMPOSITE_DEFINE(sse41, 16, __attribute__((target("sse4.1"))))
+            PIGMENT_COMPOSITE_DEFINE(avx2, 32, __attribute__((target("avx2"))))
+            PIGMENT_COMPOSITE_DEFINE(avx512, 64, __attribute__((target("avx512f"))))
+#endif
+
+#undef PIGMENT_COMPOSITE_DEFINE
+
+            inline void premultiply(const Planes &p, size_t n, simd::Level level) {
+                PIGMENT_SIMD_SELECT(level, premultiply, p, n)
+            }
+
+            inline void unpremultiply(const Planes &p, size_t n, simd::Level level) {
+                PIGMENT_SIMD_SELECT(level, unpremultiply, p, n)
+            }
+
+            inline void porter_duff(Op op, const Source &src, const Planes &dst, size_t n, uint32_t opacity,
+                                    simd::Level level) {
+                PIGMENT_SIMD_SELECT(level, porter_duff, op, src, dst, n, opacity)
+            }
+        } // namespace kernels
+
+        // Whole-image conversions, in place
+        template <execution::ExecutionPolicy Policy>
+        void premultiply(const Policy &policy, PixelBuffer &image, simd::Level level = simd::detected_level()) {
+            execution::for_each_chunk(policy, image.size(), execution::chunk_for<RGBA8>(), [&](size_t lo, size_t hi) {
+                kernels::premultiply(kernels::planes(image, lo), hi - lo, level);
+            });
+        }
+
+        inline void premultiply(PixelBuffer &image, simd::Level level = simd::detected_level()) {
+            premultiply(execution::seq, image, level);
+        }
+
+        template <execution::ExecutionPolicy Policy>
+        void unpremultiply(const Policy &policy, PixelBuffer &image, simd::Level level = simd::detected_level()) {
+            execution::for_each_chunk(policy, image.size(), execution::chunk_for<RGBA8>(), [&](size_t lo, size_t hi) {
+                kernels::unpremultiply(kernels::planes(image, lo), hi - lo, level);
+            });
+        }
+
+        inline void unpremultiply(PixelBuffer &image, simd::Level level = simd::detected_level()) {
+            unpremultiply(execution::seq, image, level);
+        }
+
+        // dst = src op dst over images of the same size, both premultiplied
+        template <execution::ExecutionPolicy Policy>
+        void apply(const Policy &policy, Op op, const PixelBuffer &src, PixelBuffer &dst, double opacity = 1.0,
+                   simd::Level level = simd::detected_level()) {
+            if (src.width() != dst.width() || src.height() != dst.height()) {
+                throw std::invalid_argument("composite: images differ in size");
+            }
+            const uint32_t alpha = static_cast<uint32_t>(pigment::detail::round(std::clamp(opacity, 0.0, 1.0) * 255));
+            execution::for_each_chunk(policy, dst.size(), execution::chunk_for<RGBA8>(), [&](size_t lo, size_t hi) {
+                kernels::porter_duff(op, kernels::planes(src, lo), kernels::planes(dst, lo), hi - lo, alpha, level);
+            });
+        }
+
+        inline void apply(Op op, const PixelBuffer &src, PixelBuffer &dst, double opacity = 1.0,
+                          simd::Level level = simd::detected_level()) {
+            apply(execution::seq, op, src, dst, opacity, level);
+        }
+
+        // One premultiplied image in a stack, placed with its top-left pixel at (x, y) on the canvas.
+        // Outside its bounds a layer is transparent, so In and Out clear the canvas there.
+        struct Layer {
+            const PixelBuffer *image = nullptr;
+            Op op = Op::Over;
+            double opacity = 1.0;
+            ptrdiff_t x = 0;
+            ptrdiff_t y = 0;
+
+            Layer() = default;
+            Layer(const PixelBuffer &image_, Op op_ = Op::Over, double opacity_ = 1.0, ptrdiff_t x_ = 0,
+                  ptrdiff_t y_ = 0)
+                : image(&image_), op(op_), opacity(opacity_), x(x_), y(y_) {}
+        };
+
+        // Canvas tiles are full-width bands of about this many bytes (all four planes), so a tile stays in L2
+        // while every layer is applied and each layer is read in long contiguous rows
+        inline constexpr size_t tile_bytes = 128 * 1024;
+
+        // Composites layers[0], layers[1], ... in order onto `canvas` (premultiplied), bottom layer first.
+        // Tiles are independent tasks; the result does not depend on the policy.
+        template <execution::ExecutionPolicy Policy>
+        void flatten(const Policy &policy, std::span<const Layer> layers, PixelBuffer &canvas,
+                     simd::Level level = simd::detected_level()) {
+            for (const Layer &layer : layers) {
+                if (layer.image == nullptr) {
+                    throw std::invalid_argument("composite: layer without an image");
+                }
+            }
+            const ptrdiff_t width = static_cast<ptrdiff_t>(canvas.width());
+            const ptrdiff_t height = static_cast<ptrdiff_t>(canvas.height());
+            const size_t band = std::max<size_t>(1, tile_bytes / (PixelBuffer::channels * std::max<size_t>(1, canvas.width())));
+            const size_t tiles = (canvas.height() + band - 1) / band;
+
+            execution::for_each_chunk(policy, tiles, 1, [&](size_t lo, size_t hi) {
+                for (size_t tile = lo; tile < hi; ++tile) {
+                    const ptrdiff_t x0 = 0, x1 = width;
+                    const ptrdiff_t y0 = static_cast<ptrdiff_t>(tile * band);
+                    const ptrdiff_t y1 = std::min(height, y0 + static_cast<ptrdiff_t>(band));
+
+                    for (const Layer &layer : layers) {
+                        const PixelBuffer &image = *layer.image;
+                        const uint32_t alpha =
+                            static_cast<uint32_t>(pigment::detail::round(std::clamp(layer.opacity, 0.0, 1.0) * 255));
+                        const bool clears = layer.op == Op::In || layer.op == Op::Out;
+                        // Part of the tile the layer covers
+                        const ptrdiff_t lx0 = std::max(x0, layer.x);
+                        const ptrdiff_t ly0 = std::max(y0, layer.y);
+                        const ptrdiff_t lx1 = std::min(x1, layer.x + static_cast<ptrdiff_t>(image.width()));
+                        const ptrdiff_t ly1 = std::min(y1, layer.y + static_cast<ptrdiff_t>(image.height()));
+                        const bool covered = lx0 < lx1 && ly0 < ly1;
+
+                        for (ptrdiff_t y = y0; y < y1; ++y) {
+                            const size_t row = static_cast<size_t>(y * width);
+                            if (!covered || y < ly0 || y >= ly1) {
+                                if (clears) {
+                                    for (size_t k = 0; k < 4; ++k) {
+                                        std::memset(canvas.plane(k) + row + x0, 0, static_cast<size_t>(x1 - x0));
+                                    }
+                                }
+                                continue;
+                            }
+                            if (clears) {
+                                for (size_t k = 0; k < 4; ++k) {
+                                    std::memset(canvas.plane(k) + row + x0, 0, static_cast<size_t>(lx0 - x0));
+                                    std::memset(canvas.plane(k) + row + lx1, 0, static_cast<size_t>(x1 - lx1));
+                                }
+                            }
+                            const size_t src = static_cast<size_t>((y - layer.y) * static_cast<ptrdiff_t>(image.width()) +
+                                                                   (lx0 - layer.x));
+                            kernels::porter_duff(layer.op, kernels::planes(image, src),
+                                                 kernels::planes(canvas, row + static_cast<size_t>(lx0)),
+                                                 static_cast<size_t>(lx1 - lx0), alpha, level);
+                        }
+                    }
+                }
+            });
+        }
+
+        inline void flatten(std::span<const Layer> layers, PixelBuffer &canvas,
+                            simd::Level level = simd::detected_level()) {
+            flatten(execution::seq, layers, canvas, level);
+        }
+
+        // Onto a transparent canvas of the given size
+        template <execution::ExecutionPolicy Policy>
+        PixelBuffer flatten(const Policy &policy, std::span<const Layer> layers, size_t width, size_t height,
+                            simd::Level level = simd::detected_level()) {
+            PixelBuffer canvas(width, height);
+            std::fill(canvas.plane(PixelBuffer::A), canvas.plane(PixelBuffer::A) + canvas.size(), uint8_t(0));
+            flatten(policy, layers, canvas, level);
+            return canvas;
+        }
+
+        inline PixelBuffer flatten(std::span<const Layer> layers, size_t width, size_t height,
+                                   simd::Level level = simd::detected_level()) {
+            return flatten(execution::seq, layers, width, height, level);
+        }
+
+    } // namespace composite
+} // namespace pigment
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "execution.hpp"
+#include "transfer.hpp"
+#include "types_basic.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace pigment {
+    namespace utils {
+
+        // WCAG 2.x relative luminance, 0 for black to 1 for white. WCAG's 0.03928 decode threshold and the
+        // 0.04045 of IEC 61966-2-1 fall between the same two 8-bit values, so the shared decode table is exact.
+        inline double relative_luminance(const RGB &color) {
+            return 0.2126 * transfer::srgb_to_linear(color.r) + 0.7152 * transfer::srgb_to_linear(color.g) +
+                   0.0722 * transfer::srgb_to_linear(color.b);
+        }
+
+        // WCAG contrast ratio of two relative luminances, from 1 to 21; the order does not matter
+        inline double luminance_contrast(double lum1, double lum2) {
+            // Ensure lum1 is the lighter color
+            if (lum1 < lum2)
+                std::swap(lum1, lum2);
+
+            return (lum1 + 0.05) / (lum2 + 0.05);
+        }
+
+        // Contrast calculation
+        inline double contrast_ratio(const RGB &color1, const RGB &color2) {
+            return luminance_contrast(relative_luminance(color1), relative_luminance(color2));
+        }
+
+        // Check WCAG accessibility compliance
+        struct AccessibilityLevel {
+            enum Level {
+                FAIL,
+                AA_NORMAL,  // 4.5:1
+                AA_LARGE,   // 3:1 for large text
+                AAA_NORMAL, // 7:1
+                AAA_LARGE   // 4.5:1 for large text
+            };
+        };
+
+        inline AccessibilityLevel::Level accessibility_level(double ratio, bool large_text = false) {
+            if (ratio >= 7.0)
+                return AccessibilityLevel::AAA_NORMAL;
+            if (ratio >= 4.5) {
+                return large_text ? AccessibilityLevel::AAA_LARGE : AccessibilityLevel::AA_NORMAL;
+            }
+            if (ratio >= 3.0 && large_text)
+                return AccessibilityLevel::AA_LARGE;
+
+            return AccessibilityLevel::FAIL;
+        }
+
+        inline AccessibilityLevel::Level check_accessibility(const RGB &foreground, const RGB &background,
+                                                             bool large_text = false) {
+            return accessibility_level(contrast_ratio(foreground, background), large_text);
+        }
+
+        // Find the best contrasting color (black or white)
+        inline RGB best_contrast_color(const RGB &background) {
+            double contrast_with_white = contrast_ratio(RGB::white(), background);
+            double contrast_with_black = contrast_ratio(RGB::black(), background);
+
+            return (contrast_with_white > contrast_with_black) ? RGB::white() : RGB::black();
+        }
+
+        // Bulk contrast audits for design-system linting. Each color's luminance is computed once, after which
+        // a ratio costs one division:
+        //
+        //   contrast_matrix(foregrounds, backgrounds)   every foreground against every background
+        //   contrast_pairs(colors, pairs)               only the listed (foreground, background) index pairs
+        //   ContrastMatrix::failing(4.5)                the pairs below a required ratio
+        struct ContrastPair {
+            uint32_t foreground;
+            uint32_t background;
+            double ratio;
+            AccessibilityLevel::Level level;
+
+            bool operator==(const ContrastPair &) const = default;
+        };
+
+        // Ratios in row-major order, one row per foreground
+        class ContrastMatrix {
+          public:
+            ContrastMatrix() = default;
+            ContrastMatrix(size_t rows, size_t cols) : rows_(rows), cols_(cols), data_(rows * cols, 1.0) {}
+
+            size_t rows() const { return rows_; }
+            size_t cols() const { return cols_; }
+            double operator()(size_t fg, size_t bg) const { return data_[fg * cols_ + bg]; }
+            const double *row(size_t fg) const { return data_.data() + fg * cols_; }
+            const std::vector<double> &data() const { return data_; }
+            double *data_ptr() { return data_.data(); }
+
+            AccessibilityLevel::Level level(size_t fg, size_t bg, bool large_text = false) const {
+                return accessibility_level((*this)(fg, bg), large_text);
+            }
+
+            // Pairs with a ratio below `min_ratio` (4.5 is AA for normal text), ordered by foreground then
+            // background
+            std::vector<ContrastPair> failing(double min_ratio = 4.5, bool large_text = false) const {
+                std::vector<ContrastPair> out;
+                for (size_t fg = 0; fg < rows_; ++fg) {
+                    const double *r = row(fg);
+                    for (size_t bg = 0; bg < cols_; ++bg) {
+                        if (r[bg] < min_ratio) {
+                            out.push_back({static_cast<uint32_t>(fg), static_cast<uint32_t>(bg), r[bg],
+                                           accessibility_level(r[bg], large_text)});
+                        }
+                    }
+                }
+                return out;
+            }
+
+          private:
+            size_t rows_ = 0;
+            size_t cols_ = 0;
+            std::vector<double> data_;
+        };
+
+        namespace detail {
+            // Relative luminance plus the 0.05 flare term, ready for one division per pair
+            template <execution::ExecutionPolicy Policy>
+            std::vector<double> shifted_luminances(const Policy &policy, std::span<const RGB> colors) {
+                std::vector<double> out(colors.size());
+                execution::for_each_chunk(policy, colors.size(), 4096, [&](size_t lo, size_t hi) {
+                    for (size_t i = lo; i < hi; ++i) {
+                        out[i] = relative_luminance(colors[i]) + 0.05;
+                    }
+                });
+                return out;
+            }
+
+            inline double shifted_contrast(double a, double b) { return a > b ? a / b : b / a; }
+        } // namespace detail
+
+        template <execution::ExecutionPolicy Policy>
+        ContrastMatrix contrast_matrix(const Policy &policy, std::span<const RGB> foregrounds,
+                                       std::span<const RGB> backgrounds) {
+            const std::vector<double> fg = detail::shifted_luminances(policy, foregrounds);
+            const std::vector<double> bg = detail::shifted_luminances(policy, backgrounds);
+            ContrastMatrix out(fg.size(), bg.size());
+            double *data = out.data_ptr();
+            const size_t rows_per_chunk = std::max<size_t>(1, 16384 / std::max<size_t>(1, bg.size()));
+            execution::for_each_chunk(policy, fg.size(), rows_per_chunk, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    double *r = data + i * bg.size();
+                    for (size_t j = 0; j < bg.size(); ++j) {
+                        r[j] = detail::shifted_contrast(fg[i], bg[j]);
+                    }
+                }
+            });
+            return out;
+        }
+
+        inline ContrastMatrix contrast_matrix(std::span<const RGB> foregrounds, std::span<const RGB> backgrounds) {
+            return contrast_matrix(execution::seq, foregrounds, backgrounds);
+        }
+
+        // Ratio and level for each (foreground, background) pair of indices into `colors`, in input order.
+        // Throws std::invalid_argument if an index is out of range.
+        template <execution::ExecutionPolicy Policy>
+        std::vector<ContrastPair> contrast_pairs(const Policy &policy, std::span<const RGB> colors,
+                                                 std::span<const std::pair<uint32_t, uint32_t>> pairs,
+                                                 bool large_text = false) {
+            for (const auto &[fg, bg] : pairs) {
+                if (fg >= colors.size() || bg >= colors.size()) {
+                    throw std::invalid_argument("contrast_pairs: color index out of range");
+                }
+            }
+            const std::vector<double> lum = detail::shifted_luminances(policy, colors);
+            std::vector<ContrastPair> out(pairs.size());
+            execution::for_each_chunk(policy, pairs.size(), 16384, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    const auto [fg, bg] = pairs[i];
+                    const double ratio = detail::shifted_contrast(lum[fg], lum[bg]);
+                    out[i] = {fg, bg, ratio, accessibility_level(ratio, large_text)};
+                }
+            });
+            return out;
+        }
+
+        inline std::vector<ContrastPair> contrast_pairs(std::span<const RGB> colors,
+                                                        std::span<const std::pair<uint32_t, uint32_t>> pairs,
+                                                        bool large_text = false) {
+            return contrast_pairs(execution::seq, colors, pairs, large_text);
+        }
+
+    } // namespace utils
+} // namespace pigment
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "execution.hpp"
+#include "simd.hpp"
+#include "types_basic.hpp"
+#include "types_lab.hpp"
+#include "types_oklab.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace pigment {
+
+    // Pairwise color distances. Inputs are converted once into planar LAB (Oklab for Metric::OKLab), and
+    // every unordered pair is visited once in cache-sized tiles (tile_size x tile_size colors). Rows of tiles
+    // are independent tasks, so the work spreads across threads under an execution policy; output does not
+    // depend on the policy.
+    //
+    //   distance::matrix(colors)            full symmetric N x N matrix
+    //   distance::condensed(colors)         upper triangle only, N * (N - 1) / 2 values
+    //   distance::pairs_within(colors, t)   only the pairs closer than t, as a sparse list
+    namespace distance {
+
+        // CIE94 is not symmetric; the color with the lower index is the reference. OKLab is Euclidean distance
+        // in Oklab, on its 0-1 lightness scale.
+        enum class Metric { CIE76, CIE94, CIEDE2000, OKLab };
+
+        // Distance between two colors
+        inline double between(const RGB &x, const RGB &y, Metric metric = Metric::CIEDE2000) {
+            if (metric == Metric::OKLab) {
+                return OKLAB::fromRGB(x).distance(OKLAB::fromRGB(y));
+            }
+            const LAB a = LAB::fromRGB(x), b = LAB::fromRGB(y);
+            switch (metric) {
+            case Metric::CIE94: return a.delta_e_94(b);
+            case Metric::CIEDE2000: return a.delta_e_2000(b);
+            default: return a.delta_e(b);
+            }
+        }
+
+        inline constexpr size_t tile_size = 128;
+
+        class Matrix {
+          public:
+            Matrix() = default;
+            explicit Matrix(size_t n) : n_(n), data_(n * n, 0.0) {}
+
+            size_t size() const { return n_; }
+            double operator()(size_t i, size_t j) const { return data_[i * n_ + j]; }
+            const double *row(size_t i) const { return data_.data() + i * n_; }
+            const std::vector<double> &data() const { return data_; }
+            double *data_ptr() { return data_.data(); }
+
+          private:
+            size_t n_ = 0;
+            std::vector<double> data_;
+        };
+
+        // Upper triangle in row-major order, the same layout as SciPy's pdist
+        class Condensed {
+          public:
+            Condensed() = default;
+            explicit Condensed(size_t n) : n_(n), data_(n < 2 ? 0 : n * (n - 1) / 2, 0.0) {}
+
+            size_t size() const { return n_; }
+
+            // Position of pair (i, j), i < j, in data()
+            size_t index(size_t i, size_t j) const { return i * (2 * n_ - i - 1) / 2 + (j - i - 1); }
+
+            double operator()(size_t i, size_t j) const {
+                if (i == j) {
+                    return 0.0;
+                }
+                return i < j ? data_[index(i, j)] : data_[index(j, i)];
+            }
+
+            const std::vector<double> &data() const { return data_; }
+            double *data_ptr() { return data_.data(); }
+
+          private:
+            size_t n_ = 0;
+            std::vector<double> data_;
+        };
+
+        struct Pair {
+            uint32_t first; // first < second
+            uint32_t second;
+            double distance;
+
+            bool operator==(const Pair &) const = default;
+        };
+
+        namespace detail {
+            // LAB, or Oklab for Metric::OKLab
+            struct Planar {
+                std::vector<double> l, a, b;
+
+                size_t size() const { return l.size(); }
+                LAB at(size_t i) const { return LAB(l[i], a[i], b[i]); }
+            };
+
+            template <execution::ExecutionPolicy Policy>
+            Planar to_planar(const Policy &policy, std::span<const RGB> colors, Metric metric) {
+                Planar p{std::vector<double>(colors.size()), std::vector<double>(colors.size()),
+                         std::vector<double>(colors.size())};
+                execution::for_each_chunk(policy, colors.size(), 4096, [&](size_t lo, size_t hi) {
+                    for (size_t i = lo; i < hi; ++i) {
+                        if (metric == Metric::OKLab) {
+                            OKLAB::from_channels(colors[i].r, colors[i].g, colors[i].b, p.l[i], p.a[i], p.b[i]);
+                        } else {
+                            LAB::from_channels(colors[i].r, colors[i].g, colors[i].b, p.l[i], p.a[i], p.b[i]);
+                        }
+                    }
+                });
+                return p;
+            }
+
+            inline Planar to_planar(std::span<const LAB> colors, Metric metric) {
+                Planar p;
+                for (const LAB &c : colors) {
+                    if (metric == Metric::OKLab) {
+                        OKLAB ok = OKLAB::fromLAB(c);
+                        p.l.push_back(ok.l);
+                        p.a.push_back(ok.a);
+                        p.b.push_back(ok.b);
+                    } else {
+                        p.l.push_back(c.l);
+                        p.a.push_back(c.a);
+                        p.b.push_back(c.b);
+                    }
+                }
+                return p;
+            }
+
+            // Distances from color i to colors [j0, j1)
+            inline void row(const Planar &p, size_t i, size_t j0, size_t j1, Metric metric, double *out) {
+                const double *l = p.l.data(), *a = p.a.data(), *b = p.b.data();
+                switch (metric) {
+                case Metric::CIEDE2000:
+                    simd::delta_e_2000(p.at(i), l + j0, a + j0, b + j0, out, j1 - j0);
+                    break;
+                case Metric::CIE94: {
+                    const LAB reference = p.at(i);
+                    for (size_t j = j0; j < j1; ++j) {
+                        out[j - j0] = reference.delta_e_94(LAB(l[j], a[j], b[j]));
+                    }
+                    break;
+                }
+                default: {
+                    const double li = l[i], ai = a[i], bi = b[i];
+                    for (size_t j = j0; j < j1; ++j) {
+                        const double dl = li - l[j], da = ai - a[j], db = bi - b[j];
+                        out[j - j0] = std::sqrt(dl * dl + da * da + db * db);
+                    }
+                }
+                }
+            }
+
+            // Calls visit(task, i, j0, j1, distances) for every i and run [j0, j1) of j > i, tile by tile. Each
+            // task owns one row of tiles and passes its index, so callers can keep per-task state.
+            template <execution::ExecutionPolicy Policy, typename Visit>
+            void for_each_tile(const Policy &policy, const Planar &p, Metric metric, Visit &&visit) {
+                const size_t n = p.size();
+                const size_t tiles = (n + tile_size - 1) / tile_size;
+                execution::for_each_chunk(policy, tiles, 1, [&](size_t lo, size_t hi) {
+                    double buffer[tile_size];
+                    for (size_t ti = lo; ti < hi; ++ti) {
+                        const size_t i_end = std::min(n, (ti + 1) * tile_size);
+                        for (size_t tj = ti; tj < tiles; ++tj) {
+                            const size_t j_end = std::min(n, (tj + 1) * tile_size);
+                            for (size_t i = ti * tile_size; i < i_end; ++i) {
+                                const size_t j0 = std::max(tj * tile_size, i + 1);
+                                if (j0 < j_end) {
+                                    row(p, i, j0, j_end, metric, buffer);
+                                    visit(ti, i, j0, j_end, static_cast<const double *>(buffer));
+                                }
+                            }
+                        }
+                    }
+                });
+            }
+
+            template <execution::ExecutionPolicy Policy>
+            Matrix matrix(const Policy &policy, const Planar &p, Metric metric) {
+                Matrix m(p.size());
+                double *out = m.data_ptr();
+                const size_t n = p.size();
+                for_each_tile(policy, p, metric, [&](size_t, size_t i, size_t j0, size_t j1, const double *d) {
+                    std::copy(d, d + (j1 - j0), out + i * n + j0);
+                    for (size_t j = j0; j < j1; ++j) {
+                        out[j * n + i] = d[j - j0];
+                    }
+                });
+                return m;
+            }
+
+            template <execution::ExecutionPolicy Policy>
+            Condensed condensed(const Policy &policy, const Planar &p, Metric metric) {
+                Condensed m(p.size());
+                double *out = m.data_ptr();
+                for_each_tile(policy, p, metric, [&](size_t, size_t i, size_t j0, size_t j1, const double *d) {
+                    std::copy(d, d + (j1 - j0), out + m.index(i, j0));
+                });
+                return m;
+            }
+
+            template <execution::ExecutionPolicy Policy>
+            std::vector<Pair> pairs_within(const Policy &policy, const Planar &p, double threshold, Metric metric) {
+                if (p.size() > UINT32_MAX) {
+                    throw std::invalid_argument("distance: too many colors for 32-bit pair indices");
+                }
+                // One list per row of tiles; concatenated in row order and sorted, so the order is canonical
+                std::vector<std::vector<Pair>> found((p.size() + tile_size - 1) / tile_size);
+                for_each_tile(policy, p, metric, [&](size_t task, size_t i, size_t j0, size_t j1, const double *d) {
+                    for (size_t j = j0; j < j1; ++j) {
+                        if (d[j - j0] < threshold) {
+                            found[task].push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(j), d[j - j0]});
+                        }
+                    }
+                });
+                std::vector<Pair> out;
+                for (auto &part : found) {
+                    std::sort(part.begin(), part.end(), [](const Pair &x, const Pair &y) {
+                        return x.first != y.first ? x.first < y.first : x.second < y.second;
+                    });
+                    out.insert(out.end(), part.begin(), part.end());
+                }
+                return out;
+            }
+        } // namespace detail
+
+        template <execution::ExecutionPolicy Policy>
+        Matrix matrix(const Policy &policy, std::span<const RGB> colors, Metric metric = Metric::CIEDE2000) {
+            return detail::matrix(policy, detail::to_planar(policy, colors, metric), metric);
+        }
+
+        inline Matrix matrix(std::span<const RGB> colors, Metric metric = Metric::CIEDE2000) {
+            return matrix(execution::seq, colors, metric);
+        }
+
+        template <execution::ExecutionPolicy Policy>
+        Matrix matrix(const Policy &policy, std::span<const LAB> colors, Metric metric = Metric::CIEDE2000) {
+            return detail::matrix(policy, detail::to_planar(colors, metric), metric);
+        }
+
+        inline Matrix matrix(std::span<const LAB> colors, Metric metric = Metric::CIEDE2000) {
+            return matrix(execution::seq, colors, metric);
+        }
+
+        template <execution::ExecutionPolicy Policy>
+        Condensed condensed(const Policy &policy, std::span<const RGB> colors, Metric metric = Metric::CIEDE2000) {
+            return detail::condensed(policy, detail::to_planar(policy, colors, metric), metric);
+        }
+
+        inline Condensed condensed(std::span<const RGB> colors, Metric metric = Metric::CIEDE2000) {
+            return condensed(execution::seq, colors, metric);
+        }
+
+        template <execution::ExecutionPolicy Policy>
+        Condensed condensed(const Policy &policy, std::span<const LAB> colors, Metric metric = Metric::CIEDE2000) {
+            return detail::condensed(policy, detail::to_planar(colors, metric), metric);
+        }
+
+        inline Condensed condensed(std::span<const LAB> colors, Metric metric = Metric::CIEDE2000) {
+            return condensed(execution::seq, colors, metric);
+        }
+
+        // Pairs (i, j), i < j, with distance < threshold, ordered by i then j
+        template <execution::ExecutionPolicy Policy>
+        std::vector<Pair> pairs_within(const Policy &policy, std::span<const RGB> colors, double threshold,
+                                       Metric metric = Metric::CIEDE2000) {
+            return detail::pairs_within(policy, detail::to_planar(policy, colors, metric), threshold, metric);
+        }
+
+        inline std::vector<Pair> pairs_within(std::span<const RGB> colors, double threshold,
+                                              Metric metric = Metric::CIEDE2000) {
+            return pairs_within(execution::seq, colors, threshold, metric);
+        }
+
+        template <execution::ExecutionPolicy Policy>
+        std::vector<Pair> pairs_within(const Policy &policy, std::span<const LAB> colors, double threshold,
+                                       Metric metric = Metric::CIEDE2000) {
+            return detail::pairs_within(policy, detail::to_planar(colors, metric), threshold, metric);
+        }
+
+        inline std::vector<Pair> pairs_within(std::span<const LAB> colors, double threshold,
+                                              Metric metric = Metric::CIEDE2000) {
+            return pairs_within(execution::seq, colors, threshold, metric);
+        }
+
+    } // namespace distance
+} // namespace pigment
@@ -0,0 +1,361 @@
+#pragma once
+
+#include "execution.hpp"
+#include "palette_index.hpp"
+#include "pixel_buffer.hpp"
+#include "quantizer.hpp"
+#include "types_basic.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace pigment {
+
+    // Dithering to a fixed palette. Nearest colors come from a PaletteIndex built once by the caller (each
+    // worker adds an exact Quantizer cache on top, so results match the index).
+    //
+    //  - Error diffusion (Floyd-Steinberg, Atkinson, Sierra) streams the image row by row and keeps only as
+    //    many rows of error as the kernel reaches. Serpentine order alternates direction every row.
+    //  - Ordered dithering adds a per-pixel offset from a threshold map (Bayer or blue noise) before the
+    //    nearest-color lookup. Pixels are independent.
+    //
+    // Both accept an execution policy. Error diffusion is inherently sequential along a frame, so frames are
+    // split into horizontal tiles of Options::tile_height rows (256 by default) that are diffused
+    // independently; the tiling depends only on the options, so output is identical under every policy, and
+    // a parallel policy has tiles to spread once a frame is taller than one tile. Each thread gets one
+    // contiguous run of tiles or rows and a single Quantizer, so its cache stays warm.
+    namespace dither {
+
+        enum class Diffusion { FloydSteinberg, Atkinson, Sierra };
+
+        struct Options {
+            bool serpentine = true;
+            size_t tile_height = 256; // rows per independently diffused tile; 0 diffuses the whole frame at once
+        };
+
+        namespace detail {
+            struct Tap {
+                int dx;
+                int dy;
+                float weight;
+            };
+
+            struct DiffusionKernel {
+                std::vector<Tap> taps;
+                int rows; // rows of error the kernel reaches, including the current one
+            };
+
+            inline const DiffusionKernel &kernel(Diffusion type) {
+                static const DiffusionKernel floyd_steinberg{
+                    {{1, 0, 7 / 16.0f}, {-1, 1, 3 / 16.0f}, {0, 1, 5 / 16.0f}, {1, 1, 1 / 16.0f}}, 2};
+                // Atkinson spreads only 6/8 of the error, which keeps highlights and shadows clean
+                static const DiffusionKernel atkinson{
+                    {{1, 0, 1 / 8.0f}, {2, 0, 1 / 8.0f}, {-1, 1, 1 / 8.0f}, {0, 1, 1 / 8.0f}, {1, 1, 1 / 8.0f},
+                     {0, 2, 1 / 8.0f}},
+                    3};
+                static const DiffusionKernel sierra{
+                    {{1, 0, 5 / 32.0f}, {2, 0, 3 / 32.0f}, {-2, 1, 2 / 32.0f}, {-1, 1, 4 / 32.0f}, {0, 1, 5 / 32.0f},
+                     {1, 1, 4 / 32.0f}, {2, 1, 2 / 32.0f}, {-1, 2, 2 / 32.0f}, {0, 2, 3 / 32.0f}, {1, 2, 2 / 32.0f}},
+                    3};
+                switch (type) {
+                case Diffusion::Atkinson: return atkinson;
+                case Diffusion::Sierra: return sierra;
+                default: return floyd_steinberg;
+                }
+            }
+
+            inline uint8_t to_u8(float v) { return static_cast<uint8_t>(std::clamp(std::lround(v), 0l, 255l)); }
+
+            // Diffuse rows [y0, y1). Errors live in a ring of `rows` lines, padded by 2 pixels on each side so
+            // taps never need bounds checks.
+            inline void diffuse_rows(const PixelBuffer &in, PixelBuffer &out, Quantizer &quantizer,
+                                     const DiffusionKernel &k, bool serpentine, size_t y0, size_t y1) {
+                const size_t width = in.width();
+                const size_t stride = (width + 4) * 3;
+                std::vector<float> error(stride * k.rows, 0.0f);
+                auto line = [&](size_t y) { return error.data() + (y % k.rows) * stride + 2 * 3; };
+
+                for (size_t y = y0; y < y1; ++y) {
+                    const bool reverse = serpentine && ((y - y0) & 1);
+                    const uint8_t *src[3] = {in.row(PixelBuffer::R, y), in.row(PixelBuffer::G, y), in.row(PixelBuffer::B, y)};
+                    uint8_t *dst[3] = {out.row(PixelBuffer::R, y), out.row(PixelBuffer::G, y), out.row(PixelBuffer::B, y)};
+                    float *current = line(y);
+                    for (size_t step = 0; step < width; ++step) {
+                        const size_t x = reverse ? width - 1 - step : step;
+                        float value[3];
+                        int wanted[3];
+                        for (int c = 0; c < 3; ++c) {
+                            value[c] = std::clamp(src[c][x] + current[x * 3 + c], 0.0f, 255.0f);
+                            wanted[c] = to_u8(value[c]);
+                        }
+                        RGB chosen = quantizer.quantize(RGB(wanted[0], wanted[1], wanted[2]));
+                        const int got[3] = {chosen.r, chosen.g, chosen.b};
+                        for (int c = 0; c < 3; ++c) {
+                            dst[c][x] = static_cast<uint8_t>(std::clamp(got[c], 0, 255));
+                        }
+                        for (const Tap &tap : k.taps) {
+                            if (y + tap.dy >= y1) {
+                                continue;
+                            }
+                            // Taps past either edge land in the padding and are dropped
+                            const long tx = static_cast<long>(x) + (reverse ? -tap.dx : tap.dx);
+                            float *target = line(y + tap.dy) + tx * 3;
+                            for (int c = 0; c < 3; ++c) {
+                                target[c] += (value[c] - got[c]) * tap.weight;
+                            }
+                        }
+                    }
+                    std::fill(current - 2 * 3, current - 2 * 3 + stride, 0.0f);
+                }
+            }
+
+            // Non-owning handle to the caller's index so every worker's Quantizer shares it instead of
+            // copying it; the index outlives the call
+            inline std::shared_ptr<const PaletteIndex> borrow(const PaletteIndex &index) {
+                return std::shared_ptr<const PaletteIndex>(std::shared_ptr<const PaletteIndex>(), &index);
+            }
+
+            inline void copy_alpha(const PixelBuffer &in, PixelBuffer &out) {
+                if (&in != &out) {
+                    std::copy(in.plane(PixelBuffer::A), in.plane(PixelBuffer::A) + in.size(), out.plane(PixelBuffer::A));
+                }
+            }
+
+            inline void prepare(const PixelBuffer &in, PixelBuffer &out) {
+                if (&in != &out && (out.width() != in.width() || out.height() != in.height())) {
+                    out = PixelBuffer(in.width(), in.height());
+                }
+                copy_alpha(in, out);
+            }
+        } // namespace detail
+
+        // Error-diffusion dither of `in` into `out` (which may be the same buffer); alpha is copied
+        template <execution::ExecutionPolicy Policy>
+        void diffuse(const Policy &policy, const PixelBuffer &in, PixelBuffer &out, const PaletteIndex &palette,
+                     Diffusion type = Diffusion::FloydSteinberg, const Options &options = {}) {
+            if (palette.empty()) {
+                throw std::invalid_argument("dither: palette is empty");
+            }
+            detail::prepare(in, out);
+            const detail::DiffusionKernel &k = detail::kernel(type);
+            const size_t tile = options.tile_height == 0 ? std::max<size_t>(in.height(), 1) : options.tile_height;
+            const size_t tiles = (in.height() + tile - 1) / tile;
+            const auto index = detail::borrow(palette);
+            execution::for_each_chunk(policy.with_chunk(execution::worker_chunk(policy, tiles)), tiles, 1,
+                                      [&](size_t lo, size_t hi) {
+                Quantizer quantizer(index);
+                for (size_t t = lo; t < hi; ++t) {
+                    detail::diffuse_rows(in, out, quantizer, k, options.serpentine, t * tile,
+                                         std::min(in.height(), (t + 1) * tile));
+                }
+            });
+        }
+
+        inline void diffuse(const PixelBuffer &in, PixelBuffer &out, const PaletteIndex &palette,
+                            Diffusion type = Diffusion::FloydSteinberg, const Options &options = {}) {
+            diffuse(execution::seq, in, out, palette, type, options);
+        }
+
+        // Square threshold matrix with values in (0, 1), tiled over the image
+        class ThresholdMap {
+          public:
+            // Bayer matrix; size must be a power of two between 2 and 256
+            static ThresholdMap bayer(size_t size) {
+                if (size < 2 || size > 256 || (size & (size - 1)) != 0) {
+                    throw std::invalid_argument("ThresholdMap: Bayer size must be a power of two in [2, 256]");
+                }
+                // Recursive construction: M(2n) = [4M, 4M + 2; 4M + 3, 4M + 1]
+                std::vector<uint32_t> rank = {0};
+                for (size_t n = 1; n < size; n *= 2) {
+                    std::vector<uint32_t> next(4 * n * n);
+                    for (size_t y = 0; y < n; ++y) {
+                        for (size_t x = 0; x < n; ++x) {
+                            uint32_t v = 4 * rank[y * n + x];
+                            next[y * 2 * n + x] = v;
+                            next[y * 2 * n + x + n] = v + 2;
+                            next[(y + n) * 2 * n + x] = v + 3;
+                            next[(y + n) * 2 * n + x + n] = v + 1;
+                        }
+                    }
+                    rank = std::move(next);
+                }
+                return ThresholdMap(size, rank);
+            }
+
+            // Blue-noise matrix from Ulichney's void-and-cluster method, deterministic for a given seed.
+            // Costs O(size^4) to generate (under 0.1 s for 64, over a second for 128), so build it once and keep it.
+            static ThresholdMap blue_noise(size_t size = 64, uint32_t seed = 1) {
+                if (size < 4 || size > 256) {
+                    throw std::invalid_argument("ThresholdMap: blue-noise size must be in [4, 256]");
+                }
+                return ThresholdMap(size, void_and_cluster(size, seed));
+            }
+
+            size_t size() const { return size_; }
+
+            float at(size_t x, size_t y) const { return values_[(y % size_) * size_ + x % size_]; }
+
+          private:
+            size_t size_;
+            std::vector<float> values_;
+
+            ThresholdMap(size_t size, const std::vector<uint32_t> &rank) : size_(size), values_(rank.size()) {
+                for (size_t i = 0; i < rank.size(); ++i) {
+                    values_[i] = (rank[i] + 0.5f) / rank.size();
+                }
+            }
+
+            // Ranks every cell of a size x size torus. Energy is a Gaussian (sigma 1.5) summed over the
+            // minority pixels and updated incrementally as pixels flip.
+            static std::vector<uint32_t> void_and_cluster(size_t n, uint32_t seed) {
+                const size_t cells = n * n;
+                std::vector<float> gauss(cells);
+                for (size_t y = 0; y < n; ++y) {
+                    for (size_t x = 0; x < n; ++x) {
+                        double dx = static_cast<double>(std::min(x, n - x));
+                        double dy = static_cast<double>(std::min(y, n - y));
+                        gauss[y * n + x] = static_cast<float>(std::exp(-(dx * dx + dy * dy) / (2 * 1.5 * 1.5)));
+                    }
+                }
+
+                struct Field {
+                    size_t n;
+                    const std::vector<float> &gauss;
+                    std::vector<uint8_t> on;
+                    std::vector<float> energy;
+
+                    void flip(size_t cell, bool value) {
+                        on[cell] = value;
+                        const float sign = value ? 1.0f : -1.0f;
+                        const size_t cx = cell % n, cy = cell / n;
+                        for (size_t y = 0; y < n; ++y) {
+                            const float *g = gauss.data() + ((y + n - cy) % n) * n;
+                            float *e = energy.data() + y * n;
+                            // Row of the kernel rotated by cx, as two contiguous runs
+                            for (size_t x = 0; x < cx; ++x) {
+                                e[x] += sign * g[x + n - cx];
+                            }
+                            for (size_t x = cx; x < n; ++x) {
+                                e[x] += sign * g[x - cx];
+                            }
+                        }
+                    }
+
+                    // Tightest cluster: the set cell with the highest energy; largest void: the empty cell with
+                    // the lowest. Ties go to the lowest cell index.
+                    size_t find(bool cluster) const {
+                        size_t best = energy.size();
+                        for (size_t i = 0; i < energy.size(); ++i) {
+                            if (on[i] == cluster && (best == energy.size() ||
+                                                     (cluster ? energy[i] > energy[best] : energy[i] < energy[best]))) {
+                                best = i;
+                            }
+                        }
+                        return best;
+                    }
+                };
+
+                auto make_field = [&](const std::vector<uint8_t> &pattern) {
+                    Field f{n, gauss, std::vector<uint8_t>(cells, 0), std::vector<float>(cells, 0.0f)};
+                    for (size_t i = 0; i < cells; ++i) {
+                        if (pattern[i]) {
+                            f.flip(i, true);
+                        }
+                    }
+                    return f;
+                };
+
+                // Initial pattern: about 10% of cells, then swap clusters into voids until stable
+                std::mt19937 gen(seed);
+                std::vector<uint8_t> pattern(cells, 0);
+                const size_t initial = std::max<size_t>(1, cells / 10);
+                std::vector<size_t> order(cells);
+                for (size_t i = 0; i < cells; ++i) {
+                    order[i] = i;
+                }
+                std::shuffle(order.begin(), order.end(), gen);
+                for (size_t i = 0; i < initial; ++i) {
+                    pattern[order[i]] = 1;
+                }
+                Field field = make_field(pattern);
+                for (size_t guard = 0; guard < cells; ++guard) {
+                    size_t cluster = field.find(true);
+                    field.flip(cluster, false);
+                    size_t gap = field.find(false);
+                    field.flip(gap, true);
+                    if (gap == cluster) {
+                        break;
+                    }
+                }
+                pattern = field.on;
+
+                std::vector<uint32_t> rank(cells, 0);
+                // Phase 1: remove the tightest clusters from the initial pattern, highest rank first
+                Field phase1 = field;
+                for (size_t r = initial; r-- > 0;) {
+                    size_t cluster = phase1.find(true);
+                    phase1.flip(cluster, false);
+                    rank[cluster] = static_cast<uint32_t>(r);
+                }
+                // Phase 2: fill the largest voids up to half the cells
+                size_t r = initial;
+                for (; r < cells / 2; ++r) {
+                    size_t gap = field.find(false);
+                    field.flip(gap, true);
+                    rank[gap] = static_cast<uint32_t>(r);
+                }
+                // Phase 3: zeros are now the minority; fill the tightest cluster of zeros each step
+                std::vector<uint8_t> zeros(cells);
+                for (size_t i = 0; i < cells; ++i) {
+                    zeros[i] = !field.on[i];
+                }
+                Field inverse = make_field(zeros);
+                for (; r < cells; ++r) {
+                    size_t cluster = inverse.find(true);
+                    inverse.flip(cluster, false);
+                    rank[cluster] = static_cast<uint32_t>(r);
+                }
+                return rank;
+            }
+        };
+
+        // Ordered dither: each channel is offset by (threshold - 0.5) * spread before the nearest-color
+        // lookup. `spread` is in 8-bit units; roughly the distance between neighbouring palette colors works well.
+        template <execution::ExecutionPolicy Policy>
+        void ordered(const Policy &policy, const PixelBuffer &in, PixelBuffer &out, const PaletteIndex &palette,
+                     const ThresholdMap &map, float spread = 48.0f) {
+            if (palette.empty()) {
+                throw std::invalid_argument("dither: palette is empty");
+            }
+            detail::prepare(in, out);
+            const size_t width = in.width();
+            const auto index = detail::borrow(palette);
+            execution::for_each_chunk(policy, in.height(), execution::worker_chunk(policy, in.height()),
+                                      [&](size_t y0, size_t y1) {
+                Quantizer quantizer(index);
+                for (size_t y = y0; y < y1; ++y) {
+                    const uint8_t *src[3] = {in.row(PixelBuffer::R, y), in.row(PixelBuffer::G, y), in.row(PixelBuffer::B, y)};
+                    uint8_t *dst[3] = {out.row(PixelBuffer::R, y), out.row(PixelBuffer::G, y), out.row(PixelBuffer::B, y)};
+                    for (size_t x = 0; x < width; ++x) {
+                        const float offset = (map.at(x, y) - 0.5f) * spread;
+                        RGB chosen = quantizer.quantize(RGB(detail::to_u8(src[0][x] + offset), detail::to_u8(src[1][x] + offset),
+                                                            detail::to_u8(src[2][x] + offset)));
+                        dst[0][x] = static_cast<uint8_t>(std::clamp(chosen.r, 0, 255));
+                        dst[1][x] = static_cast<uint8_t>(std::clamp(chosen.g, 0, 255));
+                        dst[2][x] = static_cast<uint8_t>(std::clamp(chosen.b, 0, 255));
+                    }
+                }
+            });
+        }
+
+        inline void ordered(const PixelBuffer &in, PixelBuffer &out, const PaletteIndex &palette,
+                            const ThresholdMap &map, float spread = 48.0f) {
+            ordered(execution::seq, in, out, palette, map, spread);
+        }
+
+    } // namespace dither
+} // namespace pigment
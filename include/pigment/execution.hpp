@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace pigment {
+
+    // Execution policies for the bulk APIs. Work is split into fixed-size chunks that depend only on the
+    // input size (never on the thread count), and every element is written by exactly one chunk, so the
+    // parallel paths produce output identical to the sequential one.
+    //
+    //   execution::seq                  run on the calling thread
+    //   execution::par                  run on the shared thread pool
+    //   execution::par.on(pool)         run on a specific ThreadPool
+    //   execution::executor(fn)         hand the chunks to a user scheduler
+    //
+    // Each policy can override the chunk size with .with_chunk(n); by default chunks are sized to stay in
+    // cache (chunk_bytes of input per chunk). Work whose result cannot depend on the split, such as memoized
+    // quantization, may instead take one chunk per thread (worker_chunk).
+    namespace execution {
+
+        inline constexpr size_t chunk_bytes = 256 * 1024;
+
+        // Default chunk length for elements of type T
+        template <typename T> constexpr size_t chunk_for() { return std::max<size_t>(1, chunk_bytes / sizeof(T)); }
+
+        // Fixed set of worker threads. run() blocks until every task has finished; the calling thread
+        // executes tasks too, so nested run() calls from inside a task cannot deadlock. The first exception
+        // thrown by a task is rethrown from run() after the remaining tasks complete.
+        class ThreadPool {
+          public:
+            // `threads` counts the calling thread; 0 means one per hardware thread
+            explicit ThreadPool(size_t threads = 0) {
+                if (threads == 0) {
+                    threads = std::max(1u, std::thread::hardware_concurrency());
+                }
+                for (size_t i = 1; i < threads; ++i) {
+                    workers_.emplace_back([this] { worker_loop(); });
+                }
+            }
+
+            ~ThreadPool() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stop_ = true;
+                }
+                wake_.notify_all();
+                for (auto &worker : workers_) {
+                    worker.join();
+                }
+            }
+
+            ThreadPool(const ThreadPool &) = delete;
+            ThreadPool &operator=(const ThreadPool &) = delete;
+
+            size_t size() const { return workers_.size() + 1; }
+
+            // Run task(0) ... task(count - 1)
+            void run(size_t count, const std::function<void(size_t)> &task) {
+                if (count == 0) {
+                    return;
+                }
+                if (count == 1 || workers_.empty()) {
+                    for (size_t i = 0; i < count; ++i) {
+                        task(i);
+                    }
+                    return;
+                }
+                auto job = std::make_shared<Job>(task, count);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    jobs_.push_back(job);
+                }
+                wake_.notify_all();
+                job->work();
+                job->wait();
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    auto it = std::find(jobs_.begin(), jobs_.end(), job);
+                    if (it != jobs_.end()) {
+                        jobs_.erase(it);
+                    }
+                }
+                if (job->error) {
+                    std::rethrow_exception(job->error);
+                }
+            }
+
+          private:
+            struct Job {
+                const std::function<void(size_t)> &task;
+                const size_t count;
+                std::atomic<size_t> next{0};
+                std::atomic<size_t> done{0};
+                std::mutex mutex;
+                std::condition_variable finished;
+                std::exception_ptr error;
+
+                Job(const std::function<void(size_t)> &task_, size_t count_) : task(task_), count(count_) {}
+
+                bool exhausted() const { return next.load(std::memory_order_relaxed) >= count; }
+
+                // Claim and run tasks until none are left to claim
+                void work() {
+                    for (;;) {
+                        size_t i = next.fetch_add(1);
+                        if (i >= count) {
+                            return;
+                        }
+                        try {
+                            task(i);
+                        } catch (...) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            if (!error) {
+                                error = std::current_exception();
+                            }
+                        }
+                        if (done.fetch_add(1) + 1 == count) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            finished.notify_all();
+                        }
+                    }
+                }
+
+                void wait() {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    finished.wait(lock, [this] { return done.load() == count; });
+                }
+            };
+
+            std::vector<std::thread> workers_;
+            std::deque<std::shared_ptr<Job>> jobs_;
+            std::mutex mutex_;
+            std::condition_variable wake_;
+            bool stop_ = false;
+
+            void worker_loop() {
+                for (;;) {
+                    std::shared_ptr<Job> job;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        wake_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+                        if (stop_) {
+                            return;
+                        }
+                        job = jobs_.front();
+                        if (job->exhausted()) {
+                            jobs_.pop_front();
+                            continue;
+                        }
+                    }
+                    job->work();
+                }
+            }
+        };
+
+        // Process-wide pool with one thread per hardware thread, created on first use
+        inline ThreadPool &default_pool() {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        struct sequenced_policy {
+            size_t chunk = 0;
+
+            constexpr sequenced_policy with_chunk(size_t n) const { return {n}; }
+        };
+
+        struct parallel_policy {
+            ThreadPool *pool = nullptr; // null: default_pool()
+            size_t chunk = 0;
+
+            constexpr parallel_policy on(ThreadPool &p) const { return {&p, chunk}; }
+            constexpr parallel_policy with_chunk(size_t n) const { return {pool, n}; }
+        };
+
+        // User scheduler: called with a task count and a task, it must run task(i) once for every i in
+        // [0, count), in any order and on any threads, and return only after all of them finished
+        struct executor_policy {
+            std::function<void(size_t, const std::function<void(size_t)> &)> schedule;
+            size_t chunk = 0;
+
+            executor_policy with_chunk(size_t n) const { return {schedule, n}; }
+        };
+
+        inline constexpr sequenced_policy seq{};
+        inline constexpr parallel_policy par{};
+
+        template <typename Schedule> executor_policy executor(Schedule schedule) {
+            return executor_policy{std::move(schedule)};
+        }
+
+        template <typename T>
+        inline constexpr bool is_execution_policy_v =
+            std::is_same_v<std::remove_cvref_t<T>, sequenced_policy> ||
+            std::is_same_v<std::remove_cvref_t<T>, parallel_policy> ||
+            std::is_same_v<std::remove_cvref_t<T>, executor_policy>;
+
+        template <typename T>
+        concept ExecutionPolicy = is_execution_policy_v<T>;
+
+        namespace detail {
+            inline void schedule(const sequenced_policy &, size_t count, const std::function<void(size_t)> &task) {
+                for (size_t i = 0; i < count; ++i) {
+                    task(i);
+                }
+            }
+
+            inline void schedule(const parallel_policy &policy, size_t count, const std::function<void(size_t)> &task) {
+                (policy.pool ? *policy.pool : default_pool()).run(count, task);
+            }
+
+            inline void schedule(const executor_policy &policy, size_t count, const std::function<void(size_t)> &task) {
+                policy.schedule(count, task);
+            }
+        } // namespace detail
+
+        // Threads a policy runs chunks on: one for seq, the pool size for par, and the hardware thread count
+        // for an executor, whose scheduler is opaque
+        inline size_t concurrency(const sequenced_policy &) { return 1; }
+
+        inline size_t concurrency(const parallel_policy &policy) {
+            return (policy.pool ? *policy.pool : default_pool()).size();
+        }
+
+        inline size_t concurrency(const executor_policy &) {
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // Chunk length giving each thread one chunk of [0, n). Only for work whose per-chunk setup is costly
+        // (a cache to warm, say) and whose result does not depend on where the chunks split.
+        template <ExecutionPolicy Policy> size_t worker_chunk(const Policy &policy, size_t n) {
+            const size_t threads = concurrency(policy);
+            return std::max<size_t>(1, (n + threads - 1) / threads);
+        }
+
+        // Split [0, n) into chunks of `chunk` elements (the policy's override if set) and call
+        // fn(begin, end) for each. The sequential policy without an override handles everything in one call.
+        template <ExecutionPolicy Policy, typename Fn>
+        void for_each_chunk(const Policy &policy, size_t n, size_t chunk, Fn &&fn) {
+            if (n == 0) {
+                return;
+            }
+            if (policy.chunk != 0) {
+                chunk = policy.chunk;
+            } else if constexpr (std::is_same_v<Policy, sequenced_policy>) {
+                chunk = n;
+            }
+            chunk = std::max<size_t>(chunk, 1);
+            const size_t count = (n + chunk - 1) / chunk;
+            if constexpr (std::is_same_v<Policy, sequenced_policy>) {
+                for (size_t i = 0; i < count; ++i) {
+                    fn(i * chunk, std::min(n, (i + 1) * chunk));
+                }
+            } else {
+                detail::schedule(policy, count, [&](size_t i) { fn(i * chunk, std::min(n, (i + 1) * chunk)); });
+            }
+        }
+
+        // Stable sort: chunks are sorted independently, then merged pairwise in rounds. std::merge keeps
+        // the left element first on ties, so the result equals std::stable_sort for any policy.
+        template <ExecutionPolicy Policy, typename T, typename Compare>
+        void stable_sort(const Policy &policy, std::vector<T> &values, Compare comp, size_t chunk = chunk_for<T>()) {
+            const size_t n = values.size();
+            if (policy.chunk != 0) {
+                chunk = policy.chunk;
+            }
+            if (std::is_same_v<Policy, sequenced_policy> || n <= chunk) {
+                std::stable_sort(values.begin(), values.end(), comp);
+                return;
+            }
+            const size_t runs = (n + chunk - 1) / chunk;
+            detail::schedule(policy, runs, [&](size_t i) {
+                std::stable_sort(values.begin() + i * chunk, values.begin() + std::min(n, (i + 1) * chunk), comp);
+            });
+            std::vector<T> buffer(n);
+            std::vector<T> *from = &values, *to = &buffer;
+            for (size_t width = chunk; width < n; width *= 2) {
+                const size_t pairs = (n + 2 * width - 1) / (2 * width);
+                detail::schedule(policy, pairs, [&](size_t p) {
+                    const size_t lo = p * 2 * width;
+                    const size_t mid = std::min(n, lo + width);
+                    const size_t hi = std::min(n, lo + 2 * width);
+                    std::merge(from->begin() + lo, from->begin() + mid, from->begin() + mid, from->begin() + hi,
+                               to->begin() + lo, comp);
+                });
+                std::swap(from, to);
+            }
+            if (from != &values) {
+                values.swap(buffer);
+            }
+        }
+
+    } // namespace execution
+} // namespace pigment
@@ -0,0 +1,541 @@
+#pragma once
+
+#include "execution.hpp"
+#include "pixel_buffer.hpp"
+#include "types_basic.hpp"
+#include "types_lab.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace pigment {
+
+    // Palette extraction from image data. Pixels are first reduced to a histogram of unique colors in O(pixels)
+    // (a chunked counting sort on packed 24-bit keys), so every method costs O(unique colors) rather than
+    // O(pixels); clustering happens in LAB with each unique color weighted by its pixel count. Results are
+    // sorted by cluster weight, dominant color first.
+    //
+    //  - MedianCut: repeatedly splits the box with the largest weighted variance at the weighted median of
+    //    its widest axis.
+    //  - Octree: buckets LAB into an octree (64 cells per axis) and merges the lightest leaves. A merge folds
+    //    up to 8 leaves at once, so it can return fewer than k colors.
+    //  - KMeans: k-means++ seeding then Lloyd iterations; Options::mini_batch switches to mini-batch updates
+    //    on weighted samples for very large histograms.
+    namespace extract {
+
+        enum class Method { MedianCut, Octree, KMeans };
+
+        struct Options {
+            size_t max_iterations = 20; // k-means iterations
+            bool mini_batch = false;
+            size_t batch_size = 1024;   // mini-batch samples per iteration
+            uint32_t seed = 1;          // k-means++ seeding and mini-batch sampling
+        };
+
+        // Unique colors with pixel counts. Fully transparent pixels are skipped and alpha is dropped.
+        struct Histogram {
+            std::vector<RGB> colors;
+            std::vector<uint32_t> counts;
+
+            size_t size() const { return colors.size(); }
+            bool empty() const { return colors.empty(); }
+        };
+
+        namespace detail {
+            inline uint32_t pack(int r, int g, int b) {
+                return (uint32_t(std::clamp(r, 0, 255)) << 16) | (uint32_t(std::clamp(g, 0, 255)) << 8) |
+                       uint32_t(std::clamp(b, 0, 255));
+            }
+
+            // Below this many keys a comparison sort is faster than the counting passes
+            inline constexpr size_t counting_threshold = 2048;
+
+            // Sort packed 24-bit keys with three stable LSD counting passes of 8 bits. Each chunk counts its
+            // digits, then scatters its own keys at offsets from an exclusive prefix over (digit, chunk).
+            template <typename Policy> void sort_keys(const Policy &policy, std::vector<uint32_t> &keys) {
+                const size_t n = keys.size();
+                if (n < counting_threshold) {
+                    std::sort(keys.begin(), keys.end());
+                    return;
+                }
+                constexpr size_t radix = 256;
+                const size_t chunk = policy.chunk != 0 ? policy.chunk
+                                     : std::is_same_v<Policy, execution::sequenced_policy> ? n
+                                                                                           : execution::chunk_for<uint32_t>();
+                const size_t chunks = (n + chunk - 1) / chunk;
+                const auto per_chunk = policy.with_chunk(1);
+                std::vector<uint32_t> buffer(n);
+                std::vector<size_t> counts(chunks * radix);
+
+                for (int shift = 0; shift < 24; shift += 8) {
+                    std::fill(counts.begin(), counts.end(), 0);
+                    execution::for_each_chunk(per_chunk, chunks, 1, [&](size_t c0, size_t c1) {
+                        for (size_t c = c0; c < c1; ++c) {
+                            size_t *count = counts.data() + c * radix;
+                            for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); ++i) {
+                                ++count[(keys[i] >> shift) & (radix - 1)];
+                            }
+                        }
+                    });
+                    size_t offset = 0;
+                    bool skip = false;
+                    for (size_t d = 0; d < radix && !skip; ++d) {
+                        size_t total = 0;
+                        for (size_t c = 0; c < chunks; ++c) {
+                            size_t count = counts[c * radix + d];
+                            counts[c * radix + d] = offset;
+                            offset += count;
+                            total += count;
+                        }
+                        skip = total == n;
+                    }
+                    if (skip) {
+                        continue; // every key has this digit
+                    }
+                    execution::for_each_chunk(per_chunk, chunks, 1, [&](size_t c0, size_t c1) {
+                        for (size_t c = c0; c < c1; ++c) {
+                            size_t *next = counts.data() + c * radix;
+                            for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); ++i) {
+                                buffer[next[(keys[i] >> shift) & (radix - 1)]++] = keys[i];
+                            }
+                        }
+                    });
+                    keys.swap(buffer);
+                }
+            }
+
+            template <typename Policy> Histogram from_keys(const Policy &policy, std::vector<uint32_t> &keys) {
+                sort_keys(policy, keys);
+                Histogram h;
+                for (size_t i = 0; i < keys.size();) {
+                    size_t j = i;
+                    while (j < keys.size() && keys[j] == keys[i]) {
+                        ++j;
+                    }
+                    h.colors.push_back(RGB(keys[i] >> 16, (keys[i] >> 8) & 255, keys[i] & 255));
+                    h.counts.push_back(static_cast<uint32_t>(j - i));
+                    i = j;
+                }
+                return h;
+            }
+
+            struct Point {
+                double v[3]; // L, a, b
+                double weight;
+            };
+
+            inline double distance2(const double *x, const double *y) {
+                double d0 = x[0] - y[0], d1 = x[1] - y[1], d2 = x[2] - y[2];
+                return d0 * d0 + d1 * d1 + d2 * d2;
+            }
+
+            // Weighted mean of a cluster
+            struct Accumulator {
+                double sum[3] = {0, 0, 0};
+                double weight = 0;
+
+                void add(const Point &p) {
+                    for (int c = 0; c < 3; ++c) {
+                        sum[c] += p.v[c] * p.weight;
+                    }
+                    weight += p.weight;
+                }
+            };
+
+            // Cluster means back to RGB, heaviest first (ties keep cluster order)
+            inline std::vector<RGB> finish(const std::vector<Accumulator> &clusters) {
+                std::vector<size_t> order;
+                for (size_t i = 0; i < clusters.size(); ++i) {
+                    if (clusters[i].weight > 0) {
+                        order.push_back(i);
+                    }
+                }
+                std::stable_sort(order.begin(), order.end(),
+                                 [&](size_t x, size_t y) { return clusters[x].weight > clusters[y].weight; });
+                std::vector<RGB> out;
+                for (size_t i : order) {
+                    const Accumulator &c = clusters[i];
+                    out.push_back(LAB(c.sum[0] / c.weight, c.sum[1] / c.weight, c.sum[2] / c.weight).to_rgb());
+                }
+                return out;
+            }
+
+            inline std::vector<RGB> median_cut(std::vector<Point> &points, size_t k) {
+                struct Box {
+                    size_t begin, end;
+                    double score; // weighted sum of squared deviations over all axes
+                    int axis;     // axis with the largest deviation
+                };
+                auto make_box = [&](size_t begin, size_t end) {
+                    Box box{begin, end, 0.0, 0};
+                    Accumulator mean;
+                    for (size_t i = begin; i < end; ++i) {
+                        mean.add(points[i]);
+                    }
+                    double sse[3] = {0, 0, 0};
+                    for (size_t i = begin; i < end; ++i) {
+                        for (int c = 0; c < 3; ++c) {
+                            double d = points[i].v[c] - mean.sum[c] / mean.weight;
+                            sse[c] += d * d * points[i].weight;
+                        }
+                    }
+                    box.axis = static_cast<int>(std::max_element(sse, sse + 3) - sse);
+                    box.score = end - begin > 1 ? sse[0] + sse[1] + sse[2] : 0.0;
+                    return box;
+                };
+
+                std::vector<Box> boxes = {make_box(0, points.size())};
+                while (boxes.size() < k) {
+                    auto it = std::max_element(boxes.begin(), boxes.end(),
+                                               [](const Box &x, const Box &y) { return x.score < y.score; });
+                    if (it->score <= 0) {
+                        break;
+                    }
+                    Box box = *it;
+                    const int axis = box.axis;
+                    std::sort(points.begin() + box.begin, points.begin() + box.end,
+                              [axis](const Point &x, const Point &y) { return x.v[axis] < y.v[axis]; });
+                    // Cut where the two halves have the smallest total squared deviation along the axis,
+                    // which keeps clusters of unequal size intact where a plain weighted median would not
+                    double total_w = 0, total_s = 0, total_q = 0;
+                    for (size_t i = box.begin; i < box.end; ++i) {
+                        const double w = points[i].weight, v = points[i].v[axis];
+                        total_w += w;
+                        total_s += w * v;
+                        total_q += w * v * v;
+                    }
+                    size_t split = box.begin + 1;
+                    double best = std::numeric_limits<double>::infinity();
+                    double w = 0, s = 0, q = 0;
+                    for (size_t i = box.begin; i + 1 < box.end; ++i) {
+                        const double v = points[i].v[axis];
+                        w += points[i].weight;
+                        s += points[i].weight * v;
+                        q += points[i].weight * v * v;
+                        if (v == points[i + 1].v[axis]) {
+                            continue; // equal coordinates stay on the same side
+                        }
+                        const double sse = (q - s * s / w) + ((total_q - q) - (total_s - s) * (total_s - s) / (total_w - w));
+                        if (sse < best) {
+                            best = sse;
+                            split = i + 1;
+                        }
+                    }
+                    *it = make_box(box.begin, split);
+                    boxes.push_back(make_box(split, box.end));
+                }
+
+                std::vector<Accumulator> clusters(boxes.size());
+                for (size_t b = 0; b < boxes.size(); ++b) {
+                    for (size_t i = boxes[b].begin; i < boxes[b].end; ++i) {
+                        clusters[b].add(points[i]);
+                    }
+                }
+                return finish(clusters);
+            }
+
+            inline std::vector<RGB> octree(const std::vector<Point> &points, size_t k) {
+                constexpr int depth = 6;
+                struct Node {
+                    int children[8];
+                    int parent;
+                    int level;
+                    int live_children = 0;
+                    bool leaf = false;
+                    Accumulator acc;
+                };
+                std::vector<Node> nodes;
+                auto new_node = [&](int parent, int level) {
+                    Node n;
+                    std::fill(n.children, n.children + 8, -1);
+                    n.parent = parent;
+                    n.level = level;
+                    nodes.push_back(n);
+                    return static_cast<int>(nodes.size() - 1);
+                };
+                new_node(-1, 0);
+                size_t leaves = 0;
+                for (const Point &p : points) {
+                    // L* in [0, 100] and a*, b* in [-128, 128] scaled to 8-bit cube coordinates
+                    const int coord[3] = {std::clamp(static_cast<int>(p.v[0] * 2.55), 0, 255),
+                                          std::clamp(static_cast<int>(p.v[1] + 128), 0, 255),
+                                          std::clamp(static_cast<int>(p.v[2] + 128), 0, 255)};
+                    int node = 0;
+                    for (int level = 0; level < depth; ++level) {
+                        const int shift = 7 - level;
+                        const int child = (((coord[0] >> shift) & 1) << 2) | (((coord[1] >> shift) & 1) << 1) |
+                                          ((coord[2] >> shift) & 1);
+                        if (nodes[node].children[child] < 0) {
+                            int created = new_node(node, level + 1);
+                            nodes[node].children[child] = created;
+                            nodes[node].live_children++;
+                        }
+                        node = nodes[node].children[child];
+                    }
+                    if (!nodes[node].leaf) {
+                        nodes[node].leaf = true;
+                        ++leaves;
+                    }
+                    nodes[node].acc.add(p);
+                }
+
+                // Merge the lightest node whose children are all leaves, deepest first, until k leaves remain
+                auto heavier = [&](int x, int y) {
+                    if (nodes[x].level != nodes[y].level) {
+                        return nodes[x].level < nodes[y].level;
+                    }
+                    if (nodes[x].acc.weight != nodes[y].acc.weight) {
+                        return nodes[x].acc.weight > nodes[y].acc.weight;
+                    }
+                    return x > y;
+                };
+                auto subtree_weight = [&](int n) {
+                    for (int c : nodes[n].children) {
+                        if (c >= 0) {
+                            for (int s = 0; s < 3; ++s) {
+                                nodes[n].acc.sum[s] += nodes[c].acc.sum[s];
+                            }
+                            nodes[n].acc.weight += nodes[c].acc.weight;
+                        }
+                    }
+                };
+                std::priority_queue<int, std::vector<int>, decltype(heavier)> reducible(heavier);
+                std::vector<int> leaf_children(nodes.size(), 0);
+                for (size_t n = 0; n < nodes.size(); ++n) {
+                    if (nodes[n].leaf && nodes[n].parent >= 0) {
+                        int parent = nodes[n].parent;
+                        if (++leaf_children[parent] == nodes[parent].live_children) {
+                            subtree_weight(parent);
+                            reducible.push(parent);
+                        }
+                    }
+                }
+                while (leaves > k && !reducible.empty()) {
+                    int n = reducible.top();
+                    reducible.pop();
+                    leaves -= nodes[n].live_children - 1;
+                    nodes[n].leaf = true;
+                    for (int &c : nodes[n].children) {
+                        if (c >= 0) {
+                            nodes[c].leaf = false;
+                            nodes[c].acc.weight = 0;
+                            c = -1;
+                        }
+                    }
+                    int parent = nodes[n].parent;
+                    if (parent >= 0 && ++leaf_children[parent] == nodes[parent].live_children) {
+                        subtree_weight(parent);
+                        reducible.push(parent);
+                    }
+                }
+
+                std::vector<Accumulator> clusters;
+                for (const Node &n : nodes) {
+                    if (n.leaf) {
+                        clusters.push_back(n.acc);
+                    }
+                }
+                return finish(clusters);
+            }
+
+            template <typename Policy>
+            std::vector<RGB> kmeans(const Policy &policy, const std::vector<Point> &points, size_t k, const Options &options) {
+                std::mt19937 gen(options.seed);
+                std::vector<double> weights(points.size());
+                for (size_t i = 0; i < points.size(); ++i) {
+                    weights[i] = points[i].weight;
+                }
+
+                // k-means++ seeding: each new center is drawn with probability proportional to
+                // weight * squared distance to the nearest chosen center
+                std::vector<std::array<double, 3>> centers;
+                std::vector<double> nearest(points.size(), std::numeric_limits<double>::infinity());
+                auto add_center = [&](size_t i) {
+                    centers.push_back({points[i].v[0], points[i].v[1], points[i].v[2]});
+                    const double *c = centers.back().data();
+                    execution::for_each_chunk(policy, points.size(), 4096, [&](size_t lo, size_t hi) {
+                        for (size_t j = lo; j < hi; ++j) {
+                            nearest[j] = std::min(nearest[j], distance2(points[j].v, c));
+                        }
+                    });
+                };
+                add_center(std::discrete_distribution<size_t>(weights.begin(), weights.end())(gen));
+                while (centers.size() < k) {
+                    std::vector<double> score(points.size());
+                    double total = 0;
+                    for (size_t i = 0; i < points.size(); ++i) {
+                        score[i] = weights[i] * nearest[i];
+                        total += score[i];
+                    }
+                    if (total <= 0) {
+                        break; // fewer distinct points than clusters
+                    }
+                    add_center(std::discrete_distribution<size_t>(score.begin(), score.end())(gen));
+                }
+
+                std::vector<uint32_t> assignment(points.size(), 0);
+                auto assign = [&](size_t i) {
+                    uint32_t best = 0;
+                    double best_d = distance2(points[i].v, centers[0].data());
+                    for (size_t c = 1; c < centers.size(); ++c) {
+                        double d = distance2(points[i].v, centers[c].data());
+                        if (d < best_d) {
+                            best_d = d;
+                            best = static_cast<uint32_t>(c);
+                        }
+                    }
+                    return best;
+                };
+
+                if (options.mini_batch) {
+                    // Sculley's mini-batch k-means: per-center learning rate 1 / (samples seen so far)
+                    std::discrete_distribution<size_t> sample(weights.begin(), weights.end());
+                    std::vector<double> seen(centers.size(), 0.0);
+                    std::vector<size_t> batch(options.batch_size);
+                    std::vector<uint32_t> batch_assignment(options.batch_size);
+                    for (size_t it = 0; it < options.max_iterations; ++it) {
+                        for (auto &b : batch) {
+                            b = sample(gen);
+                        }
+                        execution::for_each_chunk(policy, batch.size(), 1024, [&](size_t lo, size_t hi) {
+                            for (size_t i = lo; i < hi; ++i) {
+                                batch_assignment[i] = assign(batch[i]);
+                            }
+                        });
+                        for (size_t i = 0; i < batch.size(); ++i) {
+                            auto &c = centers[batch_assignment[i]];
+                            double rate = 1.0 / ++seen[batch_assignment[i]];
+                            for (int s = 0; s < 3; ++s) {
+                                c[s] += rate * (points[batch[i]].v[s] - c[s]);
+                            }
+                        }
+                    }
+                }
+
+                // Lloyd iterations; in mini-batch mode one final pass assigns every color
+                const size_t iterations = options.mini_batch ? 1 : std::max<size_t>(options.max_iterations, 1);
+                std::vector<Accumulator> clusters;
+                for (size_t it = 0; it < iterations; ++it) {
+                    std::atomic<bool> changed{false};
+                    execution::for_each_chunk(policy, points.size(), 4096, [&](size_t lo, size_t hi) {
+                        bool any = false;
+                        for (size_t i = lo; i < hi; ++i) {
+                            uint32_t a = assign(i);
+                            any = any || a != assignment[i];
+                            assignment[i] = a;
+                        }
+                        if (any) {
+                            changed = true;
+                        }
+                    });
+                    clusters.assign(centers.size(), Accumulator{});
+                    for (size_t i = 0; i < points.size(); ++i) {
+                        clusters[assignment[i]].add(points[i]);
+                    }
+                    for (size_t c = 0; c < centers.size(); ++c) {
+                        if (clusters[c].weight > 0) {
+                            for (int s = 0; s < 3; ++s) {
+                                centers[c][s] = clusters[c].sum[s] / clusters[c].weight;
+                            }
+                        }
+                    }
+                    if (it > 0 && !changed) {
+                        break;
+                    }
+                }
+                return finish(clusters);
+            }
+        } // namespace detail
+
+        template <execution::ExecutionPolicy Policy>
+        Histogram histogram(const Policy &policy, std::span<const RGB> pixels) {
+            std::vector<uint32_t> keys;
+            keys.reserve(pixels.size());
+            for (const RGB &p : pixels) {
+                if (p.a != 0) {
+                    keys.push_back(detail::pack(p.r, p.g, p.b));
+                }
+            }
+            return detail::from_keys(policy, keys);
+        }
+
+        template <execution::ExecutionPolicy Policy>
+        Histogram histogram(const Policy &policy, const PixelBuffer &image) {
+            std::vector<uint32_t> keys;
+            keys.reserve(image.size());
+            const uint8_t *r = image.plane(PixelBuffer::R);
+            const uint8_t *g = image.plane(PixelBuffer::G);
+            const uint8_t *b = image.plane(PixelBuffer::B);
+            const uint8_t *a = image.plane(PixelBuffer::A);
+            for (size_t i = 0; i < image.size(); ++i) {
+                if (a[i] != 0) {
+                    keys.push_back(detail::pack(r[i], g[i], b[i]));
+                }
+            }
+            return detail::from_keys(policy, keys);
+        }
+
+        inline Histogram histogram(std::span<const RGB> pixels) { return histogram(execution::seq, pixels); }
+
+        inline Histogram histogram(const PixelBuffer &image) { return histogram(execution::seq, image); }
+
+        // At most k colors; fewer when the input has fewer unique colors (those are returned exactly)
+        template <execution::ExecutionPolicy Policy>
+        std::vector<RGB> palette(const Policy &policy, const Histogram &hist, size_t k, Method method = Method::KMeans,
+                                 const Options &options = {}) {
+            if (k == 0 || hist.empty()) {
+                return {};
+            }
+            if (hist.size() <= k) {
+                std::vector<size_t> order(hist.size());
+                std::iota(order.begin(), order.end(), size_t(0));
+                std::stable_sort(order.begin(), order.end(),
+                                 [&](size_t x, size_t y) { return hist.counts[x] > hist.counts[y]; });
+                std::vector<RGB> out;
+                for (size_t i : order) {
+                    out.push_back(hist.colors[i]);
+                }
+                return out;
+            }
+
+            std::vector<detail::Point> points(hist.size());
+            execution::for_each_chunk(policy, hist.size(), 4096, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    LAB lab = LAB::fromRGB(hist.colors[i]);
+                    points[i] = {{lab.l, lab.a, lab.b}, static_cast<double>(hist.counts[i])};
+                }
+            });
+
+            switch (method) {
+            case Method::MedianCut: return detail::median_cut(points, k);
+            case Method::Octree: return detail::octree(points, k);
+            default: return detail::kmeans(policy, points, k, options);
+            }
+        }
+
+        template <execution::ExecutionPolicy Policy>
+        std::vector<RGB> palette(const Policy &policy, std::span<const RGB> pixels, size_t k,
+                                 Method method = Method::KMeans, const Options &options = {}) {
+            return palette(policy, histogram(policy, pixels), k, method, options);
+        }
+
+        inline std::vector<RGB> palette(std::span<const RGB> pixels, size_t k, Method method = Method::KMeans,
+                                        const Options &options = {}) {
+            return palette(execution::seq, pixels, k, method, options);
+        }
+
+        inline std::vector<RGB> palette(const PixelBuffer &image, size_t k, Method method = Method::KMeans,
+                                        const Options &options = {}) {
+            return palette(execution::seq, histogram(image), k, method, options);
+        }
+
+    } // namespace extract
+} // namespace pigment
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "types_basic.hpp"
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pigment {
+
+    namespace detail {
+        inline std::array<bool, 256> delimiter_table(std::string_view delimiters) {
+            std::array<bool, 256> table{};
+            for (char c : delimiters) {
+                table[static_cast<unsigned char>(c)] = true;
+            }
+            return table;
+        }
+    } // namespace detail
+
+    // Bulk hex parsing and formatting for large inputs and outputs (logs, CSV columns, JSON/CSS export).
+    // Both directions work on one contiguous buffer with no per-color allocation and no exceptions.
+    namespace hex {
+
+        struct ParseResult {
+            size_t parsed = 0;   // colors written to the output
+            size_t failed = 0;   // malformed tokens, skipped
+            size_t consumed = 0; // bytes of input read; less than the input size when the output filled up
+            ParseError first_error = ParseError::Ok;
+            size_t first_error_offset = 0; // byte offset of the first malformed token
+        };
+
+        inline constexpr std::string_view default_delimiters = ", ;\t\r\n";
+
+        // Number of tokens (maximal runs of non-delimiters) in `text`, valid or not
+        inline size_t count_tokens(std::string_view text, std::string_view delimiters = default_delimiters) {
+            const std::array<bool, 256> is_delimiter = detail::delimiter_table(delimiters);
+            size_t count = 0;
+            bool in_token = false;
+            for (char c : text) {
+                const bool token = !is_delimiter[static_cast<unsigned char>(c)];
+                count += token && !in_token;
+                in_token = token;
+            }
+            return count;
+        }
+
+        // Parse delimiter-separated hex colors from `text` into `out` (RGB or RGBA8). Runs of delimiters
+        // are skipped, so empty tokens are not errors. Malformed tokens are counted and skipped; parsing
+        // stops early once `out` is full, and `consumed` tells where to resume.
+        template <typename Color>
+        ParseResult parse_list(std::string_view text, std::span<Color> out,
+                               std::string_view delimiters = default_delimiters) {
+            const std::array<bool, 256> is_delimiter = detail::delimiter_table(delimiters);
+            auto delimiter_at = [&](size_t i) { return is_delimiter[static_cast<unsigned char>(text[i])]; };
+
+            ParseResult result;
+            size_t pos = 0;
+            const size_t n = text.size();
+            while (pos < n) {
+                while (pos < n && delimiter_at(pos)) {
+                    ++pos;
+                }
+                if (pos == n || result.parsed == out.size()) {
+                    break;
+                }
+                size_t end = pos;
+                while (end < n && !delimiter_at(end)) {
+                    ++end;
+                }
+                int channels[4] = {0, 0, 0, 255};
+                ParseError error = detail::parse_hex(text.substr(pos, end - pos), channels);
+                if (error == ParseError::Ok) {
+                    out[result.parsed++] = Color(RGB(channels[0], channels[1], channels[2], channels[3]));
+                } else if (result.failed++ == 0) {
+                    result.first_error = error;
+                    result.first_error_offset = pos;
+                }
+                pos = end;
+            }
+            result.consumed = pos;
+            return result;
+        }
+
+        // Appends every valid color in `text` to `out`. A counting pass over the delimiters first sizes `out`
+        // to the number of tokens, so text with other columns costs no extra memory.
+        template <typename Color>
+        ParseResult parse_list(std::string_view text, std::vector<Color> &out,
+                               std::string_view delimiters = default_delimiters) {
+            const size_t start = out.size();
+            out.resize(start + count_tokens(text, delimiters));
+            ParseResult result = parse_list(text, std::span<Color>(out).subspan(start), delimiters);
+            out.resize(start + result.parsed);
+            return result;
+        }
+
+        // Space write_list needs for `count` colors
+        constexpr size_t list_capacity(size_t count) { return count * (RGB::max_hex_length + 1); }
+
+        // Write colors (RGB or RGBA8) as delimiter-separated "#rrggbb" / "#rrggbbaa" into `out`, which must
+        // hold list_capacity(colors.size()) characters. Returns the number written; there is no trailing
+        // delimiter and no terminator.
+        template <typename Color>
+        size_t write_list(std::span<const Color> colors, char *out, char delimiter = ',', bool include_alpha = false) {
+            char *p = out;
+            for (size_t i = 0; i < colors.size(); ++i) {
+                p += RGB(colors[i]).write_hex(p, include_alpha);
+                *p++ = delimiter;
+            }
+            return colors.empty() ? 0 : static_cast<size_t>(p - out) - 1;
+        }
+
+        template <typename Color>
+        std::string format_list(std::span<const Color> colors, char delimiter = ',', bool include_alpha = false) {
+            std::string out(list_capacity(colors.size()), '\0');
+            out.resize(write_list(colors, out.data(), delimiter, include_alpha));
+            return out;
+        }
+
+        template <typename Color>
+        std::string format_list(const std::vector<Color> &colors, char delimiter = ',', bool include_alpha = false) {
+            return format_list(std::span<const Color>(colors), delimiter, include_alpha);
+        }
+
+    } // namespace hex
+} // namespace pigment
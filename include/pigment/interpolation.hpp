@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace pigment {
+
+    // Interpolation inside a regular 3D grid of n * n * n nodes, each holding C floats. Nodes are stored
+    // red-fastest (the .cube order): node (r, g, b) starts at ((b * n + g) * n + r) * C.
+    namespace interp {
+
+        enum class Method { Trilinear, Tetrahedral };
+
+        // Cell containing a point given in grid units [0, n - 1] on each axis
+        struct Cell {
+            size_t base = 0;    // offset of the cell's origin node
+            size_t step[3] = {}; // offsets to the next node along r, g and b
+            float frac[3] = {};  // position inside the cell along r, g and b
+        };
+
+        template <size_t C> inline Cell locate(int n, float r, float g, float b) {
+            Cell cell;
+            const float pos[3] = {r, g, b};
+            size_t index[3];
+            const size_t stride[3] = {C, C * n, C * n * n};
+            for (int axis = 0; axis < 3; ++axis) {
+                float p = std::clamp(pos[axis], 0.0f, static_cast<float>(n - 1));
+                int i = std::min(static_cast<int>(p), n - 2);
+                index[axis] = static_cast<size_t>(i);
+                cell.frac[axis] = p - i;
+                cell.step[axis] = stride[axis];
+            }
+            cell.base = index[0] * stride[0] + index[1] * stride[1] + index[2] * stride[2];
+            return cell;
+        }
+
+        template <size_t C> inline void trilinear(const float *grid, const Cell &cell, float *out) {
+            const float *p = grid + cell.base;
+            const size_t sr = cell.step[0], sg = cell.step[1], sb = cell.step[2];
+            const float fr = cell.frac[0], fg = cell.frac[1], fb = cell.frac[2];
+            for (size_t c = 0; c < C; ++c) {
+                float c00 = p[c] + (p[sr + c] - p[c]) * fr;
+                float c10 = p[sg + c] + (p[sg + sr + c] - p[sg + c]) * fr;
+                float c01 = p[sb + c] + (p[sb + sr + c] - p[sb + c]) * fr;
+                float c11 = p[sb + sg + c] + (p[sb + sg + sr + c] - p[sb + sg + c]) * fr;
+                float c0 = c00 + (c10 - c00) * fg;
+                float c1 = c01 + (c11 - c01) * fg;
+                out[c] = c0 + (c1 - c0) * fb;
+            }
+        }
+
+        // Splits the cell into six tetrahedra along its main diagonal and picks the one containing the point:
+        // its four corners (as offsets from the cell's origin node) and their barycentric weights.
+        inline void tetrahedron(const Cell &cell, size_t offset[4], float weight[4]) {
+            // Axes by decreasing fraction for each outcome of (fr >= fg, fg >= fb, fr >= fb); a table lookup
+            // instead of branches, which mispredict on noisy images. Outcomes 3 and 4 are contradictory, and
+            // on ties the corner choice does not matter because the weight between them is zero.
+            static constexpr uint8_t order[8][3] = {{2, 1, 0}, {2, 0, 1}, {1, 2, 0}, {0, 1, 2},
+                                                    {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {0, 1, 2}};
+            const float *f = cell.frac;
+            const uint8_t *o = order[(f[0] >= f[1]) | (f[1] >= f[2]) << 1 | (f[0] >= f[2]) << 2];
+            offset[0] = 0;
+            offset[1] = cell.step[o[0]];
+            offset[2] = offset[1] + cell.step[o[1]];
+            offset[3] = cell.step[0] + cell.step[1] + cell.step[2];
+            weight[1] = f[o[0]] - f[o[1]];
+            weight[2] = f[o[1]] - f[o[2]];
+            weight[3] = f[o[2]];
+            weight[0] = 1.0f - weight[1] - weight[2] - weight[3];
+        }
+
+        // Blends the four corners of the tetrahedron containing the point. Needs 4 node reads instead of 8
+        // and is exact along the gray axis.
+        template <size_t C> inline void tetrahedral(const float *grid, const Cell &cell, float *out) {
+            const float *p = grid + cell.base;
+            size_t s[4];
+            float w[4];
+            tetrahedron(cell, s, w);
+            for (size_t c = 0; c < C; ++c) {
+                out[c] = w[0] * p[c] + w[1] * p[s[1] + c] + w[2] * p[s[2] + c] + w[3] * p[s[3] + c];
+            }
+        }
+
+        template <size_t C> inline void sample(Method method, const float *grid, const Cell &cell, float *out) {
+            if (method == Method::Tetrahedral) {
+                tetrahedral<C>(grid, cell, out);
+            } else {
+                trilinear<C>(grid, cell, out);
+            }
+        }
+
+    } // namespace interp
+} // namespace pigment
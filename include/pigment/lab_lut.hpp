@@ -0,0 +1,157 @@
+#pragma once
+
+#include "interpolation.hpp"
+#include "pixel_buffer.hpp"
+#include "transfer.hpp"
+#include "types_lab.hpp"
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace pigment {
+
+    // Precomputed RGB -> LAB table for converting large images. Nodes are sampled from the same kernel as
+    // LAB::fromRGB and stored as floats; lookups interpolate inside the grid. A grid size of 256 (`exact`)
+    // holds one node per 8-bit value (16M nodes, ~200 MB) and needs no interpolation.
+    //
+    // The table is built on first use; concurrent first lookups are safe and only one thread builds it.
+    // max_delta_e() reports the worst CIE76 error against LAB::fromRGB so callers can trade speed for accuracy.
+    class LabLut {
+      public:
+        static constexpr int exact = 256;
+
+        explicit LabLut(int grid_size = 33, interp::Method method = interp::Method::Tetrahedral)
+            : grid_size_(grid_size), method_(method) {
+            if (grid_size < 2 || grid_size > exact) {
+                throw std::invalid_argument("LabLut: grid size must be between 2 and 256");
+            }
+        }
+
+        LabLut(const LabLut &) = delete;
+        LabLut &operator=(const LabLut &) = delete;
+
+        int grid_size() const { return grid_size_; }
+        interp::Method method() const { return method_; }
+        bool is_exact() const { return grid_size_ == exact; }
+        size_t memory_bytes() const { return node_count() * 3 * sizeof(float); }
+
+        // Build the table now instead of on first lookup
+        void build() const {
+            std::call_once(built_, [this] { fill(); });
+        }
+
+        LAB lookup(const RGB &color) const {
+            build();
+            float lab[3];
+            sample(color.r, color.g, color.b, lab);
+            return LAB(lab[0], lab[1], lab[2], color.a);
+        }
+
+        // Whole-image conversion into planar L, a, b
+        void convert(const PixelBuffer &in, LABBuffer &out) const {
+            build();
+            out.resize(in.width(), in.height());
+            const uint8_t *r = in.plane(PixelBuffer::R);
+            const uint8_t *g = in.plane(PixelBuffer::G);
+            const uint8_t *b = in.plane(PixelBuffer::B);
+            double *l_out = out.plane(0);
+            double *a_out = out.plane(1);
+            double *b_out = out.plane(2);
+            for (size_t i = 0; i < in.size(); ++i) {
+                float lab[3];
+                sample(r[i], g[i], b[i], lab);
+                l_out[i] = lab[0];
+                a_out[i] = lab[1];
+                b_out[i] = lab[2];
+            }
+        }
+
+        std::vector<LAB> convert(const std::vector<RGB> &colors) const {
+            std::vector<LAB> out;
+            out.reserve(colors.size());
+            for (const auto &color : colors) {
+                out.push_back(lookup(color));
+            }
+            return out;
+        }
+
+        // Largest delta E (CIE76) against LAB::fromRGB over every 8-bit color. Computed once and cached;
+        // the first call costs about as much as 16M exact conversions.
+        double max_delta_e() const {
+            std::call_once(measured_, [this] { max_delta_e_ = estimate_max_delta_e(1); });
+            return max_delta_e_;
+        }
+
+        // Same measurement on a sub-grid: every `stride`-th value per channel, always including 255. Strides
+        // that line up with the grid spacing mostly hit nodes and under-report the error.
+        double estimate_max_delta_e(int stride) const {
+            build();
+            stride = std::max(stride, 1);
+            double worst = 0.0;
+            auto next = [stride](int v) { return v == 255 ? 256 : std::min(v + stride, 255); };
+            for (int r = 0; r < 256; r = next(r)) {
+                for (int g = 0; g < 256; g = next(g)) {
+                    for (int b = 0; b < 256; b = next(b)) {
+                        float lab[3];
+                        sample(r, g, b, lab);
+                        LAB expected = LAB::fromRGB(RGB(r, g, b));
+                        worst = std::max(worst, expected.delta_e(LAB(lab[0], lab[1], lab[2])));
+                    }
+                }
+            }
+            return worst;
+        }
+
+      private:
+        int grid_size_;
+        interp::Method method_;
+        mutable std::vector<float> table_;
+        mutable std::once_flag built_;
+        mutable std::once_flag measured_;
+        mutable double max_delta_e_ = 0.0;
+
+        size_t node_count() const {
+            size_t n = static_cast<size_t>(grid_size_);
+            return n * n * n;
+        }
+
+        void fill() const {
+            const int n = grid_size_;
+            std::vector<double> linear(n);
+            for (int i = 0; i < n; ++i) {
+                linear[i] = transfer::srgb_to_linear_exact(static_cast<double>(i) / (n - 1));
+            }
+            table_.resize(node_count() * 3);
+            float *node = table_.data();
+            for (int b = 0; b < n; ++b) {
+                for (int g = 0; g < n; ++g) {
+                    for (int r = 0; r < n; ++r) {
+                        double l, a, bb;
+                        LAB::from_linear(linear[r], linear[g], linear[b], l, a, bb);
+                        *node++ = static_cast<float>(l);
+                        *node++ = static_cast<float>(a);
+                        *node++ = static_cast<float>(bb);
+                    }
+                }
+            }
+        }
+
+        void sample(int r, int g, int b, float *out) const {
+            r = std::clamp(r, 0, 255);
+            g = std::clamp(g, 0, 255);
+            b = std::clamp(b, 0, 255);
+            if (is_exact()) {
+                const float *node = table_.data() + ((static_cast<size_t>(b) * exact + g) * exact + r) * 3;
+                out[0] = node[0];
+                out[1] = node[1];
+                out[2] = node[2];
+                return;
+            }
+            const float scale = static_cast<float>(grid_size_ - 1) / 255.0f;
+            interp::Cell cell = interp::locate<3>(grid_size_, r * scale, g * scale, b * scale);
+            interp::sample<3>(method_, table_.data(), cell, out);
+        }
+    };
+
+} // namespace pigment
@@ -0,0 +1,488 @@
+#pragma once
+
+#include "execution.hpp"
+#include "interpolation.hpp"
+#include "pixel_buffer.hpp"
+#include "simd.hpp"
+#include "types_basic.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pigment {
+
+    // A 3D color lookup table, as shipped in Adobe/Resolve .cube files. The table holds size^3 output
+    // colors sampled on a regular grid over the input domain (normally [0, 1] per channel); colors between
+    // nodes are interpolated trilinearly or tetrahedrally (see interpolation.hpp).
+    //
+    //   Lut3D look = Lut3D::load("film.cube");
+    //   look.apply(execution::par, image);
+    //
+    //   Lut3D baked = Lut3D::bake(execution::par, 33, pipeline); // any RGB -> RGB callable
+    //
+    // Nodes are stored as four floats (R, G, B and padding), so with GCC/Clang vector extensions one pixel
+    // blends whole nodes as 4-float vectors; a single 128-bit register on every target, so there is no
+    // per-level dispatch. Other compilers use the scalar interp kernels. For 8-bit input each channel's cell index and fraction come from a 256-entry table,
+    // so applying the LUT costs the node reads and one blend per pixel. Single-color and bulk results are
+    // identical; alpha passes through.
+    class Lut3D {
+      public:
+        static constexpr int min_size = 2;
+        static constexpr int max_size = 256;
+
+        // Identity table
+        explicit Lut3D(int size = 33, interp::Method method = interp::Method::Tetrahedral)
+            : size_(size), method_(method) {
+            if (size < min_size || size > max_size) {
+                throw std::invalid_argument("Lut3D: size must be between 2 and 256");
+            }
+            table_.resize(node_count() * 4);
+            for (int b = 0; b < size; ++b) {
+                for (int g = 0; g < size; ++g) {
+                    for (int r = 0; r < size; ++r) {
+                        set_node(r, g, b, static_cast<float>(r) / (size - 1), static_cast<float>(g) / (size - 1),
+                                 static_cast<float>(b) / (size - 1));
+                    }
+                }
+            }
+            index();
+        }
+
+        // .cube text. Supports TITLE, LUT_3D_SIZE, DOMAIN_MIN/DOMAIN_MAX and Resolve's LUT_3D_INPUT_RANGE;
+        // other keywords are ignored and 1D LUTs are rejected. Malformed input throws std::invalid_argument
+        // naming the line.
+        static Lut3D parse(std::string_view text, interp::Method method = interp::Method::Tetrahedral) {
+            Parser parser(method);
+            while (!text.empty()) {
+                size_t end = text.find('\n');
+                parser.line(text.substr(0, end));
+                text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+            }
+            return parser.finish();
+        }
+
+        // Streams the input through a fixed line buffer; the table is the only allocation
+        static Lut3D parse(std::istream &in, interp::Method method = interp::Method::Tetrahedral) {
+            Parser parser(method);
+            char buffer[4096];
+            size_t held = 0;
+            while (in) {
+                in.read(buffer + held, static_cast<std::streamsize>(sizeof(buffer) - held));
+                const size_t filled = held + static_cast<size_t>(in.gcount());
+                size_t start = 0;
+                for (size_t i = 0; i < filled; ++i) {
+                    if (buffer[i] == '\n') {
+                        parser.line(std::string_view(buffer + start, i - start));
+                        start = i + 1;
+                    }
+                }
+                held = filled - start;
+                if (held == sizeof(buffer)) {
+                    parser.fail("line too long");
+                }
+                std::memmove(buffer, buffer + start, held);
+            }
+            if (held > 0) {
+                parser.line(std::string_view(buffer, held));
+            }
+            return parser.finish();
+        }
+
+        static Lut3D load(const std::string &path, interp::Method method = interp::Method::Tetrahedral) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) {
+                throw std::invalid_argument("Lut3D: cannot open '" + path + "'");
+            }
+            return parse(in, method);
+        }
+
+        // Samples fn (RGB -> RGB) at every node. Node inputs are rounded to 8-bit values, so sizes where
+        // size - 1 divides 255 (18, 52, 86) sample exactly on the values the table is later applied to.
+        template <execution::ExecutionPolicy Policy, typename Fn>
+        static Lut3D bake(const Policy &policy, int size, Fn &&fn,
+                          interp::Method method = interp::Method::Tetrahedral) {
+            Lut3D lut(size, method);
+            std::array<int, max_size> input;
+            for (int i = 0; i < size; ++i) {
+                input[i] = static_cast<int>(pigment::detail::round(i * 255.0 / (size - 1)));
+            }
+            execution::for_each_chunk(policy, static_cast<size_t>(size), 1, [&](size_t lo, size_t hi) {
+                for (size_t b = lo; b < hi; ++b) {
+                    for (int g = 0; g < size; ++g) {
+                        for (int r = 0; r < size; ++r) {
+                            const RGB out = fn(RGB(input[r], input[g], input[b]));
+                            lut.set_node(r, g, static_cast<int>(b), out.r / 255.0f, out.g / 255.0f,
+                                         out.b / 255.0f);
+                        }
+                    }
+                }
+            });
+            return lut;
+        }
+
+        template <typename Fn>
+        static Lut3D bake(int size, Fn &&fn, interp::Method method = interp::Method::Tetrahedral) {
+            return bake(execution::seq, size, fn, method);
+        }
+
+        // .cube text that parse() reads back exactly
+        void write(std::ostream &out) const {
+            if (!title_.empty()) {
+                out << "TITLE \"" << title_ << "\"\n";
+            }
+            out << "LUT_3D_SIZE " << size_ << '\n';
+            if (domain_min_ != std::array<float, 3>{0, 0, 0} || domain_max_ != std::array<float, 3>{1, 1, 1}) {
+                out << "DOMAIN_MIN";
+                write_floats(out, domain_min_.data());
+                out << "DOMAIN_MAX";
+                write_floats(out, domain_max_.data());
+            }
+            for (size_t i = 0; i < node_count(); ++i) {
+                write_floats(out, table_.data() + i * 4, "");
+            }
+        }
+
+        int size() const { return size_; }
+        interp::Method method() const { return method_; }
+        void set_method(interp::Method method) { method_ = method; }
+        const std::string &title() const { return title_; }
+        const std::array<float, 3> &domain_min() const { return domain_min_; }
+        const std::array<float, 3> &domain_max() const { return domain_max_; }
+        size_t memory_bytes() const { return table_.size() * sizeof(float); }
+
+        // Output color at node (r, g, b), each in [0, 1] for a well-formed table
+        std::array<float, 3> node(int r, int g, int b) const {
+            const float *p = table_.data() + offset(r, g, b);
+            return {p[0], p[1], p[2]};
+        }
+
+        void set_node(int r, int g, int b, float red, float green, float blue) {
+            float *p = table_.data() + offset(r, g, b);
+            p[0] = red;
+            p[1] = green;
+            p[2] = blue;
+            p[3] = 0.0f;
+        }
+
+        RGB apply(const RGB &color) const {
+            uint8_t out[3];
+            if (method_ == interp::Method::Tetrahedral) {
+                sample<interp::Method::Tetrahedral>(channel(color.r), channel(color.g), channel(color.b), out);
+            } else {
+                sample<interp::Method::Trilinear>(channel(color.r), channel(color.g), channel(color.b), out);
+            }
+            return RGB(out[0], out[1], out[2], color.a);
+        }
+
+        RGB operator()(const RGB &color) const { return apply(color); }
+
+        // Whole image; `out` may be `in`
+        template <execution::ExecutionPolicy Policy>
+        void apply(const Policy &policy, const PixelBuffer &in, PixelBuffer &out) const {
+            if (&out != &in && (out.width() != in.width() || out.height() != in.height())) {
+                out = PixelBuffer(in.width(), in.height());
+            }
+            const uint8_t *r = in.plane(PixelBuffer::R);
+            const uint8_t *g = in.plane(PixelBuffer::G);
+            const uint8_t *b = in.plane(PixelBuffer::B);
+            const uint8_t *a = in.plane(PixelBuffer::A);
+            uint8_t *r_out = out.plane(PixelBuffer::R);
+            uint8_t *g_out = out.plane(PixelBuffer::G);
+            uint8_t *b_out = out.plane(PixelBuffer::B);
+            uint8_t *a_out = out.plane(PixelBuffer::A);
+            execution::for_each_chunk(policy, in.size(), execution::chunk_for<RGBA8>(), [&](size_t lo, size_t hi) {
+                auto run = [&]<interp::Method M>() {
+                    for (size_t i = lo; i < hi; ++i) {
+                        uint8_t rgb[3];
+                        sample<M>(r[i], g[i], b[i], rgb);
+                        r_out[i] = rgb[0];
+                        g_out[i] = rgb[1];
+                        b_out[i] = rgb[2];
+                    }
+                };
+                if (method_ == interp::Method::Tetrahedral) {
+                    run.template operator()<interp::Method::Tetrahedral>();
+                } else {
+                    run.template operator()<interp::Method::Trilinear>();
+                }
+                if (a_out != a) {
+                    std::memcpy(a_out + lo, a + lo, hi - lo);
+                }
+            });
+        }
+
+        void apply(const PixelBuffer &in, PixelBuffer &out) const { apply(execution::seq, in, out); }
+
+        template <execution::ExecutionPolicy Policy> void apply(const Policy &policy, PixelBuffer &image) const {
+            apply(policy, image, image);
+        }
+
+        void apply(PixelBuffer &image) const { apply(execution::seq, image); }
+
+        // In place over interleaved colors
+        template <execution::ExecutionPolicy Policy> void apply(const Policy &policy, std::span<RGB> colors) const {
+            execution::for_each_chunk(policy, colors.size(), execution::chunk_for<RGB>(), [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    colors[i] = apply(colors[i]);
+                }
+            });
+        }
+
+        void apply(std::span<RGB> colors) const { apply(execution::seq, colors); }
+
+      private:
+#if PIGMENT_HAS_VECTOR_EXT
+        using Node = simd::detail::Lanes<4>::f32;
+#endif
+
+        // Cell index (as a table offset) and position inside the cell for every 8-bit value of one channel
+        struct Axis {
+            std::array<uint32_t, 256> offset;
+            std::array<float, 256> frac;
+        };
+
+        int size_;
+        interp::Method method_;
+        std::string title_;
+        std::array<float, 3> domain_min_ = {0.0f, 0.0f, 0.0f};
+        std::array<float, 3> domain_max_ = {1.0f, 1.0f, 1.0f};
+        std::vector<float> table_;
+        std::array<Axis, 3> axes_;
+
+        Lut3D(int size, interp::Method method, std::vector<float> table, std::string title,
+              const std::array<float, 3> &domain_min, const std::array<float, 3> &domain_max)
+            : size_(size), method_(method), title_(std::move(title)), domain_min_(domain_min),
+              domain_max_(domain_max), table_(std::move(table)) {
+            index();
+        }
+
+        size_t node_count() const {
+            size_t n = static_cast<size_t>(size_);
+            return n * n * n;
+        }
+
+        size_t offset(int r, int g, int b) const {
+            const size_t n = static_cast<size_t>(size_);
+            return ((static_cast<size_t>(b) * n + static_cast<size_t>(g)) * n + static_cast<size_t>(r)) * 4;
+        }
+
+        static uint8_t channel(int v) { return static_cast<uint8_t>(std::clamp(v, 0, 255)); }
+
+        // Rebuilds the per-channel lookups after the size or domain changes
+        void index() {
+            const size_t stride[3] = {4, 4 * static_cast<size_t>(size_), 4 * node_count() / size_};
+            for (int axis = 0; axis < 3; ++axis) {
+                const float lo = domain_min_[axis], span = domain_max_[axis] - lo;
+                for (int v = 0; v < 256; ++v) {
+                    interp::Cell cell =
+                        interp::locate<4>(size_, (v / 255.0f - lo) / span * (size_ - 1), 0.0f, 0.0f);
+                    axes_[axis].offset[v] = static_cast<uint32_t>(cell.base / 4 * stride[axis]);
+                    axes_[axis].frac[v] = cell.frac[0];
+                }
+            }
+        }
+
+#if PIGMENT_HAS_VECTOR_EXT
+        static Node load(const float *p) {
+            Node v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+#endif
+
+        template <interp::Method M>
+        PIGMENT_SIMD_INLINE void sample(uint8_t r, uint8_t g, uint8_t b, uint8_t *out) const {
+            interp::Cell cell;
+            cell.base = size_t(axes_[0].offset[r]) + axes_[1].offset[g] + axes_[2].offset[b];
+            cell.step[0] = 4;
+            cell.step[1] = 4 * static_cast<size_t>(size_);
+            cell.step[2] = cell.step[1] * static_cast<size_t>(size_);
+            cell.frac[0] = axes_[0].frac[r];
+            cell.frac[1] = axes_[1].frac[g];
+            cell.frac[2] = axes_[2].frac[b];
+
+#if PIGMENT_HAS_VECTOR_EXT
+            const float *p = table_.data() + cell.base;
+            Node v;
+            if constexpr (M == interp::Method::Tetrahedral) {
+                size_t s[4];
+                float w[4];
+                interp::tetrahedron(cell, s, w);
+                v = w[0] * load(p) + w[1] * load(p + s[1]) + w[2] * load(p + s[2]) + w[3] * load(p + s[3]);
+            } else {
+                const size_t sr = cell.step[0], sg = cell.step[1], sb = cell.step[2];
+                const float fr = cell.frac[0], fg = cell.frac[1], fb = cell.frac[2];
+                Node c00 = load(p) + (load(p + sr) - load(p)) * fr;
+                Node c10 = load(p + sg) + (load(p + sg + sr) - load(p + sg)) * fr;
+                Node c01 = load(p + sb) + (load(p + sb + sr) - load(p + sb)) * fr;
+                Node c11 = load(p + sb + sg) + (load(p + sb + sg + sr) - load(p + sb + sg)) * fr;
+                Node c0 = c00 + (c10 - c00) * fg;
+                Node c1 = c01 + (c11 - c01) * fg;
+                v = c0 + (c1 - c0) * fb;
+            }
+            const Node zero{};
+            v = v * 255.0f + 0.5f;
+            v = v < 0.0f ? zero : v;
+            v = v > 255.0f ? zero + 255.0f : v;
+            const auto q = PIGMENT_SIMD_CONVERT(v, simd::detail::Lanes<4>::i32);
+            out[0] = static_cast<uint8_t>(q[0]);
+            out[1] = static_cast<uint8_t>(q[1]);
+            out[2] = static_cast<uint8_t>(q[2]);
+#else
+            float v[3];
+            if constexpr (M == interp::Method::Tetrahedral) {
+                interp::tetrahedral<3>(table_.data(), cell, v);
+            } else {
+                interp::trilinear<3>(table_.data(), cell, v);
+            }
+            for (int c = 0; c < 3; ++c) {
+                out[c] = static_cast<uint8_t>(std::clamp(v[c] * 255.0f + 0.5f, 0.0f, 255.0f));
+            }
+#endif
+        }
+
+        static void write_floats(std::ostream &out, const float *v, const char *lead = " ") {
+            char text[32];
+            for (int c = 0; c < 3; ++c) {
+                auto end = std::to_chars(text, text + sizeof(text), v[c]).ptr;
+                out << (c == 0 ? lead : " ") << std::string_view(text, static_cast<size_t>(end - text));
+            }
+            out << '\n';
+        }
+
+        // Line-at-a-time .cube reader; data rows are written straight into the table
+        class Parser {
+          public:
+            explicit Parser(interp::Method method) : method_(method) {}
+
+            [[noreturn]] void fail(const char *what) const {
+                throw std::invalid_argument("Lut3D: line " + std::to_string(line_number_) + ": " + what);
+            }
+
+            void line(std::string_view text) {
+                ++line_number_;
+                text = trim(text);
+                if (text.empty() || text[0] == '#') {
+                    return;
+                }
+                const char first = text[0];
+                if ((first >= '0' && first <= '9') || first == '-' || first == '+' || first == '.') {
+                    row(text);
+                    return;
+                }
+                const size_t space = text.find_first_of(" \t");
+                const std::string_view key = text.substr(0, space);
+                const std::string_view rest = space == std::string_view::npos ? std::string_view() : trim(text.substr(space));
+                if (key == "TITLE") {
+                    title_ = rest.size() >= 2 && rest.front() == '"' && rest.back() == '"'
+                                 ? std::string(rest.substr(1, rest.size() - 2))
+                                 : std::string(rest);
+                } else if (key == "LUT_3D_SIZE") {
+                    if (size_ != 0) {
+                        fail("LUT_3D_SIZE given twice");
+                    }
+                    float size;
+                    numbers(rest, &size, 1);
+                    // Range first: NaN fails it, and the cast below is only defined inside it
+                    if (!(size >= min_size && size <= max_size) || size != static_cast<int>(size)) {
+                        fail("LUT_3D_SIZE must be an integer between 2 and 256");
+                    }
+                    size_ = static_cast<int>(size);
+                    table_.resize(static_cast<size_t>(size_) * size_ * size_ * 4);
+                } else if (key == "DOMAIN_MIN") {
+                    numbers(rest, domain_min_.data(), 3);
+                } else if (key == "DOMAIN_MAX") {
+                    numbers(rest, domain_max_.data(), 3);
+                } else if (key == "LUT_3D_INPUT_RANGE") {
+                    float range[2];
+                    numbers(rest, range, 2);
+                    domain_min_.fill(range[0]);
+                    domain_max_.fill(range[1]);
+                } else if (key == "LUT_1D_SIZE") {
+                    fail("1D LUTs are not supported");
+                }
+            }
+
+            Lut3D finish() {
+                if (size_ == 0) {
+                    fail("missing LUT_3D_SIZE");
+                }
+                if (rows_ * 4 != table_.size()) {
+                    fail("expected LUT_3D_SIZE^3 data rows");
+                }
+                for (int axis = 0; axis < 3; ++axis) {
+                    if (!(domain_min_[axis] < domain_max_[axis])) {
+                        fail("DOMAIN_MIN must be below DOMAIN_MAX");
+                    }
+                }
+                return Lut3D(size_, method_, std::move(table_), std::move(title_), domain_min_, domain_max_);
+            }
+
+          private:
+            interp::Method method_;
+            size_t line_number_ = 0;
+            size_t rows_ = 0;
+            std::string title_;
+            std::array<float, 3> domain_min_ = {0.0f, 0.0f, 0.0f};
+            std::array<float, 3> domain_max_ = {1.0f, 1.0f, 1.0f};
+            int size_ = 0;
+            std::vector<float> table_; // allocated once LUT_3D_SIZE is known
+
+            static std::string_view trim(std::string_view text) {
+                const size_t first = text.find_first_not_of(" \t\r");
+                if (first == std::string_view::npos) {
+                    return {};
+                }
+                return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+            }
+
+            // Exactly `count` whitespace-separated numbers
+            void numbers(std::string_view text, float *out, int count) const {
+                const char *p = text.data(), *end = text.data() + text.size();
+                for (int i = 0; i < count; ++i) {
+                    while (p < end && (*p == ' ' || *p == '\t')) {
+                        ++p;
+                    }
+                    if (p < end && *p == '+') {
+                        ++p;
+                    }
+                    auto [next, error] = std::from_chars(p, end, out[i]);
+                    if (error != std::errc() || (next < end && *next != ' ' && *next != '\t')) {
+                        fail("expected a number");
+                    }
+                    p = next;
+                }
+                while (p < end && (*p == ' ' || *p == '\t')) {
+                    ++p;
+                }
+                if (p != end) {
+                    fail("too many values");
+                }
+            }
+
+            void row(std::string_view text) {
+                if (size_ == 0) {
+                    fail("data before LUT_3D_SIZE");
+                }
+                if (rows_ * 4 == table_.size()) {
+                    fail("more data rows than LUT_3D_SIZE^3");
+                }
+                float *node = table_.data() + rows_ * 4;
+                numbers(text, node, 3);
+                node[3] = 0.0f;
+                ++rows_;
+            }
+        };
+    };
+
+} // namespace pigment
@@ -7,169 +7,171 @@
 namespace pigment {
     namespace colors {
 
+        // Every named color is a compile-time constant (detail::hex_rgb is consteval)
+
         // Red and Pink Variations
         // Encompasses various shades of red, from light pinks to deep crimsons
-        inline RGB indianred() { return RGB("#CD5C5C"); }
-        inline RGB lightcoral() { return RGB("#F08080"); }
-        inline RGB salmon() { return RGB("#FA8072"); }
-        inline RGB darksalmon() { return RGB("#E9967A"); }
-        inline RGB lightsalmon() { return RGB("#FFA07A"); }
-        inline RGB crimson() { return RGB("#DC143C"); }
-        inline RGB red() { return RGB("#FF0000"); }
-        inline RGB firebrick() { return RGB("#B22222"); }
-        inline RGB darkred() { return RGB("#8B0000"); }
-        inline RGB pink() { return RGB("#FFC0CB"); }
-        inline RGB lightpink() { return RGB("#FFB6C1"); }
-        inline RGB hotpink() { return RGB("#FF69B4"); }
-        inline RGB deeppink() { return RGB("#FF1493"); }
-        inline RGB mediumvioletred() { return RGB("#C71585"); }
-        inline RGB palevioletred() { return RGB("#DB7093"); }
+        inline constexpr RGB indianred() { return detail::hex_rgb("#CD5C5C"); }
+        inline constexpr RGB lightcoral() { return detail::hex_rgb("#F08080"); }
+        inline constexpr RGB salmon() { return detail::hex_rgb("#FA8072"); }
+        inline constexpr RGB darksalmon() { return detail::hex_rgb("#E9967A"); }
+        inline constexpr RGB lightsalmon() { return detail::hex_rgb("#FFA07A"); }
+        inline constexpr RGB crimson() { return detail::hex_rgb("#DC143C"); }
+        inline constexpr RGB red() { return detail::hex_rgb("#FF0000"); }
+        inline constexpr RGB firebrick() { return detail::hex_rgb("#B22222"); }
+        inline constexpr RGB darkred() { return detail::hex_rgb("#8B0000"); }
+        inline constexpr RGB pink() { return detail::hex_rgb("#FFC0CB"); }
+        inline constexpr RGB lightpink() { return detail::hex_rgb("#FFB6C1"); }
+        inline constexpr RGB hotpink() { return detail::hex_rgb("#FF69B4"); }
+        inline constexpr RGB deeppink() { return detail::hex_rgb("#FF1493"); }
+        inline constexpr RGB mediumvioletred() { return detail::hex_rgb("#C71585"); }
+        inline constexpr RGB palevioletred() { return detail::hex_rgb("#DB7093"); }
 
         // Orange and Yellow Hues
         // Warm colors ranging from coral to golden yellows
-        inline RGB coral() { return RGB("#FF7F50"); }
-        inline RGB tomato() { return RGB("#FF6347"); }
-        inline RGB orangered() { return RGB("#FF4500"); }
-        inline RGB darkorange() { return RGB("#FF8C00"); }
-        inline RGB orange() { return RGB("#FFA500"); }
-        inline RGB gold() { return RGB("#FFD700"); }
-        inline RGB yellow() { return RGB("#FFFF00"); }
-        inline RGB lightyellow() { return RGB("#FFFFE0"); }
-        inline RGB lemonchiffon() { return RGB("#FFFACD"); }
-        inline RGB lightgoldenrodyellow() { return RGB("#FAFAD2"); }
-        inline RGB papayawhip() { return RGB("#FFEFD5"); }
-        inline RGB moccasin() { return RGB("#FFE4B5"); }
-        inline RGB peachpuff() { return RGB("#FFDAB9"); }
-        inline RGB palegoldenrod() { return RGB("#EEE8AA"); }
-        inline RGB khaki() { return RGB("#F0E68C"); }
-        inline RGB darkkhaki() { return RGB("#BDB76B"); }
+        inline constexpr RGB coral() { return detail::hex_rgb("#FF7F50"); }
+        inline constexpr RGB tomato() { return detail::hex_rgb("#FF6347"); }
+        inline constexpr RGB orangered() { return detail::hex_rgb("#FF4500"); }
+        inline constexpr RGB darkorange() { return detail::hex_rgb("#FF8C00"); }
+        inline constexpr RGB orange() { return detail::hex_rgb("#FFA500"); }
+        inline constexpr RGB gold() { return detail::hex_rgb("#FFD700"); }
+        inline constexpr RGB yellow() { return detail::hex_rgb("#FFFF00"); }
+        inline constexpr RGB lightyellow() { return detail::hex_rgb("#FFFFE0"); }
+        inline constexpr RGB lemonchiffon() { return detail::hex_rgb("#FFFACD"); }
+        inline constexpr RGB lightgoldenrodyellow() { return detail::hex_rgb("#FAFAD2"); }
+        inline constexpr RGB papayawhip() { return detail::hex_rgb("#FFEFD5"); }
+        inline constexpr RGB moccasin() { return detail::hex_rgb("#FFE4B5"); }
+        inline constexpr RGB peachpuff() { return detail::hex_rgb("#FFDAB9"); }
+        inline constexpr RGB palegoldenrod() { return detail::hex_rgb("#EEE8AA"); }
+        inline constexpr RGB khaki() { return detail::hex_rgb("#F0E68C"); }
+        inline constexpr RGB darkkhaki() { return detail::hex_rgb("#BDB76B"); }
 
         // Purple and Violet Shades
         // Range from light lavender to deep purple and indigo
-        inline RGB lavender() { return RGB("#E6E6FA"); }
-        inline RGB thistle() { return RGB("#D8BFD8"); }
-        inline RGB plum() { return RGB("#DDA0DD"); }
-        inline RGB violet() { return RGB("#EE82EE"); }
-        inline RGB orchid() { return RGB("#DA70D6"); }
-        inline RGB fuchsia() { return RGB("#FF00FF"); }
-        inline RGB magenta() { return RGB("#FF00FF"); }
-        inline RGB mediumorchid() { return RGB("#BA55D3"); }
-        inline RGB mediumpurple() { return RGB("#9370DB"); }
-        inline RGB blueviolet() { return RGB("#8A2BE2"); }
-        inline RGB darkviolet() { return RGB("#9400D3"); }
-        inline RGB darkorchid() { return RGB("#9932CC"); }
-        inline RGB darkmagenta() { return RGB("#8B008B"); }
-        inline RGB purple() { return RGB("#800080"); }
-        inline RGB rebeccapurple() { return RGB("#663399"); }
-        inline RGB indigo() { return RGB("#4B0082"); }
+        inline constexpr RGB lavender() { return detail::hex_rgb("#E6E6FA"); }
+        inline constexpr RGB thistle() { return detail::hex_rgb("#D8BFD8"); }
+        inline constexpr RGB plum() { return detail::hex_rgb("#DDA0DD"); }
+        inline constexpr RGB violet() { return detail::hex_rgb("#EE82EE"); }
+        inline constexpr RGB orchid() { return detail::hex_rgb("#DA70D6"); }
+        inline constexpr RGB fuchsia() { return detail::hex_rgb("#FF00FF"); }
+        inline constexpr RGB magenta() { return detail::hex_rgb("#FF00FF"); }
+        inline constexpr RGB mediumorchid() { return detail::hex_rgb("#BA55D3"); }
+        inline constexpr RGB mediumpurple() { return detail::hex_rgb("#9370DB"); }
+        inline constexpr RGB blueviolet() { return detail::hex_rgb("#8A2BE2"); }
+        inline constexpr RGB darkviolet() { return detail::hex_rgb("#9400D3"); }
+        inline constexpr RGB darkorchid() { return detail::hex_rgb("#9932CC"); }
+        inline constexpr RGB darkmagenta() { return detail::hex_rgb("#8B008B"); }
+        inline constexpr RGB purple() { return detail::hex_rgb("#800080"); }
+        inline constexpr RGB rebeccapurple() { return detail::hex_rgb("#663399"); }
+        inline constexpr RGB indigo() { return detail::hex_rgb("#4B0082"); }
 
         // Green Variations
         // Full spectrum of greens from yellow-green to forest green
-        inline RGB greenyellow() { return RGB("#ADFF2F"); }
-        inline RGB chartreuse() { return RGB("#7FFF00"); }
-        inline RGB lawngreen() { return RGB("#7CFC00"); }
-        inline RGB lime() { return RGB("#00FF00"); }
-        inline RGB limegreen() { return RGB("#32CD32"); }
-        inline RGB palegreen() { return RGB("#98FB98"); }
-        inline RGB lightgreen() { return RGB("#90EE90"); }
-        inline RGB mediumspringgreen() { return RGB("#00FA9A"); }
-        inline RGB springgreen() { return RGB("#00FF7F"); }
-        inline RGB mediumseagreen() { return RGB("#3CB371"); }
-        inline RGB seagreen() { return RGB("#2E8B57"); }
-        inline RGB forestgreen() { return RGB("#228B22"); }
-        inline RGB green() { return RGB("#008000"); }
-        inline RGB darkgreen() { return RGB("#006400"); }
-        inline RGB yellowgreen() { return RGB("#9ACD32"); }
-        inline RGB olivedrab() { return RGB("#6B8E23"); }
-        inline RGB olive() { return RGB("#808000"); }
-        inline RGB darkolivegreen() { return RGB("#556B2F"); }
+        inline constexpr RGB greenyellow() { return detail::hex_rgb("#ADFF2F"); }
+        inline constexpr RGB chartreuse() { return detail::hex_rgb("#7FFF00"); }
+        inline constexpr RGB lawngreen() { return detail::hex_rgb("#7CFC00"); }
+        inline constexpr RGB lime() { return detail::hex_rgb("#00FF00"); }
+        inline constexpr RGB limegreen() { return detail::hex_rgb("#32CD32"); }
+        inline constexpr RGB palegreen() { return detail::hex_rgb("#98FB98"); }
+        inline constexpr RGB lightgreen() { return detail::hex_rgb("#90EE90"); }
+        inline constexpr RGB mediumspringgreen() { return detail::hex_rgb("#00FA9A"); }
+        inline constexpr RGB springgreen() { return detail::hex_rgb("#00FF7F"); }
+        inline constexpr RGB mediumseagreen() { return detail::hex_rgb("#3CB371"); }
+        inline constexpr RGB seagreen() { return detail::hex_rgb("#2E8B57"); }
+        inline constexpr RGB forestgreen() { return detail::hex_rgb("#228B22"); }
+        inline constexpr RGB green() { return detail::hex_rgb("#008000"); }
+        inline constexpr RGB darkgreen() { return detail::hex_rgb("#006400"); }
+        inline constexpr RGB yellowgreen() { return detail::hex_rgb("#9ACD32"); }
+        inline constexpr RGB olivedrab() { return detail::hex_rgb("#6B8E23"); }
+        inline constexpr RGB olive() { return detail::hex_rgb("#808000"); }
+        inline constexpr RGB darkolivegreen() { return detail::hex_rgb("#556B2F"); }
 
         // Cyan and Turquoise Colors
         // Aquatic colors ranging from light cyan to deep teal
-        inline RGB mediumaquamarine() { return RGB("#66CDAA"); }
-        inline RGB aqua() { return RGB("#00FFFF"); }
-        inline RGB cyan() { return RGB("#00FFFF"); }
-        inline RGB lightcyan() { return RGB("#E0FFFF"); }
-        inline RGB paleturquoise() { return RGB("#AFEEEE"); }
-        inline RGB aquamarine() { return RGB("#7FFFD4"); }
-        inline RGB turquoise() { return RGB("#40E0D0"); }
-        inline RGB mediumturquoise() { return RGB("#48D1CC"); }
-        inline RGB darkturquoise() { return RGB("#00CED1"); }
-        inline RGB lightseagreen() { return RGB("#20B2AA"); }
-        inline RGB cadetblue() { return RGB("#5F9EA0"); }
-        inline RGB darkcyan() { return RGB("#008B8B"); }
-        inline RGB teal() { return RGB("#008080"); }
+        inline constexpr RGB mediumaquamarine() { return detail::hex_rgb("#66CDAA"); }
+        inline constexpr RGB aqua() { return detail::hex_rgb("#00FFFF"); }
+        inline constexpr RGB cyan() { return detail::hex_rgb("#00FFFF"); }
+        inline constexpr RGB lightcyan() { return detail::hex_rgb("#E0FFFF"); }
+        inline constexpr RGB paleturquoise() { return detail::hex_rgb("#AFEEEE"); }
+        inline constexpr RGB aquamarine() { return detail::hex_rgb("#7FFFD4"); }
+        inline constexpr RGB turquoise() { return detail::hex_rgb("#40E0D0"); }
+        inline constexpr RGB mediumturquoise() { return detail::hex_rgb("#48D1CC"); }
+        inline constexpr RGB darkturquoise() { return detail::hex_rgb("#00CED1"); }
+        inline constexpr RGB lightseagreen() { return detail::hex_rgb("#20B2AA"); }
+        inline constexpr RGB cadetblue() { return detail::hex_rgb("#5F9EA0"); }
+        inline constexpr RGB darkcyan() { return detail::hex_rgb("#008B8B"); }
+        inline constexpr RGB teal() { return detail::hex_rgb("#008080"); }
 
         // Blue Variations
         // Complete range of blues from light to navy
-        inline RGB lightsteelblue() { return RGB("#B0C4DE"); }
-        inline RGB powderblue() { return RGB("#B0E0E6"); }
-        inline RGB lightblue() { return RGB("#ADD8E6"); }
-        inline RGB skyblue() { return RGB("#87CEEB"); }
-        inline RGB lightskyblue() { return RGB("#87CEFA"); }
-        inline RGB deepskyblue() { return RGB("#00BFFF"); }
-        inline RGB dodgerblue() { return RGB("#1E90FF"); }
-        inline RGB cornflowerblue() { return RGB("#6495ED"); }
-        inline RGB steelblue() { return RGB("#4682B4"); }
-        inline RGB royalblue() { return RGB("#4169E1"); }
-        inline RGB blue() { return RGB("#0000FF"); }
-        inline RGB mediumblue() { return RGB("#0000CD"); }
-        inline RGB darkblue() { return RGB("#00008B"); }
-        inline RGB navy() { return RGB("#000080"); }
-        inline RGB midnightblue() { return RGB("#191970"); }
+        inline constexpr RGB lightsteelblue() { return detail::hex_rgb("#B0C4DE"); }
+        inline constexpr RGB powderblue() { return detail::hex_rgb("#B0E0E6"); }
+        inline constexpr RGB lightblue() { return detail::hex_rgb("#ADD8E6"); }
+        inline constexpr RGB skyblue() { return detail::hex_rgb("#87CEEB"); }
+        inline constexpr RGB lightskyblue() { return detail::hex_rgb("#87CEFA"); }
+        inline constexpr RGB deepskyblue() { return detail::hex_rgb("#00BFFF"); }
+        inline constexpr RGB dodgerblue() { return detail::hex_rgb("#1E90FF"); }
+        inline constexpr RGB cornflowerblue() { return detail::hex_rgb("#6495ED"); }
+        inline constexpr RGB steelblue() { return detail::hex_rgb("#4682B4"); }
+        inline constexpr RGB royalblue() { return detail::hex_rgb("#4169E1"); }
+        inline constexpr RGB blue() { return detail::hex_rgb("#0000FF"); }
+        inline constexpr RGB mediumblue() { return detail::hex_rgb("#0000CD"); }
+        inline constexpr RGB darkblue() { return detail::hex_rgb("#00008B"); }
+        inline constexpr RGB navy() { return detail::hex_rgb("#000080"); }
+        inline constexpr RGB midnightblue() { return detail::hex_rgb("#191970"); }
 
         // Brown and Earth Tones
         // Natural earth-toned colors from light tan to deep brown
-        inline RGB cornsilk() { return RGB("#FFF8DC"); }
-        inline RGB blanchedalmond() { return RGB("#FFEBCD"); }
-        inline RGB bisque() { return RGB("#FFE4C4"); }
-        inline RGB navajowhite() { return RGB("#FFDEAD"); }
-        inline RGB wheat() { return RGB("#F5DEB3"); }
-        inline RGB burlywood() { return RGB("#DEB887"); }
-        inline RGB tan() { return RGB("#D2B48C"); }
-        inline RGB rosybrown() { return RGB("#BC8F8F"); }
-        inline RGB sandybrown() { return RGB("#F4A460"); }
-        inline RGB goldenrod() { return RGB("#DAA520"); }
-        inline RGB darkgoldenrod() { return RGB("#B8860B"); }
-        inline RGB peru() { return RGB("#CD853F"); }
-        inline RGB chocolate() { return RGB("#D2691E"); }
-        inline RGB saddlebrown() { return RGB("#8B4513"); }
-        inline RGB sienna() { return RGB("#A0522D"); }
-        inline RGB brown() { return RGB("#A52A2A"); }
-        inline RGB maroon() { return RGB("#800000"); }
+        inline constexpr RGB cornsilk() { return detail::hex_rgb("#FFF8DC"); }
+        inline constexpr RGB blanchedalmond() { return detail::hex_rgb("#FFEBCD"); }
+        inline constexpr RGB bisque() { return detail::hex_rgb("#FFE4C4"); }
+        inline constexpr RGB navajowhite() { return detail::hex_rgb("#FFDEAD"); }
+        inline constexpr RGB wheat() { return detail::hex_rgb("#F5DEB3"); }
+        inline constexpr RGB burlywood() { return detail::hex_rgb("#DEB887"); }
+        inline constexpr RGB tan() { return detail::hex_rgb("#D2B48C"); }
+        inline constexpr RGB rosybrown() { return detail::hex_rgb("#BC8F8F"); }
+        inline constexpr RGB sandybrown() { return detail::hex_rgb("#F4A460"); }
+        inline constexpr RGB goldenrod() { return detail::hex_rgb("#DAA520"); }
+        inline constexpr RGB darkgoldenrod() { return detail::hex_rgb("#B8860B"); }
+        inline constexpr RGB peru() { return detail::hex_rgb("#CD853F"); }
+        inline constexpr RGB chocolate() { return detail::hex_rgb("#D2691E"); }
+        inline constexpr RGB saddlebrown() { return detail::hex_rgb("#8B4513"); }
+        inline constexpr RGB sienna() { return detail::hex_rgb("#A0522D"); }
+        inline constexpr RGB brown() { return detail::hex_rgb("#A52A2A"); }
+        inline constexpr RGB maroon() { return detail::hex_rgb("#800000"); }
 
         // White and Off-White Shades
         // Pure white and various warm and cool white tints
-        inline RGB white() { return RGB("#FFFFFF"); }
-        inline RGB snow() { return RGB("#FFFAFA"); }
-        inline RGB honeydew() { return RGB("#F0FFF0"); }
-        inline RGB mintcream() { return RGB("#F5FFFA"); }
-        inline RGB azure() { return RGB("#F0FFFF"); }
-        inline RGB aliceblue() { return RGB("#F0F8FF"); }
-        inline RGB ghostwhite() { return RGB("#F8F8FF"); }
-        inline RGB whitesmoke() { return RGB("#F5F5F5"); }
-        inline RGB seashell() { return RGB("#FFF5EE"); }
-        inline RGB beige() { return RGB("#F5F5DC"); }
-        inline RGB oldlace() { return RGB("#FDF5E6"); }
-        inline RGB floralwhite() { return RGB("#FFFAF0"); }
-        inline RGB ivory() { return RGB("#FFFFF0"); }
-        inline RGB antiquewhite() { return RGB("#FAEBD7"); }
-        inline RGB linen() { return RGB("#FAF0E6"); }
-        inline RGB lavenderblush() { return RGB("#FFF0F5"); }
-        inline RGB mistyrose() { return RGB("#FFE4E1"); }
+        inline constexpr RGB white() { return detail::hex_rgb("#FFFFFF"); }
+        inline constexpr RGB snow() { return detail::hex_rgb("#FFFAFA"); }
+        inline constexpr RGB honeydew() { return detail::hex_rgb("#F0FFF0"); }
+        inline constexpr RGB mintcream() { return detail::hex_rgb("#F5FFFA"); }
+        inline constexpr RGB azure() { return detail::hex_rgb("#F0FFFF"); }
+        inline constexpr RGB aliceblue() { return detail::hex_rgb("#F0F8FF"); }
+        inline constexpr RGB ghostwhite() { return detail::hex_rgb("#F8F8FF"); }
+        inline constexpr RGB whitesmoke() { return detail::hex_rgb("#F5F5F5"); }
+        inline constexpr RGB seashell() { return detail::hex_rgb("#FFF5EE"); }
+        inline constexpr RGB beige() { return detail::hex_rgb("#F5F5DC"); }
+        inline constexpr RGB oldlace() { return detail::hex_rgb("#FDF5E6"); }
+        inline constexpr RGB floralwhite() { return detail::hex_rgb("#FFFAF0"); }
+        inline constexpr RGB ivory() { return detail::hex_rgb("#FFFFF0"); }
+        inline constexpr RGB antiquewhite() { return detail::hex_rgb("#FAEBD7"); }
+        inline constexpr RGB linen() { return detail::hex_rgb("#FAF0E6"); }
+        inline constexpr RGB lavenderblush() { return detail::hex_rgb("#FFF0F5"); }
+        inline constexpr RGB mistyrose() { return detail::hex_rgb("#FFE4E1"); }
 
         // Gray Scale
         // Complete range of grays from light to dark
-        inline RGB gainsboro() { return RGB("#DCDCDC"); }
-        inline RGB lightgray() { return RGB("#D3D3D3"); }
-        inline RGB silver() { return RGB("#C0C0C0"); }
-        inline RGB darkgray() { return RGB("#A9A9A9"); }
-        inline RGB gray() { return RGB("#808080"); }
-        inline RGB dimgray() { return RGB("#696969"); }
-        inline RGB lightslategray() { return RGB("#778899"); }
-        inline RGB slategray() { return RGB("#708090"); }
-        inline RGB darkslategray() { return RGB("#2F4F4F"); }
-        inline RGB black() { return RGB("#000000"); }
+        inline constexpr RGB gainsboro() { return detail::hex_rgb("#DCDCDC"); }
+        inline constexpr RGB lightgray() { return detail::hex_rgb("#D3D3D3"); }
+        inline constexpr RGB silver() { return detail::hex_rgb("#C0C0C0"); }
+        inline constexpr RGB darkgray() { return detail::hex_rgb("#A9A9A9"); }
+        inline constexpr RGB gray() { return detail::hex_rgb("#808080"); }
+        inline constexpr RGB dimgray() { return detail::hex_rgb("#696969"); }
+        inline constexpr RGB lightslategray() { return detail::hex_rgb("#778899"); }
+        inline constexpr RGB slategray() { return detail::hex_rgb("#708090"); }
+        inline constexpr RGB darkslategray() { return detail::hex_rgb("#2F4F4F"); }
+        inline constexpr RGB black() { return detail::hex_rgb("#000000"); }
 
     } // namespace colors
 } // namespace pigment
\ No newline at end of file
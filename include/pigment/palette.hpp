@@ -1,14 +1,87 @@
 #pragma once
 
+#include "execution.hpp"
+#include "extract.hpp"
 #include "types_basic.hpp"
 #include "types_hsl.hpp"
+#include "types_oklab.hpp"
 #include <algorithm>
 #include <random>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace pigment {
 
+    // Predefined palette tables, built at compile time
+    namespace palettes {
+        inline constexpr RGB material_design[] = {
+            "#F44336", // Red
+            "#E91E63", // Pink
+            "#9C27B0", // Purple
+            "#673AB7", // Deep Purple
+            "#3F51B5", // Indigo
+            "#2196F3", // Blue
+            "#03A9F4", // Light Blue
+            "#00BCD4", // Cyan
+            "#009688", // Teal
+            "#4CAF50", // Green
+            "#8BC34A", // Light Green
+            "#CDDC39", // Lime
+            "#FFEB3B", // Yellow
+            "#FFC107", // Amber
+            "#FF9800", // Orange
+            "#FF5722"  // Deep Orange
+        };
+
+        inline constexpr RGB warm[] = {
+            "#FF6B6B", // Red
+            "#FFE66D", // Yellow
+            "#FF8E53", // Orange
+            "#FF6F91", // Pink
+            "#C44569"  // Deep Pink
+        };
+
+        inline constexpr RGB cool[] = {
+            "#4ECDC4", // Teal
+            "#45B7D1", // Blue
+            "#96CEB4", // Green
+            "#FFEAA7", // Light Yellow
+            "#DDA0DD"  // Plum
+        };
+    } // namespace palettes
+
+    // Color space gradients interpolate in. RGB mixes the 8-bit channels directly; OKLab is perceptually
+    // even; OKLCH keeps chroma up by going around the hue circle (the shorter way).
+    enum class Interpolation { RGB, OKLab, OKLCH };
+
+    namespace detail {
+        // Gradient endpoint, converted once into the interpolation space
+        struct GradientStop {
+            RGB rgb;
+            OKLAB oklab;
+            OKLCH oklch;
+        };
+
+        inline GradientStop gradient_stop(const RGB &color, Interpolation space) {
+            GradientStop stop{color, {}, {}};
+            if (space == Interpolation::OKLab) {
+                stop.oklab = OKLAB::fromRGB(color);
+            } else if (space == Interpolation::OKLCH) {
+                stop.oklch = OKLCH::fromRGB(color);
+            }
+            return stop;
+        }
+
+        inline RGB interpolate(const GradientStop &from, const GradientStop &to, double ratio, Interpolation space) {
+            switch (space) {
+            case Interpolation::OKLab: return from.oklab.mix(to.oklab, ratio).to_rgb();
+            case Interpolation::OKLCH: return from.oklch.mix(to.oklch, ratio).to_rgb();
+            default: return from.rgb.mix(to.rgb, ratio);
+            }
+        }
+    } // namespace detail
+
     class Palette {
       private:
         std::vector<RGB> colors_;
@@ -17,6 +90,7 @@ namespace pigment {
         Palette() = default;
         Palette(const std::vector<RGB> &colors) : colors_(colors) {}
         Palette(std::initializer_list<RGB> colors) : colors_(colors) {}
+        Palette(std::span<const RGB> colors) : colors_(colors.begin(), colors.end()) {}
 
         // Add colors
         void add(const RGB &color) { colors_.push_back(color); }
@@ -30,6 +104,8 @@ namespace pigment {
 
         size_t size() const { return colors_.size(); }
 
+        std::span<const RGB> colors() const { return colors_; }
+
         bool empty() const { return colors_.empty(); }
 
         void clear() { colors_.clear(); }
@@ -52,74 +128,88 @@ namespace pigment {
         }
 
         // Create gradient between two colors
-        static Palette gradient(const RGB &start, const RGB &end, size_t steps) {
-            std::vector<RGB> colors;
-            colors.reserve(steps);
+        static Palette gradient(const RGB &start, const RGB &end, size_t steps,
+                                Interpolation space = Interpolation::RGB) {
+            return gradient(execution::seq, start, end, steps, space);
+        }
 
-            for (size_t i = 0; i < steps; ++i) {
-                double ratio = static_cast<double>(i) / (steps - 1);
-                colors.push_back(start.mix(end, ratio));
-            }
+        template <execution::ExecutionPolicy Policy>
+        static Palette gradient(const Policy &policy, const RGB &start, const RGB &end, size_t steps,
+                                Interpolation space = Interpolation::RGB) {
+            Palette result;
+            result.colors_.resize(steps);
+            const detail::GradientStop from = detail::gradient_stop(start, space);
+            const detail::GradientStop to = detail::gradient_stop(end, space);
+
+            execution::for_each_chunk(policy, steps, execution::chunk_for<RGB>(), [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    double ratio = steps > 1 ? static_cast<double>(i) / (steps - 1) : 0.0;
+                    result.colors_[i] = detail::interpolate(from, to, ratio, space);
+                }
+            });
 
-            return Palette(colors);
+            return result;
         }
 
         // Create multi-color gradient
-        static Palette gradient(const std::vector<RGB> &colors, size_t steps_per_segment) {
+        static Palette gradient(const std::vector<RGB> &colors, size_t steps_per_segment,
+                                Interpolation space = Interpolation::RGB) {
+            return gradient(execution::seq, colors, steps_per_segment, space);
+        }
+
+        template <execution::ExecutionPolicy Policy>
+        static Palette gradient(const Policy &policy, const std::vector<RGB> &colors, size_t steps_per_segment,
+                                Interpolation space = Interpolation::RGB) {
             if (colors.size() < 2)
                 return Palette();
 
             Palette result;
-            for (size_t i = 0; i < colors.size() - 1; ++i) {
-                auto segment = gradient(colors[i], colors[i + 1], steps_per_segment);
-                result.add(segment.colors_);
+            const size_t steps = steps_per_segment;
+            result.colors_.resize((colors.size() - 1) * steps);
+            std::vector<detail::GradientStop> stops;
+            stops.reserve(colors.size());
+            for (const auto &color : colors) {
+                stops.push_back(detail::gradient_stop(color, space));
             }
 
+            execution::for_each_chunk(policy, result.colors_.size(), execution::chunk_for<RGB>(), [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    size_t segment = i / steps;
+                    double ratio = steps > 1 ? static_cast<double>(i % steps) / (steps - 1) : 0.0;
+                    result.colors_[i] = detail::interpolate(stops[segment], stops[segment + 1], ratio, space);
+                }
+            });
+
             return result;
         }
 
-        // Predefined palettes
-        static Palette material_design() {
-            return Palette({
-                RGB("#F44336"), // Red
-                RGB("#E91E63"), // Pink
-                RGB("#9C27B0"), // Purple
-                RGB("#673AB7"), // Deep Purple
-                RGB("#3F51B5"), // Indigo
-                RGB("#2196F3"), // Blue
-                RGB("#03A9F4"), // Light Blue
-                RGB("#00BCD4"), // Cyan
-                RGB("#009688"), // Teal
-                RGB("#4CAF50"), // Green
-                RGB("#8BC34A"), // Light Green
-                RGB("#CDDC39"), // Lime
-                RGB("#FFEB3B"), // Yellow
-                RGB("#FFC107"), // Amber
-                RGB("#FF9800"), // Orange
-                RGB("#FF5722")  // Deep Orange
-            });
+        // Dominant colors of an image, heaviest first; see extract.hpp for the methods and options
+        static Palette extract(std::span<const RGB> pixels, size_t k,
+                               extract::Method method = extract::Method::KMeans, const extract::Options &options = {}) {
+            return Palette(extract::palette(pixels, k, method, options));
         }
 
-        static Palette warm() {
-            return Palette({
-                RGB("#FF6B6B"), // Red
-                RGB("#FFE66D"), // Yellow
-                RGB("#FF8E53"), // Orange
-                RGB("#FF6F91"), // Pink
-                RGB("#C44569")  // Deep Pink
-            });
+        template <execution::ExecutionPolicy Policy>
+        static Palette extract(const Policy &policy, std::span<const RGB> pixels, size_t k,
+                               extract::Method method = extract::Method::KMeans, const extract::Options &options = {}) {
+            return Palette(extract::palette(policy, pixels, k, method, options));
         }
 
-        static Palette cool() {
-            return Palette({
-                RGB("#4ECDC4"), // Teal
-                RGB("#45B7D1"), // Blue
-                RGB("#96CEB4"), // Green
-                RGB("#FFEAA7"), // Light Yellow
-                RGB("#DDA0DD")  // Plum
-            });
+        static Palette extract(const PixelBuffer &image, size_t k, extract::Method method = extract::Method::KMeans,
+                               const extract::Options &options = {}) {
+            return Palette(extract::palette(image, k, method, options));
         }
 
+        // Predefined palettes. The *_colors() views point at compile-time tables and never allocate;
+        // the Palette-returning versions copy the table for callers that want to own or edit it.
+        static constexpr std::span<const RGB> material_design_colors() { return palettes::material_design; }
+        static constexpr std::span<const RGB> warm_colors() { return palettes::warm; }
+        static constexpr std::span<const RGB> cool_colors() { return palettes::cool; }
+
+        static Palette material_design() { return Palette(material_design_colors()); }
+        static Palette warm() { return Palette(warm_colors()); }
+        static Palette cool() { return Palette(cool_colors()); }
+
         static Palette monochromatic(const RGB &base, size_t count = 5) {
             HSL hsl = HSL::fromRGB(base);
             std::vector<RGB> colors;
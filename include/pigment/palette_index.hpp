@@ -0,0 +1,223 @@
+#pragma once
+
+#include "palette.hpp"
+#include "types_basic.hpp"
+#include "types_lab.hpp"
+#include "types_oklab.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace pigment {
+
+    // Nearest-color search over a fixed palette. Palette colors are converted to LAB once and stored in a
+    // k-d tree, so a query costs one LAB conversion and O(log M) distance evaluations instead of 2 * M
+    // conversions. Distances are CIE76 delta E computed exactly as utils::color_distance does; ties go to
+    // the lowest palette index, so results are identical to utils::find_closest_color.
+    //
+    // Built with Space::OKLab, the tree and the distances use Oklab instead (cheaper to convert into, and
+    // more even across hues). LAB and OKLAB queries are converted into the index's space.
+    class PaletteIndex {
+      public:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        enum class Space { LAB, OKLab };
+
+        PaletteIndex() = default;
+        explicit PaletteIndex(std::span<const RGB> colors, Space space = Space::LAB)
+            : colors_(colors.begin(), colors.end()), space_(space) {
+            build();
+        }
+        explicit PaletteIndex(const std::vector<RGB> &colors, Space space = Space::LAB)
+            : PaletteIndex(std::span<const RGB>(colors), space) {}
+        explicit PaletteIndex(const Palette &palette, Space space = Space::LAB) : PaletteIndex(palette.colors(), space) {}
+
+        size_t size() const { return colors_.size(); }
+        bool empty() const { return colors_.empty(); }
+        Space space() const { return space_; }
+        const RGB &color(size_t index) const { return colors_[index]; }
+        const std::vector<RGB> &colors() const { return colors_; }
+
+        // Index of the closest palette color, or npos for an empty palette
+        size_t nearest(const RGB &target) const { return nearest_point(point(target)); }
+        size_t nearest(const LAB &target) const { return nearest_point(point(target)); }
+        size_t nearest(const OKLAB &target) const { return nearest_point(point(target)); }
+
+        // Closest palette color; the target itself for an empty palette
+        RGB nearest_color(const RGB &target) const {
+            size_t index = nearest(target);
+            return index == npos ? target : colors_[index];
+        }
+
+        // Indices of the k closest palette colors, closest first (ties by lowest index)
+        std::vector<size_t> k_nearest(const RGB &target, size_t k) const { return k_nearest_point(point(target), k); }
+        std::vector<size_t> k_nearest(const LAB &target, size_t k) const { return k_nearest_point(point(target), k); }
+        std::vector<size_t> k_nearest(const OKLAB &target, size_t k) const { return k_nearest_point(point(target), k); }
+
+      private:
+        static constexpr uint32_t npos_index = std::numeric_limits<uint32_t>::max();
+
+        // Coordinates in the index's space: (L, a, b) of LAB or Oklab
+        using Point = std::array<double, 3>;
+
+        Point point(const RGB &color) const {
+            Point p;
+            if (space_ == Space::OKLab) {
+                OKLAB::from_channels(color.r, color.g, color.b, p[0], p[1], p[2]);
+            } else {
+                LAB::from_channels(color.r, color.g, color.b, p[0], p[1], p[2]);
+            }
+            return p;
+        }
+
+        Point point(const LAB &lab) const {
+            if (space_ == Space::OKLab) {
+                OKLAB ok = OKLAB::fromLAB(lab);
+                return {ok.l, ok.a, ok.b};
+            }
+            return {lab.l, lab.a, lab.b};
+        }
+
+        Point point(const OKLAB &ok) const {
+            if (space_ == Space::LAB) {
+                double r, g, b;
+                OKLAB::to_linear(ok.l, ok.a, ok.b, r, g, b);
+                Point p;
+                LAB::from_linear(r, g, b, p[0], p[1], p[2]);
+                return p;
+            }
+            return {ok.l, ok.a, ok.b};
+        }
+
+        size_t nearest_point(const Point &target) const {
+            Closest best;
+            search(0, nodes_.size(), target, best);
+            return best.found.index == npos_index ? npos : best.found.index;
+        }
+
+        std::vector<size_t> k_nearest_point(const Point &target, size_t k) const {
+            KClosest best(std::min(k, size()));
+            if (best.k > 0) {
+                search(0, nodes_.size(), target, best);
+            }
+            std::sort_heap(best.heap.begin(), best.heap.end());
+            std::vector<size_t> out;
+            out.reserve(best.heap.size());
+            for (const auto &c : best.heap) {
+                out.push_back(c.index);
+            }
+            return out;
+        }
+
+        struct Node {
+            Point p;
+            uint32_t index; // position in colors_
+            int axis;       // splitting axis: 0 = L, 1 = a, 2 = b
+        };
+
+        struct Candidate {
+            double distance = std::numeric_limits<double>::infinity();
+            uint32_t index = npos_index;
+
+            bool operator<(const Candidate &other) const {
+                return distance < other.distance || (distance == other.distance && index < other.index);
+            }
+        };
+
+        // Search states: offer() records a candidate, radius() bounds the distances still worth visiting
+        struct Closest {
+            Candidate found;
+            void offer(const Candidate &c) { found = std::min(found, c); }
+            double radius() const { return found.distance; }
+        };
+
+        struct KClosest {
+            size_t k;
+            std::vector<Candidate> heap; // max-heap: the front is the worst candidate kept
+
+            explicit KClosest(size_t k_) : k(k_) { heap.reserve(k); }
+
+            void offer(const Candidate &c) {
+                if (heap.size() < k) {
+                    heap.push_back(c);
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (c < heap.front()) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = c;
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+
+            double radius() const {
+                return heap.size() < k ? std::numeric_limits<double>::infinity() : heap.front().distance;
+            }
+        };
+
+        std::vector<RGB> colors_;
+        Space space_ = Space::LAB;
+        std::vector<Node> nodes_; // implicit tree: the node for range [lo, hi) sits at its midpoint
+
+        // Euclidean distance, evaluated exactly as LAB::delta_e does
+        static double distance(const Point &x, const Point &y) {
+            double dl = x[0] - y[0];
+            double da = x[1] - y[1];
+            double db = x[2] - y[2];
+            return std::sqrt(dl*dl + da*da + db*db);
+        }
+
+        void build() {
+            nodes_.reserve(colors_.size());
+            for (size_t i = 0; i < colors_.size(); ++i) {
+                nodes_.push_back({point(colors_[i]), static_cast<uint32_t>(i), 0});
+            }
+            split(0, nodes_.size());
+        }
+
+        // Median split along the axis with the largest spread
+        void split(size_t lo, size_t hi) {
+            if (hi - lo <= 1) {
+                return;
+            }
+            int axis = 0;
+            double widest = -1.0;
+            for (int c = 0; c < 3; ++c) {
+                auto [mn, mx] = std::minmax_element(nodes_.begin() + lo, nodes_.begin() + hi,
+                    [c](const Node &x, const Node &y) { return x.p[c] < y.p[c]; });
+                double spread = mx->p[c] - mn->p[c];
+                if (spread > widest) {
+                    widest = spread;
+                    axis = c;
+                }
+            }
+            size_t mid = lo + (hi - lo) / 2;
+            std::nth_element(nodes_.begin() + lo, nodes_.begin() + mid, nodes_.begin() + hi,
+                [axis](const Node &x, const Node &y) { return x.p[axis] < y.p[axis]; });
+            nodes_[mid].axis = axis;
+            split(lo, mid);
+            split(mid + 1, hi);
+        }
+
+        // Standard k-d descent: nearer side first, then the far side unless the splitting plane is beyond the
+        // current radius. The check keeps a small margin because the rounded delta E can come out a hair below
+        // the exact distance to the plane, and it keeps equal distances so the lowest index wins ties.
+        template <typename Best> void search(size_t lo, size_t hi, const Point &target, Best &best) const {
+            if (lo >= hi) {
+                return;
+            }
+            size_t mid = lo + (hi - lo) / 2;
+            const Node &node = nodes_[mid];
+            best.offer({distance(target, node.p), node.index});
+            double diff = target[node.axis] - node.p[node.axis];
+            bool left_first = diff < 0;
+            search(left_first ? lo : mid + 1, left_first ? mid : hi, target, best);
+            if (std::abs(diff) <= best.radius() * (1.0 + 1e-12)) {
+                search(left_first ? mid + 1 : lo, left_first ? hi : mid, target, best);
+            }
+        }
+    };
+
+} // namespace pigment
@@ -4,5 +4,21 @@
 #include "types_hsv.hpp"
 #include "types_hsl.hpp"
 #include "types_lab.hpp"
+#include "types_oklab.hpp"
+#include "transfer.hpp"
+#include "hex.hpp"
 #include "palette.hpp"
+#include "palette_index.hpp"
+#include "quantizer.hpp"
+#include "dither.hpp"
+#include "distance.hpp"
+#include "extract.hpp"
+#include "sort.hpp"
+#include "pipeline.hpp"
+#include "composite.hpp"
+#include "blend.hpp"
+#include "lut3d.hpp"
 #include "utils.hpp"
+#include "pixel_buffer.hpp"
+#include "simd.hpp"
+#include "lab_lut.hpp"
@@ -0,0 +1,363 @@
+#pragma once
+
+#include "execution.hpp"
+#include "pixel_buffer.hpp"
+#include "types_basic.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pigment {
+
+    // A chain of RGB adjustments compiled into a single pass over the pixels. Steps are recorded with the
+    // same names and defaults as the RGB methods:
+    //
+    //   Pipeline p;
+    //   p.brighten(0.1).warm(0.2).adjust_contrast(0.3).to_grayscale();
+    //   p.apply(execution::par, image);
+    //
+    // Every step except to_grayscale works on each channel separately, so the steps before the first
+    // grayscale collapse into a 256-entry table per channel, and grayscale becomes a 3x3 matrix stage.
+    //
+    // Rounding::PerStep (the default) gives exactly the result of calling the RGB methods one after another,
+    // truncation and clamping included. Rounding::Final keeps values in double between steps (still clamping
+    // to 0-255 wherever the RGB method clamps) and rounds once at the end; consecutive steps without a clamp
+    // between them fold into one affine matrix. Bulk and single-color results are identical in both modes.
+    class Pipeline {
+      public:
+        enum class Rounding { PerStep, Final };
+
+        explicit Pipeline(Rounding rounding = Rounding::PerStep) : rounding_(rounding) { compile(); }
+
+        Rounding rounding() const { return rounding_; }
+        size_t size() const { return steps_.size(); }
+        bool empty() const { return steps_.empty(); }
+
+        Pipeline &brighten(double factor = 0.2) { return add(Op::Brighten, factor); }
+        Pipeline &darken(double factor = 0.2) { return add(Op::Darken, factor); }
+        Pipeline &warm(double factor = 0.1) { return add(Op::Warm, factor); }
+        Pipeline &cool(double factor = 0.1) { return add(Op::Cool, factor); }
+        Pipeline &adjust_contrast(double contrast) { return add(Op::Contrast, contrast); }
+        Pipeline &invert() { return add(Op::Invert); }
+        Pipeline &to_grayscale() { return add(Op::Grayscale); }
+        Pipeline &mix(const RGB &other, double ratio = 0.5) { return add(Op::Mix, ratio, other); }
+
+        RGB apply(const RGB &color) const {
+            const uint8_t r = channel(color.r), g = channel(color.g), b = channel(color.b);
+            RGB out;
+            out.a = alpha_[channel(color.a)];
+            if (rounding_ == Rounding::PerStep) {
+                if (gray_) {
+                    const uint8_t y = gray(r, g, b);
+                    out.r = post_[0][y];
+                    out.g = post_[1][y];
+                    out.b = post_[2][y];
+                } else {
+                    out.r = pre_[0][r];
+                    out.g = pre_[1][g];
+                    out.b = pre_[2][b];
+                }
+            } else {
+                double c[3] = {prefix_[0][r], prefix_[1][g], prefix_[2][b]};
+                for (const Affine &stage : stages_) {
+                    stage.apply(c[0], c[1], c[2]);
+                }
+                out.r = store(c[0]);
+                out.g = store(c[1]);
+                out.b = store(c[2]);
+            }
+            return out;
+        }
+
+        RGB operator()(const RGB &color) const { return apply(color); }
+
+        // Whole image; `out` may be `in`
+        template <execution::ExecutionPolicy Policy>
+        void apply(const Policy &policy, const PixelBuffer &in, PixelBuffer &out) const {
+            if (&out != &in && (out.width() != in.width() || out.height() != in.height())) {
+                out = PixelBuffer(in.width(), in.height());
+            }
+            const uint8_t *r = in.plane(PixelBuffer::R);
+            const uint8_t *g = in.plane(PixelBuffer::G);
+            const uint8_t *b = in.plane(PixelBuffer::B);
+            const uint8_t *a = in.plane(PixelBuffer::A);
+            uint8_t *r_out = out.plane(PixelBuffer::R);
+            uint8_t *g_out = out.plane(PixelBuffer::G);
+            uint8_t *b_out = out.plane(PixelBuffer::B);
+            uint8_t *a_out = out.plane(PixelBuffer::A);
+            execution::for_each_chunk(policy, in.size(), execution::chunk_for<RGBA8>(), [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    a_out[i] = alpha_[a[i]];
+                }
+                if (rounding_ == Rounding::PerStep && gray_) {
+                    for (size_t i = lo; i < hi; ++i) {
+                        const uint8_t y = gray(r[i], g[i], b[i]);
+                        r_out[i] = post_[0][y];
+                        g_out[i] = post_[1][y];
+                        b_out[i] = post_[2][y];
+                    }
+                } else if (rounding_ == Rounding::PerStep || stages_.empty()) {
+                    for (size_t i = lo; i < hi; ++i) {
+                        r_out[i] = pre_[0][r[i]];
+                        g_out[i] = pre_[1][g[i]];
+                        b_out[i] = pre_[2][b[i]];
+                    }
+                } else {
+                    apply_stages(r + lo, g + lo, b + lo, r_out + lo, g_out + lo, b_out + lo, hi - lo);
+                }
+            });
+        }
+
+        void apply(const PixelBuffer &in, PixelBuffer &out) const { apply(execution::seq, in, out); }
+
+        template <execution::ExecutionPolicy Policy> void apply(const Policy &policy, PixelBuffer &image) const {
+            apply(policy, image, image);
+        }
+
+        void apply(PixelBuffer &image) const { apply(execution::seq, image); }
+
+        // In place over interleaved colors
+        template <execution::ExecutionPolicy Policy> void apply(const Policy &policy, std::span<RGB> colors) const {
+            execution::for_each_chunk(policy, colors.size(), execution::chunk_for<RGB>(), [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    colors[i] = apply(colors[i]);
+                }
+            });
+        }
+
+        void apply(std::span<RGB> colors) const { apply(execution::seq, colors); }
+
+      private:
+        enum class Op { Brighten, Darken, Warm, Cool, Contrast, Invert, Grayscale, Mix };
+
+        struct Step {
+            Op op;
+            double amount = 0.0;
+            RGB color;
+        };
+
+        // out = m * (r, g, b) + offset, then clamped to 0-255 if `clamp`
+        struct Affine {
+            std::array<double, 9> m = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+            std::array<double, 3> offset = {0, 0, 0};
+            bool clamp = false;
+
+            void apply(double &r, double &g, double &b) const {
+                const double x = m[0] * r + m[1] * g + m[2] * b + offset[0];
+                const double y = m[3] * r + m[4] * g + m[5] * b + offset[1];
+                const double z = m[6] * r + m[7] * g + m[8] * b + offset[2];
+                r = clamp ? std::clamp(x, 0.0, 255.0) : x;
+                g = clamp ? std::clamp(y, 0.0, 255.0) : y;
+                b = clamp ? std::clamp(z, 0.0, 255.0) : z;
+            }
+
+            // This stage followed by `next`
+            Affine then(const Affine &next) const {
+                Affine out;
+                for (int i = 0; i < 3; ++i) {
+                    for (int j = 0; j < 3; ++j) {
+                        out.m[i * 3 + j] = next.m[i * 3] * m[j] + next.m[i * 3 + 1] * m[3 + j] +
+                                           next.m[i * 3 + 2] * m[6 + j];
+                    }
+                    out.offset[i] = next.m[i * 3] * offset[0] + next.m[i * 3 + 1] * offset[1] +
+                                    next.m[i * 3 + 2] * offset[2] + next.offset[i];
+                }
+                out.clamp = next.clamp;
+                return out;
+            }
+        };
+
+        using Table = std::array<uint8_t, 256>;
+
+        Rounding rounding_;
+        std::vector<Step> steps_;
+        // Alpha is only changed by mix and never depends on the color channels
+        Table alpha_;
+        // PerStep: steps before the first grayscale (or all steps) per channel; gray_ marks a grayscale
+        // stage, after which post_ maps the gray value through the remaining steps
+        std::array<Table, 3> pre_;
+        std::array<Table, 3> post_;
+        std::array<std::array<uint32_t, 256>, 3> luma_;
+        bool gray_ = false;
+        // Final: steps before the first grayscale per channel in double, then the folded stages after it.
+        // Without stages, pre_ holds the rounded prefix.
+        std::array<std::array<double, 256>, 3> prefix_;
+        std::vector<Affine> stages_;
+
+        static uint8_t channel(int v) { return static_cast<uint8_t>(std::clamp(v, 0, 255)); }
+
+        static uint8_t store(double v) { return static_cast<uint8_t>(std::clamp(std::round(v), 0.0, 255.0)); }
+
+        // RGB::to_grayscale (RGB::luma) of the prefix output, with the weights folded into the tables
+        uint8_t gray(uint8_t r, uint8_t g, uint8_t b) const {
+            return static_cast<uint8_t>((luma_[0][r] + luma_[1][g] + luma_[2][b] + 32768) >> 16);
+        }
+
+        Pipeline &add(Op op, double amount = 0.0, const RGB &color = RGB()) {
+            steps_.push_back({op, amount, color});
+            compile();
+            return *this;
+        }
+
+        static RGB run(const RGB &color, const Step &step) {
+            switch (step.op) {
+            case Op::Brighten: return color.brighten(step.amount);
+            case Op::Darken: return color.darken(step.amount);
+            case Op::Warm: return color.warm(step.amount);
+            case Op::Cool: return color.cool(step.amount);
+            case Op::Contrast: return color.adjust_contrast(step.amount);
+            case Op::Invert: return color.invert();
+            case Op::Grayscale: return color.to_grayscale();
+            case Op::Mix: return color.mix(step.color, step.amount);
+            }
+            return color;
+        }
+
+        // The step as an affine map on unrounded channels, clamped where the RGB method clamps
+        static Affine affine(const Step &step) {
+            Affine s;
+            switch (step.op) {
+            case Op::Brighten:
+            case Op::Darken: {
+                const double k = step.op == Op::Brighten ? 1.0 + step.amount : 1.0 - step.amount;
+                s.m = {k, 0, 0, 0, k, 0, 0, 0, k};
+                s.clamp = true;
+                break;
+            }
+            case Op::Warm:
+            case Op::Cool: {
+                const double f = 255.0 * std::clamp(step.amount, 0.0, 1.0);
+                s.offset = step.op == Op::Warm ? std::array<double, 3>{f * 0.3, f * 0.1, 0.0}
+                                               : std::array<double, 3>{0.0, f * 0.1, f * 0.3};
+                s.clamp = true;
+                break;
+            }
+            case Op::Contrast: {
+                const double c = std::clamp(step.amount, -1.0, 1.0);
+                const double k = (259.0 * (c * 255.0 + 255.0)) / (255.0 * (259.0 - c * 255.0));
+                s.m = {k, 0, 0, 0, k, 0, 0, 0, k};
+                s.offset = {128.0 * (1.0 - k), 128.0 * (1.0 - k), 128.0 * (1.0 - k)};
+                s.clamp = true;
+                break;
+            }
+            case Op::Invert:
+                s.m = {-1, 0, 0, 0, -1, 0, 0, 0, -1};
+                s.offset = {255.0, 255.0, 255.0};
+                break;
+            case Op::Grayscale:
+                s.m = {0.299, 0.587, 0.114, 0.299, 0.587, 0.114, 0.299, 0.587, 0.114};
+                break;
+            case Op::Mix: {
+                const double t = std::clamp(step.amount, 0.0, 1.0);
+                s.m = {1 - t, 0, 0, 0, 1 - t, 0, 0, 0, 1 - t};
+                s.offset = {step.color.r * t, step.color.g * t, step.color.b * t};
+                break;
+            }
+            }
+            return s;
+        }
+
+        void compile() {
+            const auto split = std::find_if(steps_.begin(), steps_.end(),
+                                            [](const Step &s) { return s.op == Op::Grayscale; });
+            gray_ = split != steps_.end();
+
+            for (int v = 0; v < 256; ++v) {
+                // Every step before the split is per channel, so one gray input gives all three tables
+                RGB c(v, v, v, v);
+                for (auto it = steps_.begin(); it != split; ++it) {
+                    c = run(c, *it);
+                }
+                pre_[0][v] = channel(c.r);
+                pre_[1][v] = channel(c.g);
+                pre_[2][v] = channel(c.b);
+                alpha_[v] = channel(c.a);
+                luma_[0][v] = 19595u * pre_[0][v];
+                luma_[1][v] = 38470u * pre_[1][v];
+                luma_[2][v] = 7471u * pre_[2][v];
+
+                if (gray_) {
+                    // v is already the grayscale's output
+                    RGB y(v, v, v, v);
+                    for (auto it = split + 1; it != steps_.end(); ++it) {
+                        y = run(y, *it);
+                    }
+                    post_[0][v] = channel(y.r);
+                    post_[1][v] = channel(y.g);
+                    post_[2][v] = channel(y.b);
+                    // Alpha runs through the whole chain: the prefix, then the remaining steps
+                    RGB whole = c;
+                    for (auto it = split; it != steps_.end(); ++it) {
+                        whole = run(whole, *it);
+                    }
+                    alpha_[v] = channel(whole.a);
+                }
+            }
+
+            stages_.clear();
+            if (rounding_ == Rounding::PerStep) {
+                return;
+            }
+            for (int v = 0; v < 256; ++v) {
+                double r = v, g = v, b = v;
+                for (auto it = steps_.begin(); it != split; ++it) {
+                    affine(*it).apply(r, g, b);
+                }
+                prefix_[0][v] = r;
+                prefix_[1][v] = g;
+                prefix_[2][v] = b;
+                pre_[0][v] = store(r);
+                pre_[1][v] = store(g);
+                pre_[2][v] = store(b);
+            }
+            for (auto it = split; it != steps_.end(); ++it) {
+                const Affine s = affine(*it);
+                if (!stages_.empty() && !stages_.back().clamp) {
+                    stages_.back() = stages_.back().then(s);
+                } else {
+                    stages_.push_back(s);
+                }
+            }
+            // Final-mode alpha: mix in double, rounded once
+            for (int v = 0; v < 256; ++v) {
+                double a = v;
+                for (const Step &step : steps_) {
+                    if (step.op == Op::Mix) {
+                        const double t = std::clamp(step.amount, 0.0, 1.0);
+                        a = a * (1 - t) + step.color.a * t;
+                    }
+                }
+                alpha_[v] = store(a);
+            }
+        }
+
+        // Final mode past a grayscale: blocks small enough to stay in L1, each stage a vectorizable loop
+        void apply_stages(const uint8_t *r, const uint8_t *g, const uint8_t *b, uint8_t *r_out, uint8_t *g_out,
+                          uint8_t *b_out, size_t n) const {
+            constexpr size_t block = 256;
+            double x[block], y[block], z[block];
+            for (size_t start = 0; start < n; start += block) {
+                const size_t count = std::min(block, n - start);
+                for (size_t i = 0; i < count; ++i) {
+                    x[i] = prefix_[0][r[start + i]];
+                    y[i] = prefix_[1][g[start + i]];
+                    z[i] = prefix_[2][b[start + i]];
+                }
+                for (const Affine &stage : stages_) {
+                    for (size_t i = 0; i < count; ++i) {
+                        stage.apply(x[i], y[i], z[i]);
+                    }
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    r_out[start + i] = store(x[i]);
+                    g_out[start + i] = store(y[i]);
+                    b_out[start + i] = store(z[i]);
+                }
+            }
+        }
+    };
+
+} // namespace pigment
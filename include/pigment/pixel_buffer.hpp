@@ -0,0 +1,213 @@
+#pragma once
+
+#include "execution.hpp"
+#include "types_basic.hpp"
+#include "types_hsl.hpp"
+#include "types_hsv.hpp"
+#include "types_lab.hpp"
+#include "types_oklab.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace pigment {
+
+    // Structure-of-arrays image storage: every channel is a contiguous plane of width * height values,
+    // stored one after another in a single allocation. Loops over a plane touch only that channel's
+    // bytes and have unit stride, which is what the auto-vectorizer needs.
+    template <typename T, size_t Channels> class PlanarBuffer {
+      protected:
+        size_t width_ = 0;
+        size_t height_ = 0;
+        std::vector<T> data_;
+
+      public:
+        static constexpr size_t channels = Channels;
+
+        PlanarBuffer() = default;
+        PlanarBuffer(size_t width, size_t height, T fill = T{})
+            : width_(width), height_(height), data_(Channels * width * height, fill) {}
+
+        void resize(size_t width, size_t height) {
+            width_ = width;
+            height_ = height;
+            data_.resize(Channels * width * height);
+        }
+
+        size_t width() const { return width_; }
+        size_t height() const { return height_; }
+        size_t size() const { return width_ * height_; }
+        bool empty() const { return size() == 0; }
+
+        // Channel planes
+        T *plane(size_t channel) { return data_.data() + channel * size(); }
+        const T *plane(size_t channel) const { return data_.data() + channel * size(); }
+
+        std::span<T> channel(size_t channel) { return {plane(channel), size()}; }
+        std::span<const T> channel(size_t channel) const { return {plane(channel), size()}; }
+
+        // Start of row `y` inside a channel plane
+        T *row(size_t channel, size_t y) { return plane(channel) + y * width_; }
+        const T *row(size_t channel, size_t y) const { return plane(channel) + y * width_; }
+    };
+
+    // 8-bit RGBA image with planes in R, G, B, A order
+    class PixelBuffer : public PlanarBuffer<uint8_t, 4> {
+      public:
+        enum Channel { R = 0, G = 1, B = 2, A = 3 };
+
+        PixelBuffer() = default;
+        PixelBuffer(size_t width, size_t height) : PlanarBuffer(width, height) {
+            std::fill(plane(A), plane(A) + size(), uint8_t(255));
+        }
+
+        // Build from interleaved pixels (RGB or RGBA8), row-major
+        template <typename Color> static PixelBuffer from_pixels(std::span<const Color> pixels, size_t width, size_t height) {
+            if (pixels.size() != width * height) {
+                throw std::invalid_argument("PixelBuffer: pixel count does not match width * height");
+            }
+            PixelBuffer buffer(width, height);
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                buffer.set(i, RGBA8(static_cast<RGB>(pixels[i])));
+            }
+            return buffer;
+        }
+
+        static PixelBuffer from_pixels(const std::vector<RGB> &pixels, size_t width, size_t height) {
+            return from_pixels(std::span<const RGB>(pixels), width, height);
+        }
+
+        static PixelBuffer from_pixels(const std::vector<RGBA8> &pixels, size_t width, size_t height) {
+            return from_pixels(std::span<const RGBA8>(pixels), width, height);
+        }
+
+        // Pixel access by linear index
+        RGBA8 get(size_t i) const { return RGBA8(plane(R)[i], plane(G)[i], plane(B)[i], plane(A)[i]); }
+
+        void set(size_t i, const RGBA8 &c) {
+            plane(R)[i] = c.r;
+            plane(G)[i] = c.g;
+            plane(B)[i] = c.b;
+            plane(A)[i] = c.a;
+        }
+
+        RGBA8 at(size_t x, size_t y) const { return get(y * width_ + x); }
+
+        // Back to interleaved pixels
+        std::vector<RGBA8> to_rgba8() const {
+            std::vector<RGBA8> out(size());
+            for (size_t i = 0; i < out.size(); ++i) {
+                out[i] = get(i);
+            }
+            return out;
+        }
+
+        std::vector<RGB> to_rgb() const {
+            std::vector<RGB> out(size());
+            for (size_t i = 0; i < out.size(); ++i) {
+                out[i] = get(i);
+            }
+            return out;
+        }
+    };
+
+    // Planar color-space images; planes are (L, a, b), (H, S, L), (H, S, V), Oklab (L, a, b) and
+    // Oklch (L, C, h) respectively
+    using LABBuffer = PlanarBuffer<double, 3>;
+    using HSLBuffer = PlanarBuffer<double, 3>;
+    using HSVBuffer = PlanarBuffer<float, 3>;
+    using OKLABBuffer = PlanarBuffer<double, 3>;
+    using OKLCHBuffer = PlanarBuffer<double, 3>;
+
+    // Whole-image conversions between a PixelBuffer and planar color-space buffers. Each one runs the
+    // same per-pixel kernel as the corresponding fromRGB/to_rgb, so the results are identical. The
+    // reverse conversions write the R, G and B planes and leave the alpha plane untouched.
+    namespace bulk {
+
+        namespace detail {
+            // The kernel is a template argument so it inlines into the chunk loop. Pixels are independent,
+            // so any chunking gives the same output.
+            template <auto Kernel, typename Policy, typename T>
+            void forward(const Policy &policy, const PixelBuffer &in, PlanarBuffer<T, 3> &out) {
+                out.resize(in.width(), in.height());
+                const uint8_t *r = in.plane(PixelBuffer::R);
+                const uint8_t *g = in.plane(PixelBuffer::G);
+                const uint8_t *b = in.plane(PixelBuffer::B);
+                T *c0 = out.plane(0);
+                T *c1 = out.plane(1);
+                T *c2 = out.plane(2);
+                execution::for_each_chunk(policy, in.size(), execution::chunk_for<T[3]>(), [&](size_t lo, size_t hi) {
+                    for (size_t i = lo; i < hi; ++i) {
+                        Kernel(r[i], g[i], b[i], c0[i], c1[i], c2[i]);
+                    }
+                });
+            }
+
+            template <auto Kernel, typename Policy, typename T>
+            void reverse(const Policy &policy, const PlanarBuffer<T, 3> &in, PixelBuffer &out) {
+                if (out.width() != in.width() || out.height() != in.height()) {
+                    out = PixelBuffer(in.width(), in.height());
+                }
+                const T *c0 = in.plane(0);
+                const T *c1 = in.plane(1);
+                const T *c2 = in.plane(2);
+                uint8_t *r = out.plane(PixelBuffer::R);
+                uint8_t *g = out.plane(PixelBuffer::G);
+                uint8_t *b = out.plane(PixelBuffer::B);
+                execution::for_each_chunk(policy, in.size(), execution::chunk_for<T[3]>(), [&](size_t lo, size_t hi) {
+                    for (size_t i = lo; i < hi; ++i) {
+                        int ri, gi, bi;
+                        Kernel(c0[i], c1[i], c2[i], ri, gi, bi);
+                        r[i] = static_cast<uint8_t>(std::clamp(ri, 0, 255));
+                        g[i] = static_cast<uint8_t>(std::clamp(gi, 0, 255));
+                        b[i] = static_cast<uint8_t>(std::clamp(bi, 0, 255));
+                    }
+                });
+            }
+        } // namespace detail
+
+        template <execution::ExecutionPolicy Policy>
+        void rgb_to_lab(const Policy &policy, const PixelBuffer &in, LABBuffer &out) { detail::forward<LAB::from_channels>(policy, in, out); }
+        template <execution::ExecutionPolicy Policy>
+        void lab_to_rgb(const Policy &policy, const LABBuffer &in, PixelBuffer &out) { detail::reverse<LAB::to_channels>(policy, in, out); }
+
+        template <execution::ExecutionPolicy Policy>
+        void rgb_to_hsl(const Policy &policy, const PixelBuffer &in, HSLBuffer &out) { detail::forward<HSL::from_channels>(policy, in, out); }
+        template <execution::ExecutionPolicy Policy>
+        void hsl_to_rgb(const Policy &policy, const HSLBuffer &in, PixelBuffer &out) { detail::reverse<HSL::to_channels>(policy, in, out); }
+
+        template <execution::ExecutionPolicy Policy>
+        void rgb_to_hsv(const Policy &policy, const PixelBuffer &in, HSVBuffer &out) { detail::forward<HSV::from_channels>(policy, in, out); }
+        template <execution::ExecutionPolicy Policy>
+        void hsv_to_rgb(const Policy &policy, const HSVBuffer &in, PixelBuffer &out) { detail::reverse<HSV::to_channels>(policy, in, out); }
+
+        template <execution::ExecutionPolicy Policy>
+        void rgb_to_oklab(const Policy &policy, const PixelBuffer &in, OKLABBuffer &out) { detail::forward<OKLAB::from_channels>(policy, in, out); }
+        template <execution::ExecutionPolicy Policy>
+        void oklab_to_rgb(const Policy &policy, const OKLABBuffer &in, PixelBuffer &out) { detail::reverse<OKLAB::to_channels>(policy, in, out); }
+
+        template <execution::ExecutionPolicy Policy>
+        void rgb_to_oklch(const Policy &policy, const PixelBuffer &in, OKLCHBuffer &out) { detail::forward<OKLCH::from_channels>(policy, in, out); }
+        template <execution::ExecutionPolicy Policy>
+        void oklch_to_rgb(const Policy &policy, const OKLCHBuffer &in, PixelBuffer &out) { detail::reverse<OKLCH::to_channels>(policy, in, out); }
+
+        inline void rgb_to_lab(const PixelBuffer &in, LABBuffer &out) { rgb_to_lab(execution::seq, in, out); }
+        inline void lab_to_rgb(const LABBuffer &in, PixelBuffer &out) { lab_to_rgb(execution::seq, in, out); }
+
+        inline void rgb_to_hsl(const PixelBuffer &in, HSLBuffer &out) { rgb_to_hsl(execution::seq, in, out); }
+        inline void hsl_to_rgb(const HSLBuffer &in, PixelBuffer &out) { hsl_to_rgb(execution::seq, in, out); }
+
+        inline void rgb_to_hsv(const PixelBuffer &in, HSVBuffer &out) { rgb_to_hsv(execution::seq, in, out); }
+        inline void hsv_to_rgb(const HSVBuffer &in, PixelBuffer &out) { hsv_to_rgb(execution::seq, in, out); }
+
+        inline void rgb_to_oklab(const PixelBuffer &in, OKLABBuffer &out) { rgb_to_oklab(execution::seq, in, out); }
+        inline void oklab_to_rgb(const OKLABBuffer &in, PixelBuffer &out) { oklab_to_rgb(execution::seq, in, out); }
+
+        inline void rgb_to_oklch(const PixelBuffer &in, OKLCHBuffer &out) { rgb_to_oklch(execution::seq, in, out); }
+        inline void oklch_to_rgb(const OKLCHBuffer &in, PixelBuffer &out) { oklch_to_rgb(execution::seq, in, out); }
+
+    } // namespace bulk
+
+} // namespace pigment
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "palette.hpp"
+#include "palette_index.hpp"
+#include "pixel_buffer.hpp"
+#include "types_basic.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace pigment {
+
+    // Palette quantizer with a memo table for inputs that repeat colors, as real images do. Results are kept
+    // in a direct-mapped table indexed by the top `bits` bits of each channel (2^(3 * bits) slots).
+    //
+    //  - Exact: each slot also stores the full color it was computed for. A different color landing in the
+    //    same slot is searched in full and replaces it, so results always equal PaletteIndex::nearest.
+    //  - Approximate: a slot holds the palette entry closest to the center of its cell and answers every
+    //    color in the cell. Faster, and a 6-bit table is usually indistinguishable, but not exact.
+    //
+    // The table is filled lazily. A Quantizer is not thread-safe; give each thread its own, sharing one
+    // index between them.
+    class Quantizer {
+      public:
+        enum class Mode { Exact, Approximate };
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;    // full searches, including evictions
+            uint64_t evictions = 0; // exact mode: misses that replaced another color in an occupied slot
+
+            uint64_t lookups() const { return hits + misses; }
+            double hit_rate() const { return lookups() == 0 ? 0.0 : static_cast<double>(hits) / lookups(); }
+        };
+
+        explicit Quantizer(std::span<const RGB> palette, int bits = 5, Mode mode = Mode::Exact)
+            : Quantizer(PaletteIndex(palette), bits, mode) {}
+
+        // Reuse an index that is already built
+        explicit Quantizer(PaletteIndex index, int bits = 5, Mode mode = Mode::Exact)
+            : Quantizer(std::make_shared<const PaletteIndex>(std::move(index)), bits, mode) {}
+
+        // Share an index with other Quantizers without copying it
+        explicit Quantizer(std::shared_ptr<const PaletteIndex> index, int bits = 5, Mode mode = Mode::Exact)
+            : index_(std::move(index)), bits_(bits), mode_(mode) {
+            if (!index_) {
+                throw std::invalid_argument("Quantizer: index is null");
+            }
+            if (bits < 1 || bits > 8) {
+                throw std::invalid_argument("Quantizer: bits per channel must be between 1 and 8");
+            }
+            table_.assign(size_t(1) << (3 * bits), Slot{});
+        }
+
+        explicit Quantizer(const std::vector<RGB> &palette, int bits = 5, Mode mode = Mode::Exact)
+            : Quantizer(std::span<const RGB>(palette), bits, mode) {}
+
+        explicit Quantizer(const Palette &palette, int bits = 5, Mode mode = Mode::Exact)
+            : Quantizer(palette.colors(), bits, mode) {}
+
+        int bits() const { return bits_; }
+        Mode mode() const { return mode_; }
+        size_t table_size() const { return table_.size(); }
+        size_t memory_bytes() const { return table_.size() * sizeof(Slot); }
+        const PaletteIndex &index() const { return *index_; }
+        const Stats &stats() const { return stats_; }
+        void reset_stats() { stats_ = Stats{}; }
+
+        // Forget every memoized result
+        void clear() { std::fill(table_.begin(), table_.end(), Slot{}); }
+
+        // Index of the palette color for `color`, or PaletteIndex::npos for an empty palette
+        size_t nearest(const RGB &color) {
+            if (index_->empty()) {
+                return PaletteIndex::npos;
+            }
+            // Out-of-range channels have no slot
+            if ((static_cast<unsigned>(color.r) | static_cast<unsigned>(color.g) | static_cast<unsigned>(color.b)) > 255u) {
+                ++stats_.misses;
+                return index_->nearest(color);
+            }
+            const int drop = 8 - bits_;
+            const size_t key = (size_t(color.r >> drop) << (2 * bits_)) | (size_t(color.g >> drop) << bits_) |
+                               size_t(color.b >> drop);
+            const uint32_t tag = (uint32_t(color.r) << 16) | (uint32_t(color.g) << 8) | uint32_t(color.b);
+            Slot &slot = table_[key];
+            if (slot.tag != empty_tag && (mode_ == Mode::Approximate || slot.tag == tag)) {
+                ++stats_.hits;
+                return slot.index;
+            }
+            ++stats_.misses;
+            if (mode_ == Mode::Exact) {
+                stats_.evictions += slot.tag != empty_tag;
+                slot.tag = tag;
+                slot.index = static_cast<uint32_t>(index_->nearest(color));
+            } else {
+                // Center of the cell, so the result does not depend on which color arrived first
+                const int half = (1 << drop) >> 1;
+                slot.tag = tag;
+                slot.index = static_cast<uint32_t>(index_->nearest(
+                    RGB(((color.r >> drop) << drop) + half, ((color.g >> drop) << drop) + half,
+                        ((color.b >> drop) << drop) + half)));
+            }
+            return slot.index;
+        }
+
+        // Closest palette color; the input itself for an empty palette
+        RGB quantize(const RGB &color) {
+            size_t i = nearest(color);
+            return i == PaletteIndex::npos ? color : index_->color(i);
+        }
+
+        std::vector<RGB> quantize(const std::vector<RGB> &colors) {
+            std::vector<RGB> out;
+            out.reserve(colors.size());
+            for (const auto &color : colors) {
+                out.push_back(quantize(color));
+            }
+            return out;
+        }
+
+        // Quantize an image in place; alpha is kept
+        void quantize(PixelBuffer &image) {
+            uint8_t *r = image.plane(PixelBuffer::R);
+            uint8_t *g = image.plane(PixelBuffer::G);
+            uint8_t *b = image.plane(PixelBuffer::B);
+            for (size_t i = 0; i < image.size(); ++i) {
+                RGB c = quantize(RGB(r[i], g[i], b[i]));
+                r[i] = static_cast<uint8_t>(std::clamp(c.r, 0, 255));
+                g[i] = static_cast<uint8_t>(std::clamp(c.g, 0, 255));
+                b[i] = static_cast<uint8_t>(std::clamp(c.b, 0, 255));
+            }
+        }
+
+      private:
+        static constexpr uint32_t empty_tag = 0xFFFFFFFFu; // real tags use only the low 24 bits
+
+        struct Slot {
+            uint32_t tag = empty_tag;
+            uint32_t index = 0;
+        };
+
+        std::shared_ptr<const PaletteIndex> index_;
+        int bits_;
+        Mode mode_;
+        std::vector<Slot> table_;
+        Stats stats_;
+    };
+
+} // namespace pigment
@@ -0,0 +1,912 @@
+#pragma once
+
+#include "pixel_buffer.hpp"
+#include "types_hsv.hpp"
+#include "types_lab.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// GCC/Clang vector extensions. Without them only the scalar (W == 1) kernels exist and every level runs
+// those; defining PIGMENT_HAS_VECTOR_EXT to 0 forces that build on any compiler.
+#ifndef PIGMENT_HAS_VECTOR_EXT
+#if defined(__GNUC__) || defined(__clang__)
+#define PIGMENT_HAS_VECTOR_EXT 1
+#else
+#define PIGMENT_HAS_VECTOR_EXT 0
+#endif
+#endif
+
+#if PIGMENT_HAS_VECTOR_EXT && (defined(__x86_64__) || defined(__i386__))
+#define PIGMENT_SIMD_X86 1
+#else
+#define PIGMENT_SIMD_X86 0
+#endif
+
+// Kernel helpers are always inlined. PIGMENT_SIMD_CONVERT converts lane by lane between vector types (a
+// plain cast in the scalar kernels).
+#if PIGMENT_HAS_VECTOR_EXT
+#define PIGMENT_SIMD_INLINE __attribute__((always_inline)) inline
+#define PIGMENT_SIMD_CONVERT(x, T) __builtin_convertvector(x, T)
+#else
+#define PIGMENT_SIMD_INLINE inline
+#define PIGMENT_SIMD_CONVERT(x, T) static_cast<T>(x)
+#endif
+
+// Body of a dispatching entry point: returns name_<suffix>(args) for the widest variant usable at `level`.
+// The variants are found from the call site, so headers that build their own kernels on simd.hpp use it too.
+#if PIGMENT_SIMD_X86
+#define PIGMENT_SIMD_SELECT(level, name, ...)                                                                      \
+    switch (::pigment::simd::usable_level(level)) {                                                                \
+    case ::pigment::simd::Level::AVX512:                                                                           \
+        return name##_avx512(__VA_ARGS__);                                                                         \
+    case ::pigment::simd::Level::AVX2:                                                                             \
+        return name##_avx2(__VA_ARGS__);                                                                           \
+    case ::pigment::simd::Level::SSE41:                                                                            \
+        return name##_sse41(__VA_ARGS__);                                                                          \
+    default:                                                                                                       \
+        return name##_scalar(__VA_ARGS__);                                                                         \
+    }
+#else
+#define PIGMENT_SIMD_SELECT(level, name, ...)                                                                      \
+    (void)(level);                                                                                                 \
+    return name##_scalar(__VA_ARGS__);
+#endif
+
+namespace pigment {
+    namespace simd {
+
+        // Instruction set used by the batch kernels, in increasing order of width
+        enum class Level { Scalar, SSE41, AVX2, AVX512 };
+
+        inline const char *level_name(Level level) {
+            switch (level) {
+            case Level::SSE41:
+                return "sse4.1";
+            case Level::AVX2:
+                return "avx2";
+            case Level::AVX512:
+                return "avx512f";
+            default:
+                return "scalar";
+            }
+        }
+
+        // Best level supported by the running CPU (CPUID), detected once
+        inline Level detected_level() {
+            static const Level level = [] {
+#if PIGMENT_SIMD_X86
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f"))
+                    return Level::AVX512;
+                if (__builtin_cpu_supports("avx2"))
+                    return Level::AVX2;
+                if (__builtin_cpu_supports("sse4.1"))
+                    return Level::SSE41;
+#endif
+                return Level::Scalar;
+            }();
+            return level;
+        }
+
+        // Requests above what the CPU supports are lowered to the detected level
+        inline Level usable_level(Level requested) { return requested < detected_level() ? requested : detected_level(); }
+
+        namespace detail {
+
+            // Lane types for a kernel processing W pixels at once; W == 1 is plain scalar code. The kernels
+            // below are written once against these types using GCC/Clang vector extensions, and instantiated
+            // inside target-specific functions so the same source compiles to SSE, AVX2 or AVX-512. Helpers
+            // take vectors by reference only, so no vector crosses a call boundary under the default ABI.
+#if PIGMENT_HAS_VECTOR_EXT
+            template <int W> struct Lanes {
+                typedef float f32 __attribute__((vector_size(W * sizeof(float))));
+                typedef int32_t i32 __attribute__((vector_size(W * sizeof(int32_t))));
+                typedef uint32_t u32 __attribute__((vector_size(W * sizeof(uint32_t))));
+                typedef uint16_t u16 __attribute__((vector_size(W * sizeof(uint16_t))));
+                typedef uint8_t u8 __attribute__((vector_size(W)));
+            };
+#else
+            template <int W> struct Lanes;
+#endif
+
+            template <> struct Lanes<1> {
+                using f32 = float;
+                using i32 = int32_t;
+                using u32 = uint32_t;
+                using u16 = uint16_t;
+                using u8 = uint8_t;
+            };
+
+            // Four channel planes (R, G, B, A) of a PixelBuffer from some pixel on, for the RGBA kernels
+            struct Planes {
+                uint8_t *c[4];
+            };
+
+            struct Source {
+                const uint8_t *c[4];
+            };
+
+            // Planes of `image` starting at pixel `offset`
+            inline Planes planes(PixelBuffer &image, size_t offset = 0) {
+                Planes p;
+                for (size_t k = 0; k < 4; ++k) {
+                    p.c[k] = image.plane(k) + offset;
+                }
+                return p;
+            }
+
+            inline Source planes(const PixelBuffer &image, size_t offset = 0) {
+                Source p;
+                for (size_t k = 0; k < 4; ++k) {
+                    p.c[k] = image.plane(k) + offset;
+                }
+                return p;
+            }
+
+            template <int W> PIGMENT_SIMD_INLINE void load_u8(const uint8_t *p, typename Lanes<W>::f32 &out) {
+                typename Lanes<W>::u8 v;
+                std::memcpy(&v, p, sizeof(v));
+                if constexpr (W == 1) {
+                    out = static_cast<float>(v);
+                } else {
+                    out = PIGMENT_SIMD_CONVERT(v, typename Lanes<W>::f32);
+                }
+            }
+
+            // Truncation toward zero, in place
+            template <int W> PIGMENT_SIMD_INLINE void truncate(typename Lanes<W>::f32 &x) {
+                if constexpr (W == 1) {
+                    x = static_cast<float>(static_cast<int32_t>(x));
+                } else {
+                    x = PIGMENT_SIMD_CONVERT(PIGMENT_SIMD_CONVERT(x, typename Lanes<W>::i32),
+                                             typename Lanes<W>::f32);
+                }
+            }
+
+            // std::round for non-negative inputs, in place: the fraction x - trunc(x) is exact, so ties are
+            // detected exactly
+            template <int W> PIGMENT_SIMD_INLINE void round_nonneg(typename Lanes<W>::f32 &x) {
+                typename Lanes<W>::f32 t = x;
+                truncate<W>(t);
+                x = x - t >= 0.5f ? t + 1.0f : t;
+            }
+
+            // Clamp to [0, 255] and narrow to bytes
+            template <int W> PIGMENT_SIMD_INLINE void store_u8(uint8_t *p, const typename Lanes<W>::f32 &value) {
+                const typename Lanes<W>::f32 zero{};
+                typename Lanes<W>::f32 x = value < 0.0f ? zero : value;
+                x = x > 255.0f ? zero + 255.0f : x;
+                typename Lanes<W>::u8 v;
+                if constexpr (W == 1) {
+                    v = static_cast<uint8_t>(static_cast<int32_t>(x));
+                } else {
+                    v = PIGMENT_SIMD_CONVERT(PIGMENT_SIMD_CONVERT(x, typename Lanes<W>::i32),
+                                             typename Lanes<W>::u8);
+                }
+                std::memcpy(p, &v, sizeof(v));
+            }
+
+            // Mirrors HSV::from_channels operation for operation
+            template <int W>
+            PIGMENT_SIMD_INLINE void rgb_to_hsv_block(const uint8_t *r, const uint8_t *g, const uint8_t *b, float *h,
+                                                      float *s, float *v) {
+                using F = typename Lanes<W>::f32;
+                const F zero = F{};
+                const F one = zero + 1.0f;
+
+                F rf, gf, bf;
+                load_u8<W>(r, rf);
+                load_u8<W>(g, gf);
+                load_u8<W>(b, bf);
+                rf /= 255.0f;
+                gf /= 255.0f;
+                bf /= 255.0f;
+
+                F mx = rf < gf ? gf : rf;
+                mx = mx < bf ? bf : mx;
+                F mn = gf < rf ? gf : rf;
+                mn = bf < mn ? bf : mn;
+                F delta = mx - mn;
+                auto achromatic = delta < 1e-6f;
+                F safe_delta = achromatic ? one : delta;
+
+                F h_r = 60.0f * ((gf - bf) / safe_delta);
+                F h_g = 60.0f * (((bf - rf) / safe_delta) + 2.0f);
+                F h_b = 60.0f * (((rf - gf) / safe_delta) + 4.0f);
+                F hue = achromatic ? zero : (mx == rf ? h_r : (mx == gf ? h_g : h_b));
+                hue = hue < 0.0f ? hue + 360.0f : hue;
+                hue = hue >= 360.0f ? hue - 360.0f : hue;
+
+                auto black = mx < 1e-6f;
+                F sat = black ? zero : delta / (black ? one : mx);
+                sat = sat < 0.0f ? zero : sat;
+                sat = 1.0f < sat ? one : sat;
+                F val = mx < 0.0f ? zero : mx;
+                val = 1.0f < val ? one : val;
+
+                std::memcpy(h, &hue, sizeof(F));
+                std::memcpy(s, &sat, sizeof(F));
+                std::memcpy(v, &val, sizeof(F));
+            }
+
+            // Mirrors HSV::to_channels operation for operation
+            template <int W>
+            PIGMENT_SIMD_INLINE void hsv_to_rgb_block(const float *h, const float *s, const float *v, uint8_t *r,
+                                                      uint8_t *g, uint8_t *b) {
+                using F = typename Lanes<W>::f32;
+                const F zero = F{};
+                F hue, sat, val;
+                std::memcpy(&hue, h, sizeof(F));
+                std::memcpy(&sat, s, sizeof(F));
+                std::memcpy(&val, v, sizeof(F));
+
+                F C = val * sat;
+                F sector = hue / 60.0f;
+                F half = sector * 0.5f;
+                truncate<W>(half);
+                F wrapped = sector - 2.0f * half - 1.0f;
+                F X = C * (1.0f - (wrapped < 0.0f ? -wrapped : wrapped));
+                F m = val - C;
+
+                F rp = (hue < 60.0f || hue >= 300.0f) ? C : ((hue < 120.0f || hue >= 240.0f) ? X : zero);
+                F gp = (hue >= 60.0f && hue < 180.0f) ? C : (hue < 240.0f ? X : zero);
+                F bp = hue < 120.0f ? zero : ((hue >= 180.0f && hue < 300.0f) ? C : X);
+
+                F out_r = (rp + m) * 255.0f;
+                F out_g = (gp + m) * 255.0f;
+                F out_b = (bp + m) * 255.0f;
+                round_nonneg<W>(out_r);
+                round_nonneg<W>(out_g);
+                round_nonneg<W>(out_b);
+                store_u8<W>(r, out_r);
+                store_u8<W>(g, out_g);
+                store_u8<W>(b, out_b);
+            }
+
+            // HSL::from_channels in single precision, on channels scaled to [0, 1]
+            template <int W>
+            PIGMENT_SIMD_INLINE void hsl_from_lanes(const typename Lanes<W>::f32 &rf, const typename Lanes<W>::f32 &gf,
+                                                    const typename Lanes<W>::f32 &bf, typename Lanes<W>::f32 &hue,
+                                                    typename Lanes<W>::f32 &sat, typename Lanes<W>::f32 &light) {
+                using F = typename Lanes<W>::f32;
+                const F zero = F{};
+                const F one = zero + 1.0f;
+
+                F mx = rf < gf ? gf : rf;
+                mx = mx < bf ? bf : mx;
+                F mn = gf < rf ? gf : rf;
+                mn = bf < mn ? bf : mn;
+                F delta = mx - mn;
+                auto achromatic = delta == 0.0f;
+                F safe_delta = achromatic ? one : delta;
+
+                light = (mx + mn) / 2.0f;
+                F s_light = delta / (achromatic ? one : 2.0f - mx - mn);
+                F s_dark = delta / (achromatic ? one : mx + mn);
+                sat = achromatic ? zero : (light > 0.5f ? s_light : s_dark);
+
+                F h_r = (gf - bf) / safe_delta + (gf < bf ? zero + 6.0f : zero);
+                F h_g = (bf - rf) / safe_delta + 2.0f;
+                F h_b = (rf - gf) / safe_delta + 4.0f;
+                hue = achromatic ? zero : (mx == rf ? h_r : (mx == gf ? h_g : h_b)) / 6.0f;
+                hue = hue * 360.0f;
+                hue = hue >= 360.0f ? hue - 360.0f : hue;
+
+                sat = sat < 0.0f ? zero : sat;
+                sat = 1.0f < sat ? one : sat;
+                light = light < 0.0f ? zero : light;
+                light = 1.0f < light ? one : light;
+            }
+
+            template <int W>
+            PIGMENT_SIMD_INLINE void rgb_to_hsl_block(const uint8_t *r, const uint8_t *g, const uint8_t *b, float *h,
+                                                      float *s, float *l) {
+                using F = typename Lanes<W>::f32;
+                F rf, gf, bf, hue, sat, light;
+                load_u8<W>(r, rf);
+                load_u8<W>(g, gf);
+                load_u8<W>(b, bf);
+                rf /= 255.0f;
+                gf /= 255.0f;
+                bf /= 255.0f;
+                hsl_from_lanes<W>(rf, gf, bf, hue, sat, light);
+                std::memcpy(h, &hue, sizeof(F));
+                std::memcpy(s, &sat, sizeof(F));
+                std::memcpy(l, &light, sizeof(F));
+            }
+
+            // One channel of HSL::to_channels' hue_to_rgb, in [0, 1], written into `t`
+            template <int W>
+            PIGMENT_SIMD_INLINE void hue_to_channel(const typename Lanes<W>::f32 &p, const typename Lanes<W>::f32 &q,
+                                                    typename Lanes<W>::f32 &t) {
+                t = t < 0.0f ? t + 1.0f : t;
+                t = t > 1.0f ? t - 1.0f : t;
+                typename Lanes<W>::f32 rising = p + (q - p) * 6.0f * t;
+                typename Lanes<W>::f32 falling = p + (q - p) * (2.0f / 3 - t) * 6.0f;
+                t = t < 1.0f / 6 ? rising : (t < 1.0f / 2 ? q : (t < 2.0f / 3 ? falling : p));
+            }
+
+            // HSL::to_channels in single precision, before scaling to bytes. Achromatic colors come out as
+            // `light` in every channel.
+            template <int W>
+            PIGMENT_SIMD_INLINE void hsl_to_lanes(const typename Lanes<W>::f32 &hue, const typename Lanes<W>::f32 &sat,
+                                                  const typename Lanes<W>::f32 &light, typename Lanes<W>::f32 &r,
+                                                  typename Lanes<W>::f32 &g, typename Lanes<W>::f32 &b) {
+                using F = typename Lanes<W>::f32;
+                F q = light < 0.5f ? light * (1.0f + sat) : light + sat - light * sat;
+                F p = 2.0f * light - q;
+                F h_norm = hue / 360.0f;
+                r = h_norm + 1.0f / 3;
+                g = h_norm;
+                b = h_norm - 1.0f / 3;
+                hue_to_channel<W>(p, q, r);
+                hue_to_channel<W>(p, q, g);
+                hue_to_channel<W>(p, q, b);
+            }
+
+            template <int W>
+            PIGMENT_SIMD_INLINE void hsl_to_rgb_block(const float *h, const float *s, const float *l, uint8_t *r,
+                                                      uint8_t *g, uint8_t *b) {
+                using F = typename Lanes<W>::f32;
+                F hue, sat, light;
+                std::memcpy(&hue, h, sizeof(F));
+                std::memcpy(&sat, s, sizeof(F));
+                std::memcpy(&light, l, sizeof(F));
+
+                F gray = light * 255.0f;
+                truncate<W>(gray);
+                auto achromatic = sat == 0.0f;
+
+                F out_r, out_g, out_b;
+                hsl_to_lanes<W>(hue, sat, light, out_r, out_g, out_b);
+                out_r = out_r * 255.0f;
+                out_g = out_g * 255.0f;
+                out_b = out_b * 255.0f;
+                round_nonneg<W>(out_r);
+                round_nonneg<W>(out_g);
+                round_nonneg<W>(out_b);
+                store_u8<W>(r, achromatic ? gray : out_r);
+                store_u8<W>(g, achromatic ? gray : out_g);
+                store_u8<W>(b, achromatic ? gray : out_b);
+            }
+
+            // Double-precision lanes for the color-difference kernels, D = W / 2
+#if PIGMENT_HAS_VECTOR_EXT
+            template <int D> struct Lanes64 {
+                typedef double f64 __attribute__((vector_size(D * sizeof(double))));
+                typedef int64_t i64 __attribute__((vector_size(D * sizeof(int64_t))));
+            };
+#else
+            template <int D> struct Lanes64;
+#endif
+
+            template <> struct Lanes64<1> {
+                using f64 = double;
+                using i64 = int64_t;
+            };
+
+            // Per-lane sqrt; there is no generic vector sqrt, and the lanes compile to sqrtsd/sqrtpd as available
+            template <int D> PIGMENT_SIMD_INLINE void sqrt_f64(typename Lanes64<D>::f64 &x) {
+                if constexpr (D == 1) {
+                    x = std::sqrt(x);
+                } else {
+                    for (int i = 0; i < D; ++i) {
+                        x[i] = std::sqrt(x[i]);
+                    }
+                }
+            }
+
+            // floor for |x| < 2^51, in place: adding 1.5 * 2^52 rounds to an integer
+            template <int D> PIGMENT_SIMD_INLINE void floor_f64(typename Lanes64<D>::f64 &x) {
+                typename Lanes64<D>::f64 t = (x + 0x1.8p52) - 0x1.8p52;
+                x = t > x ? t - 1.0 : t;
+            }
+
+            // The vector math below follows Cephes (atan, sin/cos, exp) and is accurate to a few ulp over the
+            // ranges the CIEDE2000 kernel uses.
+
+            // atan2 in degrees, in [0, 360)
+            template <int D>
+            PIGMENT_SIMD_INLINE void hue_degrees(const typename Lanes64<D>::f64 &y, const typename Lanes64<D>::f64 &x,
+                                                 typename Lanes64<D>::f64 &out) {
+                using F = typename Lanes64<D>::f64;
+                const F zero = F{};
+                F ax = x < 0.0 ? -x : x;
+                F ay = y < 0.0 ? -y : y;
+                F hi = ax < ay ? ay : ax;
+                F lo = ax < ay ? ax : ay;
+                F r = hi == 0.0 ? zero : lo / (hi == 0.0 ? zero + 1.0 : hi);
+                // atan on [0, 1]; above 0.66 use atan(r) = pi/4 + atan((r - 1) / (r + 1))
+                auto upper = r > 0.66;
+                F z = upper ? (r - 1.0) / (r + 1.0) : r;
+                F zz = z * z;
+                F p = (((-8.750608600031904122785e-1 * zz - 1.615753718733365076637e1) * zz - 7.500855792314704667340e1) *
+                           zz - 1.228866684490136173410e2) * zz - 6.485021904942025371773e1;
+                F q = ((((zz + 2.485846490142306297962e1) * zz + 1.650270098316988542046e2) * zz +
+                        4.328810604912902668951e2) * zz + 4.853903996359136964868e2) * zz + 1.945506571482613964425e2;
+                F t = z + z * zz * p / q;
+                t = upper ? t + (0.78539816339744830962 + 0.5 * 6.123233995736765886130e-17) : t;
+                t = ay > ax ? 1.57079632679489661923 - t : t;
+                t = x < 0.0 ? 3.14159265358979323846 - t : t;
+                t = y < 0.0 ? -t : t;
+                t = t * (180.0 / 3.14159265358979323846);
+                out = t < 0.0 ? t + 360.0 : t;
+            }
+
+            // sin and cos for x >= 0 (radians, up to a few turns)
+            template <int D>
+            PIGMENT_SIMD_INLINE void sincos_f64(const typename Lanes64<D>::f64 &x, typename Lanes64<D>::f64 &s,
+                                                typename Lanes64<D>::f64 &c) {
+                using F = typename Lanes64<D>::f64;
+                // Reduce by multiples of pi/4 to z in [-pi/4, pi/4], quadrant = octant / 2 mod 4
+                F j = x * (4.0 / 3.14159265358979323846);
+                floor_f64<D>(j);
+                F half = j * 0.5;
+                floor_f64<D>(half);
+                j = j + (j - 2.0 * half);
+                F z = ((x - j * 7.85398125648498535156e-1) - j * 3.77489470793079817668e-8) - j * 2.69515142907905952645e-15;
+                F quadrant = j * 0.5;
+                F turns = quadrant * 0.25;
+                floor_f64<D>(turns);
+                quadrant = quadrant - 4.0 * turns;
+
+                F zz = z * z;
+                F sp = z + z * zz * (((((1.58962301576546568060e-10 * zz - 2.50507477628578072866e-8) * zz +
+                                         2.75573136213857245213e-6) * zz - 1.98412698295895385996e-4) * zz +
+                                       8.33333333332211858878e-3) * zz - 1.66666666666666307295e-1);
+                F cp = 1.0 - 0.5 * zz + zz * zz * (((((-1.13585365213876817300e-11 * zz + 2.08757008419747316778e-9) * zz -
+                                                       2.75573141792967388112e-7) * zz + 2.48015872888517045348e-5) * zz -
+                                                     1.38888888888730564116e-3) * zz + 4.16666666666665929218e-2);
+                s = quadrant == 0.0 ? sp : (quadrant == 1.0 ? cp : (quadrant == 2.0 ? -sp : -cp));
+                c = quadrant == 0.0 ? cp : (quadrant == 1.0 ? -sp : (quadrant == 2.0 ? -cp : sp));
+            }
+
+            // exp for x in [-700, 0], in place
+            template <int D> PIGMENT_SIMD_INLINE void exp_f64(typename Lanes64<D>::f64 &x) {
+                using F = typename Lanes64<D>::f64;
+                using I = typename Lanes64<D>::i64;
+                F n = x * 1.4426950408889634073599 + 0.5;
+                floor_f64<D>(n);
+                x = x - n * 6.93145751953125e-1 - n * 1.42860682030941723212e-6;
+                F xx = x * x;
+                F p = x * ((1.26177193074810590878e-4 * xx + 3.02994407707441961300e-2) * xx + 9.99999999999999999910e-1);
+                F q = ((3.00198505138664455042e-6 * xx + 2.52448340349684104192e-3) * xx + 2.27265548208155028766e-1) * xx +
+                      2.00000000000000000009e0;
+                x = 1.0 + 2.0 * (p / (q - p));
+                // Scale by 2^n: n + 1.5 * 2^52 holds n in its low mantissa bits
+                F biased = n + 0x1.8p52;
+                I bits;
+                std::memcpy(&bits, &biased, sizeof(F));
+                bits = (bits - 0x4338000000000000LL + 1023) << 52;
+                F scale;
+                std::memcpy(&scale, &bits, sizeof(F));
+                x = x * scale;
+            }
+
+            // Mirrors LAB::delta_e_2000 (reference weights kL = kC = kH = 1) operation for operation, with the
+            // vector math above in place of the libm calls
+            template <int D>
+            PIGMENT_SIMD_INLINE void delta_e_2000_block(const double *l1p, const double *a1p, const double *b1p,
+                                                        const double *l2p, const double *a2p, const double *b2p,
+                                                        double *out) {
+                using F = typename Lanes64<D>::f64;
+                const F zero = F{};
+                constexpr double deg = 180.0 / 3.14159265358979323846;
+                constexpr double pow25_7 = 6103515625.0;
+                F l1, a1, b1, l2, a2, b2;
+                std::memcpy(&l1, l1p, sizeof(F));
+                std::memcpy(&a1, a1p, sizeof(F));
+                std::memcpy(&b1, b1p, sizeof(F));
+                std::memcpy(&l2, l2p, sizeof(F));
+                std::memcpy(&a2, a2p, sizeof(F));
+                std::memcpy(&b2, b2p, sizeof(F));
+
+                F c1 = a1 * a1 + b1 * b1;
+                F c2 = a2 * a2 + b2 * b2;
+                sqrt_f64<D>(c1);
+                sqrt_f64<D>(c2);
+                F c_mean = (c1 + c2) / 2.0;
+                F c_mean2 = c_mean * c_mean;
+                F c_mean7 = c_mean2 * c_mean2 * c_mean2 * c_mean;
+                F g = c_mean7 / (c_mean7 + pow25_7);
+                sqrt_f64<D>(g);
+                g = 0.5 * (1.0 - g);
+                a1 = (1.0 + g) * a1;
+                a2 = (1.0 + g) * a2;
+                c1 = a1 * a1 + b1 * b1;
+                c2 = a2 * a2 + b2 * b2;
+                sqrt_f64<D>(c1);
+                sqrt_f64<D>(c2);
+                F h1, h2;
+                hue_degrees<D>(b1, a1, h1);
+                hue_degrees<D>(b2, a2, h2);
+
+                F dl = l2 - l1;
+                F dc = c2 - c1;
+                auto chromatic = c1 * c2 != 0.0;
+                F dh = h2 - h1;
+                dh = dh > 180.0 ? dh - 360.0 : (dh < -180.0 ? dh + 360.0 : dh);
+                dh = chromatic ? dh : zero;
+                F half_dh = dh / 2.0 / deg;
+                F half_abs = half_dh < 0.0 ? -half_dh : half_dh;
+                F sin_half, unused;
+                sincos_f64<D>(half_abs, sin_half, unused);
+                sin_half = half_dh < 0.0 ? -sin_half : sin_half;
+                F c12 = c1 * c2;
+                sqrt_f64<D>(c12);
+                F dh_big = 2.0 * c12 * sin_half;
+
+                F l_mean = (l1 + l2) / 2.0;
+                F c_mean_p = (c1 + c2) / 2.0;
+                F h_sum = h1 + h2;
+                F h_diff = h1 - h2;
+                h_diff = h_diff < 0.0 ? -h_diff : h_diff;
+                F h_mean = h_diff <= 180.0 ? h_sum / 2.0 : (h_sum < 360.0 ? (h_sum + 360.0) / 2.0 : (h_sum - 360.0) / 2.0);
+                h_mean = chromatic ? h_mean : h_sum;
+
+                // T from one sin/cos pair via the multiple-angle identities
+                F s1, c1h;
+                sincos_f64<D>(h_mean / deg, s1, c1h);
+                F c2h = 2.0 * c1h * c1h - 1.0;
+                F s2h = 2.0 * s1 * c1h;
+                F c3h = c1h * (4.0 * c1h * c1h - 3.0);
+                F s3h = s1 * (3.0 - 4.0 * s1 * s1);
+                F c4h = 2.0 * c2h * c2h - 1.0;
+                F s4h = 2.0 * s2h * c2h;
+                const double cos30 = 0.86602540378443864676, sin30 = 0.5;
+                const double cos6 = 0.99452189536827333692, sin6 = 0.10452846326765347140;
+                const double cos63 = 0.45399049973954679156, sin63 = 0.89100652418836786236;
+                F t = 1.0 - 0.17 * (c1h * cos30 + s1 * sin30) + 0.24 * c2h + 0.32 * (c3h * cos6 - s3h * sin6) -
+                      0.20 * (c4h * cos63 + s4h * sin63);
+
+                F z = (h_mean - 275.0) / 25.0;
+                F d_theta = -(z * z);
+                exp_f64<D>(d_theta);
+                d_theta = 30.0 * d_theta;
+                F c_mean_p2 = c_mean_p * c_mean_p;
+                F c_mean_p7 = c_mean_p2 * c_mean_p2 * c_mean_p2 * c_mean_p;
+                F rc = c_mean_p7 / (c_mean_p7 + pow25_7);
+                sqrt_f64<D>(rc);
+                rc = 2.0 * rc;
+                F l50 = (l_mean - 50.0) * (l_mean - 50.0);
+                F sl_den = 20.0 + l50;
+                sqrt_f64<D>(sl_den);
+                F sl = 1.0 + 0.015 * l50 / sl_den;
+                F sc = 1.0 + 0.045 * c_mean_p;
+                F sh = 1.0 + 0.015 * c_mean_p * t;
+                F sin_rot, cos_rot;
+                sincos_f64<D>(2.0 * d_theta / deg, sin_rot, cos_rot);
+                F rt = -sin_rot * rc;
+
+                F tl = dl / sl;
+                F tc = dc / sc;
+                F th = dh_big / sh;
+                F result = tl * tl + tc * tc + th * th + rt * tc * th;
+                sqrt_f64<D>(result);
+                std::memcpy(out, &result, sizeof(F));
+            }
+
+            // Byte <-> 32-bit lanes. Converting through 16 bits lets GCC emit pmovzx / packus; a direct
+            // conversion is lowered lane by lane.
+            template <int W> PIGMENT_SIMD_INLINE void widen_u8(const uint8_t *p, typename Lanes<W>::u32 &out) {
+                typename Lanes<W>::u8 v;
+                std::memcpy(&v, p, sizeof(v));
+                if constexpr (W == 1) {
+                    out = v;
+                } else {
+                    out = PIGMENT_SIMD_CONVERT(PIGMENT_SIMD_CONVERT(v, typename Lanes<W>::u16),
+                                               typename Lanes<W>::u32);
+                }
+            }
+
+            // Values must already be in [0, 255]
+            template <int W> PIGMENT_SIMD_INLINE void narrow_u8(uint8_t *p, const typename Lanes<W>::u32 &x) {
+                typename Lanes<W>::u8 v;
+                if constexpr (W == 1) {
+                    v = static_cast<uint8_t>(x);
+                } else {
+                    v = PIGMENT_SIMD_CONVERT(PIGMENT_SIMD_CONVERT(x, typename Lanes<W>::u16),
+                                             typename Lanes<W>::u8);
+                }
+                std::memcpy(p, &v, sizeof(v));
+            }
+
+            // detail::fixed_mix and detail::fixed_scale on bytes. Every intermediate fits in 32 bits: a mix
+            // is at most 255 * 65536 + 32768, a scale (factor <= 256) at most 255 * 2^24 + 32768.
+            template <int W>
+            PIGMENT_SIMD_INLINE void mix_u8_block(const uint8_t *a, const uint8_t *b, uint8_t *out, uint32_t w) {
+                typename Lanes<W>::u32 x, y;
+                widen_u8<W>(a, x);
+                widen_u8<W>(b, y);
+                narrow_u8<W>(out, (x * (65536u - w) + y * w + 32768u) >> 16);
+            }
+
+            template <int W> PIGMENT_SIMD_INLINE void scale_u8_block(const uint8_t *in, uint8_t *out, uint32_t f) {
+                typename Lanes<W>::u32 x;
+                widen_u8<W>(in, x);
+                const typename Lanes<W>::u32 zero{};
+                x = (x * f + 32768u) >> 16;
+                narrow_u8<W>(out, x > 255u ? zero + 255u : x);
+            }
+
+            // Runs `block` over n pixels W at a time; the tail goes through the one-lane instantiation
+#define PIGMENT_SIMD_RUN(block, W, in0, in1, in2, out0, out1, out2, n)                                            \
+    do {                                                                                                           \
+        size_t i = 0;                                                                                              \
+        for (; i + (W) <= (n); i += (W))                                                                           \
+            block<W>(in0 + i, in1 + i, in2 + i, out0 + i, out1 + i, out2 + i);                                     \
+        for (; i < (n); ++i)                                                                                       \
+            block<1>(in0 + i, in1 + i, in2 + i, out0 + i, out1 + i, out2 + i);                                     \
+    } while (0)
+
+            // One entry point per (kernel, instruction set)
+#define PIGMENT_SIMD_DEFINE_KERNEL(name, block, InT, OutT, W, ...)                                                \
+    __VA_ARGS__ inline void name(const InT *a0, const InT *a1, const InT *a2, OutT *b0, OutT *b1, OutT *b2,        \
+                                 size_t n) {                                                                       \
+        PIGMENT_SIMD_RUN(block, W, a0, a1, a2, b0, b1, b2, n);                                                     \
+    }
+
+#define PIGMENT_SIMD_DEFINE_KERNELS(suffix, W, ...)                                                                \
+    PIGMENT_SIMD_DEFINE_KERNEL(rgb_to_hsv_##suffix, rgb_to_hsv_block, uint8_t, float, W, __VA_ARGS__)              \
+    PIGMENT_SIMD_DEFINE_KERNEL(hsv_to_rgb_##suffix, hsv_to_rgb_block, float, uint8_t, W, __VA_ARGS__)              \
+    PIGMENT_SIMD_DEFINE_KERNEL(rgb_to_hsl_##suffix, rgb_to_hsl_block, uint8_t, float, W, __VA_ARGS__)              \
+    PIGMENT_SIMD_DEFINE_KERNEL(hsl_to_rgb_##suffix, hsl_to_rgb_block, float, uint8_t, W, __VA_ARGS__)
+
+            PIGMENT_SIMD_DEFINE_KERNELS(scalar, 1, )
+#if PIGMENT_SIMD_X86
+            PIGMENT_SIMD_DEFINE_KERNELS(sse41, 4, __attribute__((target("sse4.1"))))
+            PIGMENT_SIMD_DEFINE_KERNELS(avx2, 8, __attribute__((target("avx2"))))
+            PIGMENT_SIMD_DEFINE_KERNELS(avx512, 16, __attribute__((target("avx512f"))))
+#endif
+
+#undef PIGMENT_SIMD_DEFINE_KERNELS
+#undef PIGMENT_SIMD_DEFINE_KERNEL
+#undef PIGMENT_SIMD_RUN
+
+            // CIEDE2000 entry points: pairwise over two planar arrays, and one reference against an array (the
+            // reference is broadcast into a block once)
+#define PIGMENT_SIMD_DEFINE_DELTA_E(suffix, D, ...)                                                               \
+    __VA_ARGS__ inline void delta_e_2000_pairs_##suffix(const double *l1, const double *a1, const double *b1,      \
+                                                        const double *l2, const double *a2, const double *b2,      \
+                                                        double *out, size_t n) {                                   \
+        size_t i = 0;                                                                                              \
+        for (; i + (D) <= n; i += (D))                                                                             \
+            delta_e_2000_block<D>(l1 + i, a1 + i, b1 + i, l2 + i, a2 + i, b2 + i, out + i);                        \
+        for (; i < n; ++i)                                                                                         \
+            delta_e_2000_block<1>(l1 + i, a1 + i, b1 + i, l2 + i, a2 + i, b2 + i, out + i);                        \
+    }                                                                                                              \
+    __VA_ARGS__ inline void delta_e_2000_reference_##suffix(const double *reference, const double *l,             \
+                                                            const double *a, const double *b, double *out,         \
+                                                            size_t n) {                                            \
+        double rl[D], ra[D], rb[D];                                                                                \
+        for (int k = 0; k < (D); ++k) {                                                                            \
+            rl[k] = reference[0];                                                                                  \
+            ra[k] = reference[1];                                                                                  \
+            rb[k] = reference[2];                                                                                  \
+        }                                                                                                          \
+        size_t i = 0;                                                                                              \
+        for (; i + (D) <= n; i += (D))                                                                             \
+            delta_e_2000_block<D>(rl, ra, rb, l + i, a + i, b + i, out + i);                                       \
+        for (; i < n; ++i)                                                                                         \
+            delta_e_2000_block<1>(rl, ra, rb, l + i, a + i, b + i, out + i);                                       \
+    }
+
+            PIGMENT_SIMD_DEFINE_DELTA_E(scalar, 1, )
+#if PIGMENT_SIMD_X86
+            PIGMENT_SIMD_DEFINE_DELTA_E(sse41, 2, __attribute__((target("sse4.1"))))
+            PIGMENT_SIMD_DEFINE_DELTA_E(avx2, 4, __attribute__((target("avx2"))))
+            PIGMENT_SIMD_DEFINE_DELTA_E(avx512, 8, __attribute__((target("avx512f"))))
+#endif
+
+#undef PIGMENT_SIMD_DEFINE_DELTA_E
+
+#define PIGMENT_SIMD_DEFINE_FIXED(suffix, W, ...)                                                                 \
+    __VA_ARGS__ inline void mix_u8_##suffix(const uint8_t *a, const uint8_t *b, uint8_t *out, size_t n,          \
+                                            uint32_t w) {                                                          \
+        size_t i = 0;                                                                                              \
+        for (; i + (W) <= n; i += (W))                                                                             \
+            mix_u8_block<W>(a + i, b + i, out + i, w);                                                             \
+        for (; i < n; ++i)                                                                                         \
+            mix_u8_block<1>(a + i, b + i, out + i, w);                                                             \
+    }                                                                                                              \
+    __VA_ARGS__ inline void scale_u8_##suffix(const uint8_t *in, uint8_t *out, size_t n, uint32_t f) {           \
+        size_t i = 0;                                                                                              \
+        for (; i + (W) <= n; i += (W))                                                                             \
+            scale_u8_block<W>(in + i, out + i, f);                                                                 \
+        for (; i < n; ++i)                                                                                         \
+            scale_u8_block<1>(in + i, out + i, f);                                                                 \
+    }
+
+            // A full register of bytes per step, widened into four registers of 32-bit lanes
+            PIGMENT_SIMD_DEFINE_FIXED(scalar, 1, )
+#if PIGMENT_SIMD_X86
+            PIGMENT_SIMD_DEFINE_FIXED(sse41, 16, __attribute__((target("sse4.1"))))
+            PIGMENT_SIMD_DEFINE_FIXED(avx2, 32, __attribute__((target("avx2"))))
+            PIGMENT_SIMD_DEFINE_FIXED(avx512, 64, __attribute__((target("avx512f"))))
+#endif
+
+#undef PIGMENT_SIMD_DEFINE_FIXED
+
+        } // namespace detail
+
+#define PIGMENT_SIMD_DISPATCH(name, ...) PIGMENT_SIMD_SELECT(level, detail::name, __VA_ARGS__)
+
+        // Batch RGB <-> HSV on planar data. Results are identical to HSV::fromRGB / HSV::toRGB at every level.
+        inline void rgb_to_hsv(const uint8_t *r, const uint8_t *g, const uint8_t *b, float *h, float *s, float *v,
+                               size_t n, Level level = detected_level()) {
+            PIGMENT_SIMD_DISPATCH(rgb_to_hsv, r, g, b, h, s, v, n)
+        }
+
+        inline void hsv_to_rgb(const float *h, const float *s, const float *v, uint8_t *r, uint8_t *g, uint8_t *b,
+                               size_t n, Level level = detected_level()) {
+            PIGMENT_SIMD_DISPATCH(hsv_to_rgb, h, s, v, r, g, b, n)
+        }
+
+        // Batch RGB <-> HSL on planar data, in single precision. Hue agrees with HSL::fromRGB to within 2e-4
+        // degrees and S/L to within 2e-6; round trips back to 8-bit RGB are exact.
+        inline void rgb_to_hsl(const uint8_t *r, const uint8_t *g, const uint8_t *b, float *h, float *s, float *l,
+                               size_t n, Level level = detected_level()) {
+            PIGMENT_SIMD_DISPATCH(rgb_to_hsl, r, g, b, h, s, l, n)
+        }
+
+        inline void hsl_to_rgb(const float *h, const float *s, const float *l, uint8_t *r, uint8_t *g, uint8_t *b,
+                               size_t n, Level level = detected_level()) {
+            PIGMENT_SIMD_DISPATCH(hsl_to_rgb, h, s, l, r, g, b, n)
+        }
+
+        // Batch CIEDE2000 on planar LAB values: out[i] is the difference between pair i of the two arrays, or
+        // between `reference` and entry i. Agrees with LAB::delta_e_2000 to within 1e-9 at every level.
+        inline void delta_e_2000(const double *l1, const double *a1, const double *b1, const double *l2,
+                                 const double *a2, const double *b2, double *out, size_t n,
+                                 Level level = detected_level()) {
+            PIGMENT_SIMD_DISPATCH(delta_e_2000_pairs, l1, a1, b1, l2, a2, b2, out, n)
+        }
+
+        inline void delta_e_2000(const LAB &reference, const double *l, const double *a, const double *b, double *out,
+                                 size_t n, Level level = detected_level()) {
+            const double ref[3] = {reference.l, reference.a, reference.b};
+            PIGMENT_SIMD_DISPATCH(delta_e_2000_reference, ref, l, a, b, out, n)
+        }
+
+        // Byte-wise 16.16 fixed-point blend and scale, identical to RGB::mix and RGB::operator* per channel:
+        // out[i] = a[i] * (1 - ratio) + b[i] * ratio and out[i] = min(in[i] * factor, 255), rounded to nearest
+        inline void mix(const uint8_t *a, const uint8_t *b, uint8_t *out, size_t n, double ratio,
+                        Level level = detected_level()) {
+            const uint32_t w = static_cast<uint32_t>(pigment::detail::fixed_ratio(ratio));
+            PIGMENT_SIMD_DISPATCH(mix_u8, a, b, out, n, w)
+        }
+
+        inline void scale(const uint8_t *in, uint8_t *out, size_t n, double factor, Level level = detected_level()) {
+            const uint32_t f = static_cast<uint32_t>(pigment::detail::fixed_factor(factor));
+            PIGMENT_SIMD_DISPATCH(scale_u8, in, out, n, f)
+        }
+
+#undef PIGMENT_SIMD_DISPATCH
+
+        // Single-precision planar HSL image, planes (H, S, L)
+        using HSLfBuffer = PlanarBuffer<float, 3>;
+
+        // PixelBuffer front ends; the reverse conversions leave the alpha plane untouched
+        inline void rgb_to_hsv(const PixelBuffer &in, HSVBuffer &out, Level level = detected_level()) {
+            out.resize(in.width(), in.height());
+            rgb_to_hsv(in.plane(PixelBuffer::R), in.plane(PixelBuffer::G), in.plane(PixelBuffer::B), out.plane(0),
+                       out.plane(1), out.plane(2), in.size(), level);
+        }
+
+        inline void hsv_to_rgb(const HSVBuffer &in, PixelBuffer &out, Level level = detected_level()) {
+            if (out.width() != in.width() || out.height() != in.height()) {
+                out = PixelBuffer(in.width(), in.height());
+            }
+            hsv_to_rgb(in.plane(0), in.plane(1), in.plane(2), out.plane(PixelBuffer::R), out.plane(PixelBuffer::G),
+                       out.plane(PixelBuffer::B), in.size(), level);
+        }
+
+        inline void rgb_to_hsl(const PixelBuffer &in, HSLfBuffer &out, Level level = detected_level()) {
+            out.resize(in.width(), in.height());
+            rgb_to_hsl(in.plane(PixelBuffer::R), in.plane(PixelBuffer::G), in.plane(PixelBuffer::B), out.plane(0),
+                       out.plane(1), out.plane(2), in.size(), level);
+        }
+
+        inline void hsl_to_rgb(const HSLfBuffer &in, PixelBuffer &out, Level level = detected_level()) {
+            if (out.width() != in.width() || out.height() != in.height()) {
+                out = PixelBuffer(in.width(), in.height());
+            }
+            hsl_to_rgb(in.plane(0), in.plane(1), in.plane(2), out.plane(PixelBuffer::R), out.plane(PixelBuffer::G),
+                       out.plane(PixelBuffer::B), in.size(), level);
+        }
+
+        // Blend two images of the same size, alpha included, like RGB::mix on every pixel
+        inline void mix(const PixelBuffer &a, const PixelBuffer &b, double ratio, PixelBuffer &out,
+                        Level level = detected_level()) {
+            if (a.width() != b.width() || a.height() != b.height()) {
+                throw std::invalid_argument("mix: images differ in size");
+            }
+            if (out.width() != a.width() || out.height() != a.height()) {
+                out = PixelBuffer(a.width(), a.height());
+            }
+            // The four planes are contiguous, so the whole image is one run of bytes
+            mix(a.plane(0), b.plane(0), out.plane(0), PixelBuffer::channels * a.size(), ratio, level);
+        }
+
+        // Interleaved pixels blend byte by byte the same way
+        inline void mix(std::span<const RGBA8> a, std::span<const RGBA8> b, double ratio, std::span<RGBA8> out,
+                        Level level = detected_level()) {
+            if (a.size() != b.size() || out.size() < a.size()) {
+                throw std::invalid_argument("mix: input and output sizes differ");
+            }
+            mix(reinterpret_cast<const uint8_t *>(a.data()), reinterpret_cast<const uint8_t *>(b.data()),
+                reinterpret_cast<uint8_t *>(out.data()), 4 * a.size(), ratio, level);
+        }
+
+        // Scale the color planes like RGB::operator*; alpha is copied
+        inline void scale(const PixelBuffer &in, double factor, PixelBuffer &out, Level level = detected_level()) {
+            if (out.width() != in.width() || out.height() != in.height()) {
+                out = PixelBuffer(in.width(), in.height());
+            }
+            scale(in.plane(0), out.plane(0), 3 * in.size(), factor, level);
+            if (&out != &in) {
+                std::copy(in.plane(PixelBuffer::A), in.plane(PixelBuffer::A) + in.size(), out.plane(PixelBuffer::A));
+            }
+        }
+
+        // CIEDE2000 over LAB values; these are split into planar blocks on the stack for the kernels above
+        inline void delta_e_2000(const LAB &reference, std::span<const LAB> colors, std::span<double> out,
+                                 Level level = detected_level()) {
+            if (out.size() < colors.size()) {
+                throw std::invalid_argument("delta_e_2000: output is smaller than the input");
+            }
+            constexpr size_t block = 256;
+            double l[block], a[block], b[block];
+            for (size_t i = 0; i < colors.size(); i += block) {
+                const size_t n = std::min(block, colors.size() - i);
+                for (size_t k = 0; k < n; ++k) {
+                    l[k] = colors[i + k].l;
+                    a[k] = colors[i + k].a;
+                    b[k] = colors[i + k].b;
+                }
+                delta_e_2000(reference, l, a, b, out.data() + i, n, level);
+            }
+        }
+
+        inline std::vector<double> delta_e_2000(const LAB &reference, std::span<const LAB> colors,
+                                                Level level = detected_level()) {
+            std::vector<double> out(colors.size());
+            delta_e_2000(reference, colors, out, level);
+            return out;
+        }
+
+        inline void delta_e_2000(std::span<const LAB> first, std::span<const LAB> second, std::span<double> out,
+                                 Level level = detected_level()) {
+            if (first.size() != second.size() || out.size() < first.size()) {
+                throw std::invalid_argument("delta_e_2000: input and output sizes differ");
+            }
+            constexpr size_t block = 128;
+            double l1[block], a1[block], b1[block], l2[block], a2[block], b2[block];
+            for (size_t i = 0; i < first.size(); i += block) {
+                const size_t n = std::min(block, first.size() - i);
+                for (size_t k = 0; k < n; ++k) {
+                    l1[k] = first[i + k].l;
+                    a1[k] = first[i + k].a;
+                    b1[k] = first[i + k].b;
+                    l2[k] = second[i + k].l;
+                    a2[k] = second[i + k].a;
+                    b2[k] = second[i + k].b;
+                }
+                delta_e_2000(l1, a1, b1, l2, a2, b2, out.data() + i, n, level);
+            }
+        }
+
+        inline void delta_e_2000(const LAB &reference, const LABBuffer &colors, std::vector<double> &out,
+                                 Level level = detected_level()) {
+            out.resize(colors.size());
+            delta_e_2000(reference, colors.plane(0), colors.plane(1), colors.plane(2), out.data(), colors.size(), level);
+        }
+
+    } // namespace simd
+} // namespace pigment
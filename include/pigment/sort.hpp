@@ -0,0 +1,196 @@
+#pragma once
+
+#include "execution.hpp"
+#include "types_basic.hpp"
+#include "types_hsl.hpp"
+#include "types_lab.hpp"
+#include "types_oklab.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace pigment {
+
+    // Sorting by a key extracted once per element. Keys go into a side array next to the element's index, so
+    // a sort costs N key extractions instead of 2 * N * log N. Keys are mapped to an order-preserving 64-bit
+    // image; large inputs are radix sorted on its top 32 bits (three stable LSD passes of 11-bit digits,
+    // skipping passes whose digit is the same for every element), and the short runs that share those bits
+    // are then finished with a comparison sort on the full key. The order is exactly that of comparing keys
+    // with <, ties kept in input order. Under a parallel policy each pass histograms and scatters fixed
+    // chunks independently; the result does not depend on the policy.
+    namespace sorting {
+
+        // Key extractors for colors
+        namespace keys {
+            inline constexpr auto hue = [](const RGB &c) { return HSL::fromRGB(c).h; };
+            inline constexpr auto saturation = [](const RGB &c) { return HSL::fromRGB(c).s; };
+            inline constexpr auto luminance = [](const RGB &c) { return c.luminance(); };
+            inline constexpr auto lab_lightness = [](const RGB &c) {
+                double l, a, b;
+                LAB::from_channels(c.r, c.g, c.b, l, a, b);
+                return l;
+            };
+            inline constexpr auto oklab_lightness = [](const RGB &c) {
+                double l, a, b;
+                OKLAB::from_channels(c.r, c.g, c.b, l, a, b);
+                return l;
+            };
+            inline constexpr auto oklch_hue = [](const RGB &c) {
+                double l, ch, h;
+                OKLCH::from_channels(c.r, c.g, c.b, l, ch, h);
+                return h;
+            };
+        } // namespace keys
+
+        // Below this many elements a comparison sort on the precomputed keys is faster than radix passes
+        inline constexpr size_t radix_threshold = 2048;
+
+        namespace detail {
+            struct Keyed {
+                uint64_t key;
+                size_t index;
+            };
+
+            // Order-preserving map to unsigned 64-bit: a < b exactly when radix_key(a) < radix_key(b)
+            template <typename K> uint64_t radix_key(K k) {
+                if constexpr (std::is_floating_point_v<K>) {
+                    // -0.0 compares equal to 0.0, so it must map to the same key
+                    uint64_t bits = std::bit_cast<uint64_t>(static_cast<double>(k) + 0.0);
+                    return (bits >> 63) ? ~bits : bits | (uint64_t(1) << 63);
+                } else if constexpr (std::is_signed_v<K>) {
+                    return static_cast<uint64_t>(static_cast<int64_t>(k)) ^ (uint64_t(1) << 63);
+                } else {
+                    return static_cast<uint64_t>(k);
+                }
+            }
+
+            template <typename Policy> size_t element_chunk(const Policy &policy, size_t n) {
+                if (policy.chunk != 0) {
+                    return policy.chunk;
+                }
+                return std::is_same_v<Policy, execution::sequenced_policy> ? std::max<size_t>(n, 1)
+                                                                           : execution::chunk_for<Keyed>();
+            }
+
+            template <typename Policy> void radix_sort(const Policy &policy, std::vector<Keyed> &items) {
+                constexpr int bits = 11;
+                constexpr size_t radix = size_t(1) << bits;
+                const size_t n = items.size();
+                const size_t chunk = element_chunk(policy, n);
+                const size_t chunks = (n + chunk - 1) / chunk;
+                const auto per_chunk = policy.with_chunk(1);
+                std::vector<Keyed> buffer(n);
+                std::vector<size_t> counts(chunks * radix);
+
+                for (int shift = 32; shift < 64; shift += bits) {
+                    auto digit = [shift](const Keyed &item) { return (item.key >> shift) & (radix - 1); };
+                    std::fill(counts.begin(), counts.end(), 0);
+                    execution::for_each_chunk(per_chunk, chunks, 1, [&](size_t c0, size_t c1) {
+                        for (size_t c = c0; c < c1; ++c) {
+                            size_t *count = counts.data() + c * radix;
+                            for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); ++i) {
+                                ++count[digit(items[i])];
+                            }
+                        }
+                    });
+                    // Exclusive prefix over (digit, chunk), so each chunk scatters its run of every digit in order
+                    size_t offset = 0;
+                    bool skip = false;
+                    for (size_t d = 0; d < radix && !skip; ++d) {
+                        size_t total = 0;
+                        for (size_t c = 0; c < chunks; ++c) {
+                            size_t count = counts[c * radix + d];
+                            counts[c * radix + d] = offset;
+                            offset += count;
+                            total += count;
+                        }
+                        skip = total == n;
+                    }
+                    if (skip) {
+                        continue; // every key has this digit
+                    }
+                    execution::for_each_chunk(per_chunk, chunks, 1, [&](size_t c0, size_t c1) {
+                        for (size_t c = c0; c < c1; ++c) {
+                            size_t *next = counts.data() + c * radix;
+                            for (size_t i = c * chunk; i < std::min(n, (c + 1) * chunk); ++i) {
+                                buffer[next[digit(items[i])]++] = items[i];
+                            }
+                        }
+                    });
+                    items.swap(buffer);
+                }
+
+                // Elements sharing the top 32 bits are contiguous and in input order; finish them on the full key
+                execution::for_each_chunk(per_chunk, chunks, 1, [&](size_t c0, size_t c1) {
+                    for (size_t c = c0; c < c1; ++c) {
+                        // A chunk owns the runs that start inside it
+                        size_t i = c * chunk;
+                        const size_t end = std::min(n, (c + 1) * chunk);
+                        while (i > 0 && i < end && (items[i].key >> 32) == (items[i - 1].key >> 32)) {
+                            ++i;
+                        }
+                        while (i < end) {
+                            size_t j = i + 1;
+                            while (j < n && (items[j].key >> 32) == (items[i].key >> 32)) {
+                                ++j;
+                            }
+                            if (j - i > 1) {
+                                std::stable_sort(items.begin() + i, items.begin() + j,
+                                                 [](const Keyed &x, const Keyed &y) { return x.key < y.key; });
+                            }
+                            i = j;
+                        }
+                    }
+                });
+            }
+        } // namespace detail
+
+        // Stable sorting permutation: values[result[0]] has the smallest key
+        template <execution::ExecutionPolicy Policy, typename T, typename Key>
+        std::vector<size_t> order(const Policy &policy, const std::vector<T> &values, Key key) {
+            const size_t n = values.size();
+            std::vector<detail::Keyed> items(n);
+            execution::for_each_chunk(policy, n, execution::chunk_for<T>(), [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    items[i] = {detail::radix_key(key(values[i])), i};
+                }
+            });
+            if (n < radix_threshold) {
+                std::stable_sort(items.begin(), items.end(),
+                                 [](const detail::Keyed &x, const detail::Keyed &y) { return x.key < y.key; });
+            } else {
+                detail::radix_sort(policy, items);
+            }
+            std::vector<size_t> out(n);
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = items[i].index;
+            }
+            return out;
+        }
+
+        template <typename T, typename Key> std::vector<size_t> order(const std::vector<T> &values, Key key) {
+            return order(execution::seq, values, key);
+        }
+
+        // Stable in-place sort by key(value)
+        template <execution::ExecutionPolicy Policy, typename T, typename Key>
+        void by_key(const Policy &policy, std::vector<T> &values, Key key) {
+            const std::vector<size_t> perm = order(policy, values, key);
+            std::vector<T> sorted(values.size());
+            execution::for_each_chunk(policy, values.size(), execution::chunk_for<T>(), [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; ++i) {
+                    sorted[i] = values[perm[i]];
+                }
+            });
+            values.swap(sorted);
+        }
+
+        template <typename T, typename Key> void by_key(std::vector<T> &values, Key key) {
+            by_key(execution::seq, values, key);
+        }
+
+    } // namespace sorting
+} // namespace pigment
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace pigment {
+
+    // sRGB transfer functions and the cube root used by CIE LAB. Every conversion that passes through
+    // linear light goes through these instead of calling std::pow per channel.
+    namespace transfer {
+
+        // Exact sRGB decode of a normalized value
+        inline double srgb_to_linear_exact(double v) {
+            return (v > 0.04045) ? std::pow((v + 0.055) / 1.055, 2.4) : v / 12.92;
+        }
+
+        // Exact sRGB encode of a linear value
+        inline double linear_to_srgb_exact(double v) {
+            return (v > 0.0031308) ? 1.055 * std::pow(v, 1.0 / 2.4) - 0.055 : 12.92 * v;
+        }
+
+        namespace detail {
+            inline const std::array<double, 256> &decode_table() {
+                static const std::array<double, 256> table = [] {
+                    std::array<double, 256> t{};
+                    for (int i = 0; i < 256; ++i) {
+                        t[i] = srgb_to_linear_exact(i / 255.0);
+                    }
+                    return t;
+                }();
+                return table;
+            }
+
+            // Single-precision copy of decode_table() for the vector kernels
+            inline const std::array<float, 256> &decode_table_f32() {
+                static const std::array<float, 256> table = [] {
+                    std::array<float, 256> t{};
+                    for (int i = 0; i < 256; ++i) {
+                        t[i] = static_cast<float>(decode_table()[i]);
+                    }
+                    return t;
+                }();
+                return table;
+            }
+
+            // Encode straight to 8 bits from linear light quantized to 16 bits, round(v * encode8_steps).
+            // One step moves the encoded value by at most 0.05 of an 8-bit step (on the linear toe), so the
+            // table only differs from rounding the exact encode where that lands within 0.05 of a half.
+            constexpr int encode8_steps = 65535;
+
+            inline const std::array<uint8_t, encode8_steps + 1> &encode8_table() {
+                static const std::array<uint8_t, encode8_steps + 1> table = [] {
+                    std::array<uint8_t, encode8_steps + 1> t{};
+                    for (int i = 0; i <= encode8_steps; ++i) {
+                        double v = linear_to_srgb_exact(static_cast<double>(i) / encode8_steps);
+                        t[i] = static_cast<uint8_t>(v * 255.0 + 0.5);
+                    }
+                    return t;
+                }();
+                return table;
+            }
+
+            // Power segment of the encode curve sampled uniformly in sqrt(v): the curve is much flatter there,
+            // so linear interpolation between 1024 segments stays accurate all the way down to the linear toe.
+            // Samples below the toe continue the power curve so the segment straddling it has no kink.
+            constexpr int encode_segments = 1024;
+
+            inline const std::array<double, encode_segments + 2> &encode_table() {
+                static const std::array<double, encode_segments + 2> table = [] {
+                    std::array<double, encode_segments + 2> t{};
+                    for (int i = 0; i < encode_segments + 2; ++i) {
+                        double u = static_cast<double>(i) / encode_segments;
+                        t[i] = 1.055 * std::pow(u * u, 1.0 / 2.4) - 0.055;
+                    }
+                    return t;
+                }();
+                return table;
+            }
+        } // namespace detail
+
+        // Decode an 8-bit sRGB channel to linear light. Exact: a 256-entry table of srgb_to_linear_exact.
+        // Values outside [0, 255] fall back to the formula.
+        inline double srgb_to_linear(int v) {
+            if (static_cast<unsigned>(v) <= 255u) {
+                return detail::decode_table()[v];
+            }
+            return srgb_to_linear_exact(v / 255.0);
+        }
+
+        // Encode a linear value to normalized sRGB. Inside [0, 1] the absolute error is below 6e-7
+        // (1.5e-4 of an 8-bit step); the linear toe and values above 1 are computed exactly. NaN takes
+        // the linear branch and stays NaN instead of indexing the table.
+        inline double linear_to_srgb(double v) {
+            if (!(v > 0.0031308)) {
+                return 12.92 * v;
+            }
+            if (v >= 1.0) {
+                return linear_to_srgb_exact(v);
+            }
+            double u = std::sqrt(v) * detail::encode_segments;
+            int i = static_cast<int>(u);
+            double frac = u - i;
+            const auto &table = detail::encode_table();
+            return table[i] + (table[i + 1] - table[i]) * frac;
+        }
+
+        // Cube root: bit-level initial guess refined by two Halley steps, with relative error below 1e-14.
+        // Inputs outside [1e-300, 1e300] (including zero, negatives and non-finite values) use std::cbrt.
+        inline double fast_cbrt(double x) {
+            if (!(x >= 1e-300 && x <= 1e300)) {
+                return std::cbrt(x);
+            }
+            uint64_t bits = std::bit_cast<uint64_t>(x);
+            bits = bits / 3 + 0x2a9f7893782da1ceull;
+            double y = std::bit_cast<double>(bits);
+            for (int i = 0; i < 2; ++i) {
+                double y3 = y * y * y;
+                y *= (y3 + 2.0 * x) / (2.0 * y3 + x);
+            }
+            return y;
+        }
+
+    } // namespace transfer
+} // namespace pigment
@@ -1,68 +1,238 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <cstdint>
 #include <random>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <variant>
 #include <vector>
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
 #include <cmath>
+#include <type_traits>
 
 namespace pigment {
 
-    struct RGB {
-        int r = 0;
-        int g = 0;
-        int b = 0;
-        int a = 255;
+    // Why a hex color failed to parse; Ok on success (not None, which X11 headers define as a macro)
+    enum class ParseError { Ok, Empty, BadLength, BadDigit };
+
+    constexpr const char *parse_error_message(ParseError error) {
+        switch (error) {
+        case ParseError::Ok: return "no error";
+        case ParseError::Empty: return "empty hex color";
+        case ParseError::BadLength: return "hex color must have 3, 6 or 8 digits";
+        case ParseError::BadDigit: return "invalid hex digit";
+        }
+        return "unknown error";
+    }
+
+    namespace detail {
+        // Value of a hex digit, or -1
+        constexpr int hex_value(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        // The <cmath> functions below are not constexpr before C++23. During constant evaluation these use
+        // exact portable versions; at run time they call the library, so run-time results are unchanged.
+        template <typename T> constexpr T trunc(T x) {
+            // Anything this large is already integral (NaN passes through too)
+            if (!(x > T(-4503599627370496.0) && x < T(4503599627370496.0))) return x;
+            return static_cast<T>(static_cast<long long>(x));
+        }
+
+        template <typename T> constexpr T round(T x) {
+            if (!std::is_constant_evaluated()) return std::round(x);
+            T t = trunc(x);
+            T frac = x - t;
+            if (frac >= T(0.5)) t += 1;
+            if (frac <= T(-0.5)) t -= 1;
+            return t;
+        }
+
+        template <typename T> constexpr T floor(T x) {
+            if (!std::is_constant_evaluated()) return std::floor(x);
+            T t = trunc(x);
+            return t > x ? t - 1 : t;
+        }
+
+        template <typename T> constexpr T fabs(T x) {
+            if (!std::is_constant_evaluated()) return std::fabs(x);
+            return x < 0 ? -x : x;
+        }
+
+        // Long division by doubling: every subtraction is exact, like std::fmod
+        template <typename T> constexpr T fmod(T x, T y) {
+            if (!std::is_constant_evaluated()) return std::fmod(x, y);
+            T rem = fabs(x);
+            const T div = fabs(y);
+            while (rem >= div) {
+                T d = div;
+                while (d * 2 <= rem) d *= 2;
+                rem -= d;
+            }
+            return x < 0 ? -rem : rem;
+        }
 
-        RGB() = default;
-        RGB(int r_, int g_, int b_, int a_ = 255) : r(r_), g(g_), b(b_), a(a_) {}
+        // 16.16 fixed point for 8-bit channel arithmetic. A ratio or factor becomes an integer weight
+        // round(x * 65536); products are rounded to nearest (halves up) by adding 0.5 before the shift.
+        inline constexpr int64_t fixed_one = 65536;
+
+        // Mix weight for a ratio in [0, 1]
+        constexpr int64_t fixed_ratio(double ratio) {
+            if (!(ratio > 0.0)) return 0;
+            if (ratio >= 1.0) return fixed_one;
+            return static_cast<int64_t>(round(ratio * fixed_one));
+        }
+
+        // Scale factor; anything at or above 256 saturates every nonzero channel
+        constexpr int64_t fixed_factor(double factor) {
+            if (!(factor > 0.0)) return 0;
+            return static_cast<int64_t>(round(std::min(factor, 256.0) * fixed_one));
+        }
+
+        constexpr int fixed_mix(int x, int y, int64_t w) {
+            return static_cast<int>((x * (fixed_one - w) + y * w + fixed_one / 2) >> 16);
+        }
 
-        RGB(const std::string &hex) {
-            std::string h = hex;
-            if (!h.empty() && h[0] == '#') {
-                h.erase(0, 1);
+        constexpr int fixed_scale(int x, int64_t f) {
+            return static_cast<int>(std::clamp<int64_t>((x * f + fixed_one / 2) >> 16, 0, 255));
+        }
+
+        // Parses "#rgb", "#rrggbb" or "#rrggbbaa" (the '#' is optional) into r, g, b, a. Leaves `channels`
+        // untouched on failure; alpha defaults to 255 when the caller initializes it so.
+        constexpr ParseError parse_hex(std::string_view hex, int (&channels)[4]) noexcept {
+            if (!hex.empty() && hex[0] == '#') {
+                hex.remove_prefix(1);
+            }
+            if (hex.empty()) {
+                return ParseError::Empty;
+            }
+            if (hex.size() != 3 && hex.size() != 6 && hex.size() != 8) {
+                return ParseError::BadLength;
             }
-            if (h.size() == 3) {
-                std::string tmp;
-                tmp.reserve(6);
-                for (char c : h) {
-                    tmp.push_back(c);
-                    tmp.push_back(c);
+            // The short form repeats each digit
+            const size_t digits = hex.size() == 3 ? 1 : 2;
+            int parsed[4] = {0, 0, 0, channels[3]};
+            for (size_t i = 0; i < hex.size(); i += digits) {
+                int hi = hex_value(hex[i]);
+                int lo = hex_value(hex[i + digits - 1]);
+                if ((hi | lo) < 0) {
+                    return ParseError::BadDigit;
                 }
-                h = tmp;
+                parsed[i / digits] = hi * 16 + lo;
             }
-            if (h.size() == 6) {
-                h += "ff";
+            for (int c = 0; c < 4; ++c) {
+                channels[c] = parsed[c];
             }
-            if (h.size() != 8) {
-                throw std::invalid_argument("Invalid hex color: '" + hex + "'");
+            return ParseError::Ok;
+        }
+
+        // Two lowercase hex digits for every byte value
+        inline constexpr std::array<char, 512> hex_pairs = [] {
+            constexpr char digits[] = "0123456789abcdef";
+            std::array<char, 512> table{};
+            for (int i = 0; i < 256; ++i) {
+                table[2 * i] = digits[i >> 4];
+                table[2 * i + 1] = digits[i & 15];
             }
-            r = std::stoi(h.substr(0, 2), nullptr, 16);
-            g = std::stoi(h.substr(2, 2), nullptr, 16);
-            b = std::stoi(h.substr(4, 2), nullptr, 16);
-            a = std::stoi(h.substr(6, 2), nullptr, 16);
+            return table;
+        }();
+
+        // Writes a channel as two hex digits, clamping it into [0, 255] first
+        constexpr char *write_hex_byte(char *out, int value) {
+            const char *pair = hex_pairs.data() + 2 * std::clamp(value, 0, 255);
+            out[0] = pair[0];
+            out[1] = pair[1];
+            return out + 2;
         }
+    } // namespace detail
 
-        // Convert to hex string
-        std::string to_hex(bool include_alpha = false) const {
-            std::stringstream ss;
-            ss << "#" << std::hex << std::setfill('0') 
-               << std::setw(2) << r 
-               << std::setw(2) << g 
-               << std::setw(2) << b;
+    // Fixed-capacity, null-terminated hex color ("#rrggbb" or "#rrggbbaa") returned by value, so formatting
+    // a color needs no heap allocation
+    class HexString {
+      public:
+        static constexpr size_t capacity = 9;
+
+        constexpr HexString() = default;
+
+        constexpr const char *c_str() const { return data_; }
+        constexpr const char *data() const { return data_; }
+        constexpr size_t size() const { return size_; }
+        constexpr std::string_view view() const { return {data_, size_}; }
+        constexpr operator std::string_view() const { return view(); }
+        std::string str() const { return std::string(data_, size_); }
+
+        constexpr bool operator==(std::string_view other) const { return view() == other; }
+
+      private:
+        char data_[capacity + 1] = {};
+        size_t size_ = 0;
+
+        friend struct RGB;
+        friend struct MONO;
+    };
+
+    struct RGB {
+        int r = 0;
+        int g = 0;
+        int b = 0;
+        int a = 255;
+
+        RGB() = default;
+        constexpr RGB(int r_, int g_, int b_, int a_ = 255) : r(r_), g(g_), b(b_), a(a_) {}
+
+        // Parse "#rgb", "#rrggbb" or "#rrggbbaa" (the '#' is optional). Usable in constant expressions;
+        // throws std::invalid_argument on a wrong length or a non-hex digit. Use parse_hex() for input that is
+        // expected to contain bad values.
+        constexpr RGB(std::string_view hex) {
+            int channels[4] = {0, 0, 0, 255};
+            if (detail::parse_hex(hex, channels) != ParseError::Ok) {
+                throw std::invalid_argument("Invalid hex color: '" + std::string(hex) + "'");
+            }
+            r = channels[0];
+            g = channels[1];
+            b = channels[2];
+            a = channels[3];
+        }
+
+        constexpr RGB(const char *hex) : RGB(std::string_view(hex)) {}
+        RGB(const std::string &hex) : RGB(std::string_view(hex)) {}
+
+        // Longest output of write_hex: "#rrggbbaa"
+        static constexpr size_t max_hex_length = HexString::capacity;
+
+        // Writes "#rrggbb" (or "#rrggbbaa" when include_alpha is set and the color is not opaque) to `out`
+        // without a terminator and returns the number of characters written. Channels outside [0, 255]
+        // are clamped.
+        constexpr size_t write_hex(char *out, bool include_alpha = false) const {
+            char *p = out;
+            *p++ = '#';
+            p = detail::write_hex_byte(p, r);
+            p = detail::write_hex_byte(p, g);
+            p = detail::write_hex_byte(p, b);
             if (include_alpha && a != 255) {
-                ss << std::setw(2) << a;
+                p = detail::write_hex_byte(p, a);
             }
-            return ss.str();
+            return static_cast<size_t>(p - out);
+        }
+
+        constexpr HexString hex(bool include_alpha = false) const {
+            HexString out;
+            out.size_ = write_hex(out.data_, include_alpha);
+            return out;
         }
 
+        // Convert to hex string
+        std::string to_hex(bool include_alpha = false) const { return hex(include_alpha).str(); }
+
         // Arithmetic operations
-        RGB operator+(const RGB& other) const {
+        constexpr RGB operator+(const RGB& other) const {
             return RGB(
                 std::clamp(r + other.r, 0, 255),
                 std::clamp(g + other.g, 0, 255),
@@ -71,7 +241,7 @@ namespace pigment {
             );
         }
 
-        RGB operator-(const RGB& other) const {
+        constexpr RGB operator-(const RGB& other) const {
             return RGB(
                 std::clamp(r - other.r, 0, 255),
                 std::clamp(g - other.g, 0, 255),
@@ -80,63 +250,67 @@ namespace pigment {
             );
         }
 
-        RGB operator*(double factor) const {
-            return RGB(
-                std::clamp(static_cast<int>(r * factor), 0, 255),
-                std::clamp(static_cast<int>(g * factor), 0, 255),
-                std::clamp(static_cast<int>(b * factor), 0, 255),
-                a
-            );
+        // Scales in 16.16 fixed point (see detail::fixed_factor), rounding to nearest and clamping to 0-255
+        constexpr RGB operator*(double factor) const {
+            const int64_t f = detail::fixed_factor(factor);
+            return RGB(detail::fixed_scale(r, f), detail::fixed_scale(g, f), detail::fixed_scale(b, f), a);
         }
 
-        RGB& operator+=(const RGB& other) {
+        constexpr RGB& operator+=(const RGB& other) {
             *this = *this + other;
             return *this;
         }
 
-        RGB& operator*=(double factor) {
+        constexpr RGB& operator*=(double factor) {
             *this = *this * factor;
             return *this;
         }
 
-        bool operator==(const RGB& other) const {
+        constexpr bool operator==(const RGB& other) const {
             return r == other.r && g == other.g && b == other.b && a == other.a;
         }
 
-        bool operator!=(const RGB& other) const {
+        constexpr bool operator!=(const RGB& other) const {
             return !(*this == other);
         }
 
         // Brightness adjustment
-        RGB brighten(double factor = 0.2) const { 
+        constexpr RGB brighten(double factor = 0.2) const { 
             return *this * (1.0 + factor); 
         }
         
-        RGB darken(double factor = 0.2) const { 
+        constexpr RGB darken(double factor = 0.2) const { 
             return *this * (1.0 - factor); 
         }
 
-        // Color mixing
-        RGB mix(const RGB& other, double ratio = 0.5) const {
-            ratio = std::clamp(ratio, 0.0, 1.0);
+        // Color mixing, in 16.16 fixed point: the ratio (clamped to [0, 1]) is rounded to a multiple of
+        // 1/65536 and each channel to the nearest integer
+        constexpr RGB mix(const RGB& other, double ratio = 0.5) const {
+            const int64_t w = detail::fixed_ratio(ratio);
             return RGB(
-                static_cast<int>(r * (1 - ratio) + other.r * ratio),
-                static_cast<int>(g * (1 - ratio) + other.g * ratio),
-                static_cast<int>(b * (1 - ratio) + other.b * ratio),
-                static_cast<int>(a * (1 - ratio) + other.a * ratio)
+                detail::fixed_mix(r, other.r, w),
+                detail::fixed_mix(g, other.g, w),
+                detail::fixed_mix(b, other.b, w),
+                detail::fixed_mix(a, other.a, w)
             );
         }
 
         // Luminance calculation (perceived brightness)
-        double luminance() const {
+        constexpr double luminance() const {
             return 0.299 * r + 0.587 * g + 0.114 * b;
         }
 
-        bool is_dark() const { return luminance() < 128; }
-        bool is_light() const { return luminance() >= 128; }
+        // Integer luminance: the same weights in 16.16 fixed point (19595 + 38470 + 7471 = 65536), rounded
+        // to nearest. Gray inputs map to themselves.
+        constexpr int luma() const {
+            return static_cast<int>((19595 * int64_t(r) + 38470 * int64_t(g) + 7471 * int64_t(b) + 32768) >> 16);
+        }
+
+        constexpr bool is_dark() const { return luminance() < 128; }
+        constexpr bool is_light() const { return luminance() >= 128; }
 
         // Color temperature adjustment
-        RGB warm(double factor = 0.1) const {
+        constexpr RGB warm(double factor = 0.1) const {
             factor = std::clamp(factor, 0.0, 1.0);
             return RGB(
                 std::clamp(static_cast<int>(r + 255 * factor * 0.3), 0, 255),
@@ -146,7 +320,7 @@ namespace pigment {
             );
         }
 
-        RGB cool(double factor = 0.1) const {
+        constexpr RGB cool(double factor = 0.1) const {
             factor = std::clamp(factor, 0.0, 1.0);
             return RGB(
                 r,
@@ -157,18 +331,18 @@ namespace pigment {
         }
 
         // Grayscale conversion
-        RGB to_grayscale() const {
-            int gray = static_cast<int>(luminance());
+        constexpr RGB to_grayscale() const {
+            int gray = luma();
             return RGB(gray, gray, gray, a);
         }
 
         // Invert color
-        RGB invert() const {
+        constexpr RGB invert() const {
             return RGB(255 - r, 255 - g, 255 - b, a);
         }
 
         // Contrast adjustment
-        RGB adjust_contrast(double contrast) const {
+        constexpr RGB adjust_contrast(double contrast) const {
             contrast = std::clamp(contrast, -1.0, 1.0);
             double factor = (259.0 * (contrast * 255.0 + 255.0)) / (255.0 * (259.0 - contrast * 255.0));
             
@@ -188,87 +362,131 @@ namespace pigment {
         }
 
         // Predefined colors
-        static RGB black() { return RGB(0, 0, 0); }
-        static RGB white() { return RGB(255, 255, 255); }
-        static RGB red() { return RGB(255, 0, 0); }
-        static RGB green() { return RGB(0, 255, 0); }
-        static RGB blue() { return RGB(0, 0, 255); }
-        static RGB yellow() { return RGB(255, 255, 0); }
-        static RGB cyan() { return RGB(0, 255, 255); }
-        static RGB magenta() { return RGB(255, 0, 255); }
-        static RGB transparent() { return RGB(0, 0, 0, 0); }
+        static constexpr RGB black() { return RGB(0, 0, 0); }
+        static constexpr RGB white() { return RGB(255, 255, 255); }
+        static constexpr RGB red() { return RGB(255, 0, 0); }
+        static constexpr RGB green() { return RGB(0, 255, 0); }
+        static constexpr RGB blue() { return RGB(0, 0, 255); }
+        static constexpr RGB yellow() { return RGB(255, 255, 0); }
+        static constexpr RGB cyan() { return RGB(0, 255, 255); }
+        static constexpr RGB magenta() { return RGB(255, 0, 255); }
+        static constexpr RGB transparent() { return RGB(0, 0, 0, 0); }
     };
 
+    // Non-throwing hex parsing for untrusted input. `out` is only written on success.
+    constexpr ParseError parse_hex(std::string_view hex, RGB &out) noexcept {
+        int channels[4] = {0, 0, 0, 255};
+        ParseError error = detail::parse_hex(hex, channels);
+        if (error == ParseError::Ok) {
+            out = RGB(channels[0], channels[1], channels[2], channels[3]);
+        }
+        return error;
+    }
+
+    // Packed 8-bit-per-channel pixel, 4 bytes per color. Use it for frame buffers and other large
+    // arrays; it converts implicitly to RGB, so every API taking `const RGB &` accepts it directly.
+    struct alignas(4) RGBA8 {
+        uint8_t r = 0;
+        uint8_t g = 0;
+        uint8_t b = 0;
+        uint8_t a = 255;
+
+        RGBA8() = default;
+        constexpr RGBA8(uint8_t r_, uint8_t g_, uint8_t b_, uint8_t a_ = 255) : r(r_), g(g_), b(b_), a(a_) {}
+
+        // Narrowing from RGB clamps each channel into [0, 255], so it is explicit
+        explicit constexpr RGBA8(const RGB &c)
+            : r(static_cast<uint8_t>(std::clamp(c.r, 0, 255))), g(static_cast<uint8_t>(std::clamp(c.g, 0, 255))),
+              b(static_cast<uint8_t>(std::clamp(c.b, 0, 255))), a(static_cast<uint8_t>(std::clamp(c.a, 0, 255))) {}
+
+        // Widening to RGB is lossless
+        constexpr operator RGB() const { return RGB(r, g, b, a); }
+
+        // Bit-cast to/from a packed 32-bit word (byte order r, g, b, a in memory)
+        constexpr uint32_t to_u32() const { return std::bit_cast<uint32_t>(*this); }
+        static constexpr RGBA8 from_u32(uint32_t packed) { return std::bit_cast<RGBA8>(packed); }
+
+        constexpr bool operator==(const RGBA8 &other) const { return to_u32() == other.to_u32(); }
+        constexpr bool operator!=(const RGBA8 &other) const { return !(*this == other); }
+    };
+
+    static_assert(sizeof(RGBA8) == 4, "RGBA8 must be exactly 4 bytes");
+    static_assert(alignof(RGBA8) == 4, "RGBA8 must be 4-byte aligned");
+    static_assert(std::is_trivially_copyable_v<RGBA8>, "RGBA8 must be trivially copyable");
+
     struct MONO {
         int v = 0;
         int a = 255;
 
         MONO() = default;
-        MONO(int v_, int a_ = 255) : v(std::clamp(v_, 0, 255)), a(std::clamp(a_, 0, 255)) {}
+        constexpr MONO(int v_, int a_ = 255) : v(std::clamp(v_, 0, 255)), a(std::clamp(a_, 0, 255)) {}
 
         // Convert from RGB using luminance
-        MONO(const RGB& rgb) : v(static_cast<int>(rgb.luminance())), a(rgb.a) {}
+        constexpr MONO(const RGB& rgb) : v(rgb.luma()), a(rgb.a) {}
 
         // Convert to RGB
-        RGB to_rgb() const {
+        constexpr RGB to_rgb() const {
             return RGB(v, v, v, a);
         }
 
         // Arithmetic operations
-        MONO operator+(const MONO& other) const {
+        constexpr MONO operator+(const MONO& other) const {
             return MONO(std::clamp(v + other.v, 0, 255), a);
         }
 
-        MONO operator-(const MONO& other) const {
+        constexpr MONO operator-(const MONO& other) const {
             return MONO(std::clamp(v - other.v, 0, 255), a);
         }
 
-        MONO operator*(double factor) const {
-            return MONO(std::clamp(static_cast<int>(v * factor), 0, 255), a);
+        // 16.16 fixed point, rounded to nearest like RGB::operator*
+        constexpr MONO operator*(double factor) const {
+            return MONO(detail::fixed_scale(v, detail::fixed_factor(factor)), a);
         }
 
-        bool operator==(const MONO& other) const {
+        constexpr bool operator==(const MONO& other) const {
             return v == other.v && a == other.a;
         }
 
-        bool operator!=(const MONO& other) const {
+        constexpr bool operator!=(const MONO& other) const {
             return !(*this == other);
         }
 
-        bool operator<(const MONO& other) const {
+        constexpr bool operator<(const MONO& other) const {
             return v < other.v;
         }
 
         // Brightness adjustment
-        MONO brighten(double factor = 0.2) const {
+        constexpr MONO brighten(double factor = 0.2) const {
             return *this * (1.0 + factor);
         }
 
-        MONO darken(double factor = 0.2) const {
+        constexpr MONO darken(double factor = 0.2) const {
             return *this * (1.0 - factor);
         }
 
         // Invert
-        MONO invert() const {
+        constexpr MONO invert() const {
             return MONO(255 - v, a);
         }
 
         // Mix with another monochrome color
-        MONO mix(const MONO& other, double ratio = 0.5) const {
-            ratio = std::clamp(ratio, 0.0, 1.0);
-            return MONO(
-                static_cast<int>(v * (1 - ratio) + other.v * ratio),
-                static_cast<int>(a * (1 - ratio) + other.a * ratio)
-            );
+        constexpr MONO mix(const MONO& other, double ratio = 0.5) const {
+            const int64_t w = detail::fixed_ratio(ratio);
+            return MONO(detail::fixed_mix(v, other.v, w), detail::fixed_mix(a, other.a, w));
         }
 
-        // Convert to hex string
-        std::string to_hex() const {
-            std::stringstream ss;
-            ss << "#" << std::hex << std::setfill('0') << std::setw(2) << v;
-            return ss.str();
+        // "#vv", clamped like RGB::write_hex
+        constexpr HexString hex() const {
+            HexString out;
+            out.data_[0] = '#';
+            detail::write_hex_byte(out.data_ + 1, v);
+            out.size_ = 3;
+            return out;
         }
 
+        // Convert to hex string
+        std::string to_hex() const { return hex().str(); }
+
         static MONO random() {
             static std::random_device rd;
             static std::mt19937 gen(rd());
@@ -277,8 +495,18 @@ namespace pigment {
         }
 
         // Predefined values
-        static MONO black() { return MONO(0); }
-        static MONO white() { return MONO(255); }
-        static MONO gray() { return MONO(128); }
+        static constexpr MONO black() { return MONO(0); }
+        static constexpr MONO white() { return MONO(255); }
+        static constexpr MONO gray() { return MONO(128); }
     };
+
+    namespace detail {
+        // Compile-time hex color for library headers, which must not pull the _rgb literal into their namespaces
+        consteval RGB hex_rgb(std::string_view hex) { return RGB(hex); }
+    } // namespace detail
+
+    namespace literals {
+        // "#ff8800"_rgb is always parsed at compile time; a malformed literal does not compile
+        consteval RGB operator""_rgb(const char *hex, size_t length) { return RGB(std::string_view(hex, length)); }
+    } // namespace literals
 } // namespace pigment
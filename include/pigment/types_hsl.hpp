@@ -13,12 +13,12 @@ namespace pigment {
         int a = 255;     // 0-255 alpha
         
         HSL() = default;
-        HSL(double h_, double s_, double l_, int a_ = 255) 
+        constexpr HSL(double h_, double s_, double l_, int a_ = 255) 
             : h(h_), s(s_), l(l_), a(a_) {
             normalize();
         }
         
-        void normalize() {
+        constexpr void normalize() {
             // Wrap hue to [0, 360)
             while (h >= 360.0) h -= 360.0;
             while (h < 0.0) h += 360.0;
@@ -30,106 +30,105 @@ namespace pigment {
         }
         
         // Convert from RGB
-        static HSL fromRGB(const RGB& rgb) {
-            double r = rgb.r / 255.0;
-            double g = rgb.g / 255.0;
-            double b = rgb.b / 255.0;
+        static constexpr HSL fromRGB(const RGB& rgb) {
+            HSL hsl;
+            from_channels(rgb.r, rgb.g, rgb.b, hsl.h, hsl.s, hsl.l);
+            hsl.a = std::clamp(rgb.a, 0, 255);
+            return hsl;
+        }
+        
+        // Convert to RGB
+        constexpr RGB to_rgb() const {
+            int r, g, b;
+            to_channels(h, s, l, r, g, b);
+            return RGB(r, g, b, a);
+        }
+        
+        // Per-pixel kernels shared by fromRGB/to_rgb and the bulk converters in pixel_buffer.hpp.
+        // Every branch is a select on values computed unconditionally, so loops over planes vectorize.
+        static constexpr void from_channels(int red, int green, int blue, double &h, double &s, double &l) {
+            double r = red / 255.0;
+            double g = green / 255.0;
+            double b = blue / 255.0;
             
-            double max_val = std::max({r, g, b});
-            double min_val = std::min({r, g, b});
+            double max_val = std::max(std::max(r, g), b);
+            double min_val = std::min(std::min(r, g), b);
             double delta = max_val - min_val;
-            
-            HSL hsl;
+            bool achromatic = delta == 0;
+            double safe_delta = achromatic ? 1.0 : delta;
             
             // Lightness
-            hsl.l = (max_val + min_val) / 2.0;
+            l = (max_val + min_val) / 2.0;
             
-            if (delta == 0) {
-                hsl.h = hsl.s = 0; // achromatic
-            } else {
-                // Saturation
-                hsl.s = hsl.l > 0.5 ? delta / (2.0 - max_val - min_val) : delta / (max_val + min_val);
-                
-                // Hue
-                if (max_val == r) {
-                    hsl.h = (g - b) / delta + (g < b ? 6 : 0);
-                } else if (max_val == g) {
-                    hsl.h = (b - r) / delta + 2;
-                } else {
-                    hsl.h = (r - g) / delta + 4;
-                }
-                hsl.h /= 6;
-            }
-            hsl.h *= 360;
-            hsl.a = rgb.a;
-            hsl.normalize();
+            // Saturation
+            double s_light = delta / (achromatic ? 1.0 : 2.0 - max_val - min_val);
+            double s_dark = delta / (achromatic ? 1.0 : max_val + min_val);
+            s = achromatic ? 0.0 : (l > 0.5 ? s_light : s_dark);
             
-            return hsl;
+            // Hue
+            double h_r = (g - b) / safe_delta + (g < b ? 6 : 0);
+            double h_g = (b - r) / safe_delta + 2;
+            double h_b = (r - g) / safe_delta + 4;
+            h = achromatic ? 0.0 : (max_val == r ? h_r : (max_val == g ? h_g : h_b)) / 6;
+            h *= 360;
+            
+            // Same wrapping and clamping as normalize()
+            h = h >= 360.0 ? h - 360.0 : h;
+            s = std::clamp(s, 0.0, 1.0);
+            l = std::clamp(l, 0.0, 1.0);
         }
         
-        // Convert to RGB
-        RGB to_rgb() const {
-            if (s == 0) {
-                int val = static_cast<int>(l * 255);
-                return RGB(val, val, val, a);
-            }
-            
+        static constexpr void to_channels(double h, double s, double l, int &r, int &g, int &b) {
             auto hue_to_rgb = [](double p, double q, double t) {
-                if (t < 0) t += 1;
-                if (t > 1) t -= 1;
-                if (t < 1.0/6) return p + (q - p) * 6 * t;
-                if (t < 1.0/2) return q;
-                if (t < 2.0/3) return p + (q - p) * (2.0/3 - t) * 6;
-                return p;
+                t = t < 0 ? t + 1 : t;
+                t = t > 1 ? t - 1 : t;
+                double rising = p + (q - p) * 6 * t;
+                double falling = p + (q - p) * (2.0/3 - t) * 6;
+                return t < 1.0/6 ? rising : (t < 1.0/2 ? q : (t < 2.0/3 ? falling : p));
             };
             
             double q = l < 0.5 ? l * (1 + s) : l + s - l * s;
             double p = 2 * l - q;
             double h_norm = h / 360.0;
             
-            double r = hue_to_rgb(p, q, h_norm + 1.0/3);
-            double g = hue_to_rgb(p, q, h_norm);
-            double b = hue_to_rgb(p, q, h_norm - 1.0/3);
-            
-            return RGB(
-                static_cast<int>(std::round(r * 255)),
-                static_cast<int>(std::round(g * 255)),
-                static_cast<int>(std::round(b * 255)),
-                a
-            );
+            int gray = static_cast<int>(l * 255);
+            bool achromatic = s == 0;
+            r = achromatic ? gray : static_cast<int>(detail::round(hue_to_rgb(p, q, h_norm + 1.0/3) * 255));
+            g = achromatic ? gray : static_cast<int>(detail::round(hue_to_rgb(p, q, h_norm) * 255));
+            b = achromatic ? gray : static_cast<int>(detail::round(hue_to_rgb(p, q, h_norm - 1.0/3) * 255));
         }
         
         // Color adjustments
-        HSL adjust_hue(double degrees) const {
+        constexpr HSL adjust_hue(double degrees) const {
             return HSL(h + degrees, s, l, a);
         }
         
-        HSL adjust_saturation(double factor) const {
+        constexpr HSL adjust_saturation(double factor) const {
             return HSL(h, s * factor, l, a);
         }
         
-        HSL adjust_lightness(double factor) const {
+        constexpr HSL adjust_lightness(double factor) const {
             return HSL(h, s, l * factor, a);
         }
         
-        HSL saturate(double amount = 0.1) const {
+        constexpr HSL saturate(double amount = 0.1) const {
             return HSL(h, std::clamp(s + amount, 0.0, 1.0), l, a);
         }
         
-        HSL desaturate(double amount = 0.1) const {
+        constexpr HSL desaturate(double amount = 0.1) const {
             return HSL(h, std::clamp(s - amount, 0.0, 1.0), l, a);
         }
         
-        HSL lighten(double amount = 0.1) const {
+        constexpr HSL lighten(double amount = 0.1) const {
             return HSL(h, s, std::clamp(l + amount, 0.0, 1.0), a);
         }
         
-        HSL darken(double amount = 0.1) const {
+        constexpr HSL darken(double amount = 0.1) const {
             return HSL(h, s, std::clamp(l - amount, 0.0, 1.0), a);
         }
         
         // Complementary color
-        HSL complement() const {
+        constexpr HSL complement() const {
             return adjust_hue(180.0);
         }
         
@@ -13,13 +13,13 @@ namespace pigment {
         float v = 0.0f;
 
         HSV() = default;
-        HSV(float h_, float s_, float v_) : h(h_), s(s_), v(v_) { normalize(); }
+        constexpr HSV(float h_, float s_, float v_) : h(h_), s(s_), v(v_) { normalize(); }
 
         // Clamp fields into valid ranges
-        void normalize() {
+        constexpr void normalize() {
             // wrap hue into [0,360)
             if (h < 0.0f || h >= 360.0f) {
-                h = std::fmod(h, 360.0f);
+                h = detail::fmod(h, 360.0f);
                 if (h < 0.0f)
                     h += 360.0f;
             }
@@ -28,83 +28,67 @@ namespace pigment {
         }
 
         // Create HSV from an RGB (alpha ignored)
-        static HSV fromRGB(const RGB &c) {
-            float rf = c.r / 255.0f;
-            float gf = c.g / 255.0f;
-            float bf = c.b / 255.0f;
+        static constexpr HSV fromRGB(const RGB &c) {
+            HSV out;
+            from_channels(c.r, c.g, c.b, out.h, out.s, out.v);
+            return out;
+        }
 
-            float mx = std::max({rf, gf, bf});
-            float mn = std::min({rf, gf, bf});
-            float delta = mx - mn;
+        // Convert this HSV to RGB (alpha = 255)
+        constexpr RGB toRGB() const {
+            RGB out;
+            to_channels(h, s, v, out.r, out.g, out.b);
+            out.a = 255;
+            return out;
+        }
 
-            HSV out;
+        // Per-pixel kernels shared by fromRGB/toRGB and the bulk converters in pixel_buffer.hpp.
+        // Written as selects over unconditionally computed values so loops over planes vectorize.
+        static constexpr void from_channels(int r, int g, int b, float &h, float &s, float &v) {
+            float rf = r / 255.0f;
+            float gf = g / 255.0f;
+            float bf = b / 255.0f;
 
-            // Hue calculation
-            if (delta < 1e-6f) {
-                out.h = 0.0f;
-            } else if (mx == rf) {
-                out.h = 60.0f * std::fmod((gf - bf) / delta, 6.0f);
-            } else if (mx == gf) {
-                out.h = 60.0f * (((bf - rf) / delta) + 2.0f);
-            } else {
-                out.h = 60.0f * (((rf - gf) / delta) + 4.0f);
-            }
-            if (out.h < 0)
-                out.h += 360.0f;
+            float mx = std::max(std::max(rf, gf), bf);
+            float mn = std::min(std::min(rf, gf), bf);
+            float delta = mx - mn;
+            bool achromatic = delta < 1e-6f;
+            float safe_delta = achromatic ? 1.0f : delta;
 
-            // Saturation & Value
-            out.s = (mx < 1e-6f ? 0.0f : (delta / mx));
-            out.v = mx;
+            // Hue calculation; (gf - bf) / delta already lies in [-1, 1], so no fmod is needed
+            float h_r = 60.0f * ((gf - bf) / safe_delta);
+            float h_g = 60.0f * (((bf - rf) / safe_delta) + 2.0f);
+            float h_b = 60.0f * (((rf - gf) / safe_delta) + 4.0f);
+            h = achromatic ? 0.0f : (mx == rf ? h_r : (mx == gf ? h_g : h_b));
+            h = h < 0 ? h + 360.0f : h;
+            h = h >= 360.0f ? h - 360.0f : h;
 
-            out.normalize();
-            return out;
+            // Saturation & Value
+            s = std::clamp(mx < 1e-6f ? 0.0f : (delta / (mx < 1e-6f ? 1.0f : mx)), 0.0f, 1.0f);
+            v = std::clamp(mx, 0.0f, 1.0f);
         }
 
-        // Convert this HSV to RGB (alpha = 255)
-        RGB toRGB() const {
+        // Expects a normalized hue in [0,360)
+        static constexpr void to_channels(float h, float s, float v, int &r, int &g, int &b) {
             float C = v * s;
-            float X = C * (1 - std::fabs(std::fmod(h / 60.0f, 2.0f) - 1));
+            float sector = h / 60.0f;
+            float X = C * (1 - detail::fabs(sector - 2.0f * detail::floor(sector * 0.5f) - 1));
             float m = v - C;
 
-            float rp, gp, bp;
-            if (h < 60.0f) {
-                rp = C;
-                gp = X;
-                bp = 0;
-            } else if (h < 120.0f) {
-                rp = X;
-                gp = C;
-                bp = 0;
-            } else if (h < 180.0f) {
-                rp = 0;
-                gp = C;
-                bp = X;
-            } else if (h < 240.0f) {
-                rp = 0;
-                gp = X;
-                bp = C;
-            } else if (h < 300.0f) {
-                rp = X;
-                gp = 0;
-                bp = C;
-            } else {
-                rp = C;
-                gp = 0;
-                bp = X;
-            }
+            float rp = (h < 60.0f || h >= 300.0f) ? C : ((h < 120.0f || h >= 240.0f) ? X : 0.0f);
+            float gp = (h >= 60.0f && h < 180.0f) ? C : (h < 240.0f ? X : 0.0f);
+            float bp = h < 120.0f ? 0.0f : ((h >= 180.0f && h < 300.0f) ? C : X);
 
-            RGB out;
-            out.r = int(std::round((rp + m) * 255));
-            out.g = int(std::round((gp + m) * 255));
-            out.b = int(std::round((bp + m) * 255));
-            out.a = 255;
-            return out;
+            r = int(detail::round((rp + m) * 255));
+            g = int(detail::round((gp + m) * 255));
+            b = int(detail::round((bp + m) * 255));
         }
+
         // delta in [-1,1]:
         //   0 = no change
         //  -1 = full dark (v→0)
         //  +1 = full bright (v→1)
-        inline void adjustBrightness(float delta) {
+        constexpr void adjustBrightness(float delta) {
             delta = std::clamp(delta, -1.0f, 1.0f);
             if (delta > 0.0f) {
                 // move v toward 1.0
@@ -119,7 +103,7 @@ namespace pigment {
         //   0 = no change
         //  -1 = full desaturate (s→0)
         //  +1 = full saturate   (s→1)
-        inline void adjustSaturation(float delta) {
+        constexpr void adjustSaturation(float delta) {
             delta = std::clamp(delta, -1.0f, 1.0f);
             if (delta > 0.0f) {
                 // move s toward 1.0
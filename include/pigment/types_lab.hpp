@@ -1,5 +1,6 @@
 #pragma once
 
+#include "transfer.hpp"
 #include "types_basic.hpp"
 #include <algorithm>
 #include <cmath>
@@ -13,21 +14,33 @@ namespace pigment {
         int alpha = 255; // alpha channel 0-255
         
         LAB() = default;
-        LAB(double l_, double a_, double b_, int alpha_ = 255) 
+        constexpr LAB(double l_, double a_, double b_, int alpha_ = 255) 
             : l(l_), a(a_), b(b_), alpha(alpha_) {}
         
         // Convert from RGB using D65 illuminant
         static LAB fromRGB(const RGB& rgb) {
-            // First convert RGB to XYZ
-            double r = rgb.r / 255.0;
-            double g = rgb.g / 255.0;
-            double b = rgb.b / 255.0;
-            
-            // Apply gamma correction
-            r = (r > 0.04045) ? std::pow((r + 0.055) / 1.055, 2.4) : r / 12.92;
-            g = (g > 0.04045) ? std::pow((g + 0.055) / 1.055, 2.4) : g / 12.92;
-            b = (b > 0.04045) ? std::pow((b + 0.055) / 1.055, 2.4) : b / 12.92;
-            
+            LAB lab;
+            from_channels(rgb.r, rgb.g, rgb.b, lab.l, lab.a, lab.b);
+            lab.alpha = rgb.a;
+            return lab;
+        }
+        
+        // Convert to RGB
+        RGB to_rgb() const {
+            int red, green, blue;
+            to_channels(l, a, b, red, green, blue);
+            return RGB(red, green, blue, alpha);
+        }
+        
+        // Per-pixel kernels shared by fromRGB/to_rgb and the bulk converters in pixel_buffer.hpp
+        static void from_channels(int red, int green, int blue, double &l_out, double &a_out, double &b_out) {
+            // Linearize through the transfer-function table
+            from_linear(transfer::srgb_to_linear(red), transfer::srgb_to_linear(green),
+                        transfer::srgb_to_linear(blue), l_out, a_out, b_out);
+        }
+        
+        // Linear-light sRGB (0-1 per channel) to LAB; also used to sample continuous RGB, e.g. LUT nodes
+        static void from_linear(double r, double g, double b, double &l_out, double &a_out, double &b_out) {
             // Convert to XYZ using sRGB matrix
             double x = r * 0.4124564 + g * 0.3575761 + b * 0.1804375;
             double y = r * 0.2126729 + g * 0.7151522 + b * 0.0721750;
@@ -40,24 +53,19 @@ namespace pigment {
             
             // Convert XYZ to LAB
             auto f = [](double t) {
-                return (t > 0.008856) ? std::pow(t, 1.0/3.0) : (7.787 * t + 16.0/116.0);
+                return (t > 0.008856) ? transfer::fast_cbrt(t) : (7.787 * t + 16.0/116.0);
             };
             
             double fx = f(x);
             double fy = f(y);
             double fz = f(z);
             
-            LAB lab;
-            lab.l = 116.0 * fy - 16.0;
-            lab.a = 500.0 * (fx - fy);
-            lab.b = 200.0 * (fy - fz);
-            lab.alpha = rgb.a;
-            
-            return lab;
+            l_out = 116.0 * fy - 16.0;
+            a_out = 500.0 * (fx - fy);
+            b_out = 200.0 * (fy - fz);
         }
         
-        // Convert to RGB
-        RGB to_rgb() const {
+        static void to_channels(double l, double a, double b, int &r_out, int &g_out, int &b_out) {
             // Convert LAB to XYZ
             double fy = (l + 16.0) / 116.0;
             double fx = a / 500.0 + fy;
@@ -75,19 +83,16 @@ namespace pigment {
             // Convert XYZ to RGB
             double r = x * 3.2404542 + y * -1.5371385 + z * -0.4985314;
             double g = x * -0.9692660 + y * 1.8760108 + z * 0.0415560;
-            double b = x * 0.0556434 + y * -0.2040259 + z * 1.0572252;
+            double bl = x * 0.0556434 + y * -0.2040259 + z * 1.0572252;
             
             // Apply inverse gamma correction
-            r = (r > 0.0031308) ? 1.055 * std::pow(r, 1.0/2.4) - 0.055 : 12.92 * r;
-            g = (g > 0.0031308) ? 1.055 * std::pow(g, 1.0/2.4) - 0.055 : 12.92 * g;
-            b = (b > 0.0031308) ? 1.055 * std::pow(b, 1.0/2.4) - 0.055 : 12.92 * b;
+            r = transfer::linear_to_srgb(r);
+            g = transfer::linear_to_srgb(g);
+            bl = transfer::linear_to_srgb(bl);
             
-            return RGB(
-                std::clamp(static_cast<int>(std::round(r * 255)), 0, 255),
-                std::clamp(static_cast<int>(std::round(g * 255)), 0, 255),
-                std::clamp(static_cast<int>(std::round(b * 255)), 0, 255),
-                alpha
-            );
+            r_out = std::clamp(static_cast<int>(std::round(r * 255)), 0, 255);
+            g_out = std::clamp(static_cast<int>(std::round(g * 255)), 0, 255);
+            b_out = std::clamp(static_cast<int>(std::round(bl * 255)), 0, 255);
         }
         
         // Calculate Delta E (color difference) - CIE76 formula
@@ -98,24 +103,79 @@ namespace pigment {
             return std::sqrt(dl*dl + da*da + db*db);
         }
         
-        // More accurate Delta E 2000 calculation
-        double delta_e_2000(const LAB& other) const {
-            // Simplified implementation - full CIE Delta E 2000 is quite complex
+        // CIE94 color difference with this color as the reference (the formula is not symmetric). The
+        // defaults are the graphic-arts weights; textiles use kL = 2, k1 = 0.048, k2 = 0.014.
+        double delta_e_94(const LAB& other, double kL = 1.0, double k1 = 0.045, double k2 = 0.015) const {
             double dl = l - other.l;
-            double da = a - other.a;
-            double db = b - other.b;
-            
             double c1 = std::sqrt(a*a + b*b);
             double c2 = std::sqrt(other.a*other.a + other.b*other.b);
             double dc = c1 - c2;
-            
-            double dh = std::sqrt(da*da + db*db - dc*dc);
-            
-            double sl = 1.0;
-            double sc = 1.0 + 0.045 * c1;
-            double sh = 1.0 + 0.015 * c1;
-            
-            return std::sqrt((dl/sl)*(dl/sl) + (dc/sc)*(dc/sc) + (dh/sh)*(dh/sh));
+            double da = a - other.a;
+            double db = b - other.b;
+            // Hue difference squared; rounding can push it slightly below zero
+            double dh2 = std::max(0.0, da*da + db*db - dc*dc);
+            double sc = 1.0 + k1 * c1;
+            double sh = 1.0 + k2 * c1;
+            return std::sqrt((dl / kL) * (dl / kL) + (dc / sc) * (dc / sc) + dh2 / (sh * sh));
+        }
+        
+        // CIEDE2000 color difference (CIE 142-2001), following Sharma, Wu and Dalal (2005). kL, kC and kH are
+        // the parametric weights for lightness, chroma and hue; 1 is the reference condition.
+        double delta_e_2000(const LAB& other, double kL = 1.0, double kC = 1.0, double kH = 1.0) const {
+            constexpr double pi = 3.14159265358979323846;
+            constexpr double deg = 180.0 / pi;
+            constexpr double pow25_7 = 6103515625.0; // 25^7
+            auto pow7 = [](double x) { double x2 = x * x; return x2 * x2 * x2 * x; };
+            
+            // Chroma-dependent a* rescaling
+            double c_mean = (std::sqrt(a*a + b*b) + std::sqrt(other.a*other.a + other.b*other.b)) / 2.0;
+            double g = 0.5 * (1.0 - std::sqrt(pow7(c_mean) / (pow7(c_mean) + pow25_7)));
+            double a1 = (1.0 + g) * a;
+            double a2 = (1.0 + g) * other.a;
+            double c1 = std::sqrt(a1*a1 + b*b);
+            double c2 = std::sqrt(a2*a2 + other.b*other.b);
+            auto hue = [&](double y, double x) {
+                double h = std::atan2(y, x) * deg;
+                return h < 0.0 ? h + 360.0 : h;
+            };
+            double h1 = hue(b, a1);
+            double h2 = hue(other.b, a2);
+            
+            // Differences; the hue difference takes the short way around the circle
+            double dl = other.l - l;
+            double dc = c2 - c1;
+            double dh = 0.0;
+            if (c1 * c2 != 0.0) {
+                dh = h2 - h1;
+                if (dh > 180.0) dh -= 360.0;
+                else if (dh < -180.0) dh += 360.0;
+            }
+            double dh_big = 2.0 * std::sqrt(c1 * c2) * std::sin(dh / 2.0 / deg);
+            
+            // Means; the mean hue is also taken the short way around
+            double l_mean = (l + other.l) / 2.0;
+            double c_mean_p = (c1 + c2) / 2.0;
+            double h_mean = h1 + h2;
+            if (c1 * c2 != 0.0) {
+                if (std::fabs(h1 - h2) <= 180.0) h_mean = (h1 + h2) / 2.0;
+                else if (h1 + h2 < 360.0) h_mean = (h1 + h2 + 360.0) / 2.0;
+                else h_mean = (h1 + h2 - 360.0) / 2.0;
+            }
+            
+            double t = 1.0 - 0.17 * std::cos((h_mean - 30.0) / deg) + 0.24 * std::cos(2.0 * h_mean / deg) +
+                       0.32 * std::cos((3.0 * h_mean + 6.0) / deg) - 0.20 * std::cos((4.0 * h_mean - 63.0) / deg);
+            double d_theta = 30.0 * std::exp(-((h_mean - 275.0) / 25.0) * ((h_mean - 275.0) / 25.0));
+            double rc = 2.0 * std::sqrt(pow7(c_mean_p) / (pow7(c_mean_p) + pow25_7));
+            double l50 = (l_mean - 50.0) * (l_mean - 50.0);
+            double sl = 1.0 + 0.015 * l50 / std::sqrt(20.0 + l50);
+            double sc = 1.0 + 0.045 * c_mean_p;
+            double sh = 1.0 + 0.015 * c_mean_p * t;
+            double rt = -std::sin(2.0 * d_theta / deg) * rc;
+            
+            double tl = dl / (kL * sl);
+            double tc = dc / (kC * sc);
+            double th = dh_big / (kH * sh);
+            return std::sqrt(tl*tl + tc*tc + th*th + rt * tc * th);
         }
         
         // Check if two colors are perceptually similar
@@ -124,12 +184,12 @@ namespace pigment {
         }
         
         // Adjust lightness
-        LAB adjust_lightness(double amount) const {
+        constexpr LAB adjust_lightness(double amount) const {
             return LAB(std::clamp(l + amount, 0.0, 100.0), a, b, alpha);
         }
         
         // Mix two LAB colors
-        LAB mix(const LAB& other, double ratio = 0.5) const {
+        constexpr LAB mix(const LAB& other, double ratio = 0.5) const {
             ratio = std::clamp(ratio, 0.0, 1.0);
             return LAB(
                 l * (1 - ratio) + other.l * ratio,
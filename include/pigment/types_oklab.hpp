@@ -0,0 +1,191 @@
+#pragma once
+
+#include "transfer.hpp"
+#include "types_basic.hpp"
+#include "types_lab.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace pigment {
+
+    // Oklab (Björn Ottosson, 2020): a perceptual space built from linear sRGB with one 3x3 matrix, a cube
+    // root per channel and a second matrix. It is cheaper than CIE LAB (no D65 scaling or piecewise f(t))
+    // and interpolates more evenly, especially for blues. L is 0-1; a and b are roughly -0.4 to 0.4.
+    struct OKLAB {
+        double l = 0.0;  // lightness 0-1
+        double a = 0.0;  // green-red
+        double b = 0.0;  // blue-yellow
+        int alpha = 255; // alpha channel 0-255
+
+        OKLAB() = default;
+        constexpr OKLAB(double l_, double a_, double b_, int alpha_ = 255)
+            : l(l_), a(a_), b(b_), alpha(alpha_) {}
+
+        static OKLAB fromRGB(const RGB& rgb) {
+            OKLAB lab;
+            from_channels(rgb.r, rgb.g, rgb.b, lab.l, lab.a, lab.b);
+            lab.alpha = rgb.a;
+            return lab;
+        }
+
+        RGB to_rgb() const {
+            int red, green, blue;
+            to_channels(l, a, b, red, green, blue);
+            return RGB(red, green, blue, alpha);
+        }
+
+        // From CIE LAB (D65) through XYZ, without rounding to 8-bit RGB on the way
+        static OKLAB fromLAB(const LAB& lab) {
+            double fy = (lab.l + 16.0) / 116.0;
+            double fx = lab.a / 500.0 + fy;
+            double fz = fy - lab.b / 200.0;
+            auto f_inv = [](double t) {
+                double t3 = t * t * t;
+                return (t3 > 0.008856) ? t3 : (t - 16.0/116.0) / 7.787;
+            };
+            double x = f_inv(fx) * 0.95047;
+            double y = f_inv(fy);
+            double z = f_inv(fz) * 1.08883;
+            OKLAB out;
+            from_linear(x * 3.2404542 + y * -1.5371385 + z * -0.4985314,
+                        x * -0.9692660 + y * 1.8760108 + z * 0.0415560,
+                        x * 0.0556434 + y * -0.2040259 + z * 1.0572252, out.l, out.a, out.b);
+            out.alpha = lab.alpha;
+            return out;
+        }
+
+        // Per-pixel kernels shared by fromRGB/to_rgb and the bulk converters in pixel_buffer.hpp
+        static void from_channels(int red, int green, int blue, double &l_out, double &a_out, double &b_out) {
+            from_linear(transfer::srgb_to_linear(red), transfer::srgb_to_linear(green),
+                        transfer::srgb_to_linear(blue), l_out, a_out, b_out);
+        }
+
+        // Linear-light sRGB (0-1 per channel) to Oklab
+        static void from_linear(double r, double g, double b, double &l_out, double &a_out, double &b_out) {
+            double l = transfer::fast_cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+            double m = transfer::fast_cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+            double s = transfer::fast_cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+
+            l_out = 0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s;
+            a_out = 1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s;
+            b_out = 0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s;
+        }
+
+        // Oklab to linear-light sRGB, unclamped
+        static void to_linear(double l, double a, double b, double &r_out, double &g_out, double &b_out) {
+            double l_ = l + 0.3963377774 * a + 0.2158037573 * b;
+            double m_ = l - 0.1055613458 * a - 0.0638541728 * b;
+            double s_ = l - 0.0894841775 * a - 1.2914855480 * b;
+            l_ = l_ * l_ * l_;
+            m_ = m_ * m_ * m_;
+            s_ = s_ * s_ * s_;
+
+            r_out = 4.0767416621 * l_ - 3.3077115913 * m_ + 0.2309699292 * s_;
+            g_out = -1.2684380046 * l_ + 2.6097574011 * m_ - 0.3413193965 * s_;
+            b_out = -0.0041960863 * l_ - 0.7034186147 * m_ + 1.7076147010 * s_;
+        }
+
+        static void to_channels(double l, double a, double b, int &r_out, int &g_out, int &b_out) {
+            double r, g, bl;
+            to_linear(l, a, b, r, g, bl);
+            r_out = std::clamp(static_cast<int>(std::round(transfer::linear_to_srgb(r) * 255)), 0, 255);
+            g_out = std::clamp(static_cast<int>(std::round(transfer::linear_to_srgb(g) * 255)), 0, 255);
+            b_out = std::clamp(static_cast<int>(std::round(transfer::linear_to_srgb(bl) * 255)), 0, 255);
+        }
+
+        // Euclidean distance (delta E OK). On the 0-1 lightness scale, so about 1/100 of CIE76 values.
+        double distance(const OKLAB& other) const {
+            double dl = l - other.l;
+            double da = a - other.a;
+            double db = b - other.b;
+            return std::sqrt(dl*dl + da*da + db*db);
+        }
+
+        constexpr OKLAB mix(const OKLAB& other, double ratio = 0.5) const {
+            ratio = ratio > 0.0 ? std::min(ratio, 1.0) : 0.0; // NaN mixes to this color
+            return OKLAB(
+                l * (1 - ratio) + other.l * ratio,
+                a * (1 - ratio) + other.a * ratio,
+                b * (1 - ratio) + other.b * ratio,
+                static_cast<int>(alpha * (1 - ratio) + other.alpha * ratio)
+            );
+        }
+    };
+
+    // Oklab in polar form: lightness, chroma and hue (degrees)
+    struct OKLCH {
+        double l = 0.0;  // lightness 0-1
+        double c = 0.0;  // chroma, 0 to about 0.37 inside sRGB
+        double h = 0.0;  // hue 0-360 degrees
+        int alpha = 255; // alpha channel 0-255
+
+        OKLCH() = default;
+        constexpr OKLCH(double l_, double c_, double h_, int alpha_ = 255)
+            : l(l_), c(c_), h(h_), alpha(alpha_) {}
+
+        static OKLCH fromOKLAB(const OKLAB& lab) {
+            OKLCH lch;
+            from_oklab(lab.l, lab.a, lab.b, lch.l, lch.c, lch.h);
+            lch.alpha = lab.alpha;
+            return lch;
+        }
+
+        OKLAB to_oklab() const {
+            OKLAB lab;
+            to_oklab(l, c, h, lab.l, lab.a, lab.b);
+            lab.alpha = alpha;
+            return lab;
+        }
+
+        static OKLCH fromRGB(const RGB& rgb) { return fromOKLAB(OKLAB::fromRGB(rgb)); }
+
+        RGB to_rgb() const { return to_oklab().to_rgb(); }
+
+        static void from_oklab(double l, double a, double b, double &l_out, double &c_out, double &h_out) {
+            constexpr double deg = 180.0 / 3.14159265358979323846;
+            l_out = l;
+            c_out = std::sqrt(a * a + b * b);
+            double h = std::atan2(b, a) * deg;
+            h_out = h < 0.0 ? h + 360.0 : h;
+        }
+
+        static void to_oklab(double l, double c, double h, double &l_out, double &a_out, double &b_out) {
+            constexpr double rad = 3.14159265358979323846 / 180.0;
+            l_out = l;
+            a_out = c * std::cos(h * rad);
+            b_out = c * std::sin(h * rad);
+        }
+
+        // Per-pixel kernels for the bulk converters in pixel_buffer.hpp
+        static void from_channels(int red, int green, int blue, double &l_out, double &c_out, double &h_out) {
+            double l, a, b;
+            OKLAB::from_channels(red, green, blue, l, a, b);
+            from_oklab(l, a, b, l_out, c_out, h_out);
+        }
+
+        static void to_channels(double l, double c, double h, int &r_out, int &g_out, int &b_out) {
+            double lab_l, lab_a, lab_b;
+            to_oklab(l, c, h, lab_l, lab_a, lab_b);
+            OKLAB::to_channels(lab_l, lab_a, lab_b, r_out, g_out, b_out);
+        }
+
+        // Interpolate along the shorter hue arc. An achromatic end takes the other end's hue.
+        OKLCH mix(const OKLCH& other, double ratio = 0.5) const {
+            ratio = ratio > 0.0 ? std::min(ratio, 1.0) : 0.0; // NaN mixes to this color
+            double h1 = c > 0.0 ? h : other.h;
+            double h2 = other.c > 0.0 ? other.h : h1;
+            double dh = h2 - h1;
+            if (dh > 180.0) dh -= 360.0;
+            else if (dh < -180.0) dh += 360.0;
+            double hue = h1 + dh * ratio;
+            hue = hue < 0.0 ? hue + 360.0 : (hue >= 360.0 ? hue - 360.0 : hue);
+            return OKLCH(
+                l * (1 - ratio) + other.l * ratio,
+                c * (1 - ratio) + other.c * ratio,
+                hue,
+                static_cast<int>(alpha * (1 - ratio) + other.alpha * ratio)
+            );
+        }
+    };
+
+} // namespace pigment
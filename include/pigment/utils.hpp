@@ -1,106 +1,23 @@
 #pragma once
 
+#include "color_blindness.hpp"
+#include "contrast.hpp"
+#include "distance.hpp"
+#include "execution.hpp"
+#include "palette_index.hpp"
+#include "quantizer.hpp"
+#include "sort.hpp"
 #include "types_basic.hpp"
 #include "types_hsl.hpp"
 #include "types_lab.hpp"
 #include <algorithm>
 #include <cmath>
+#include <memory>
 #include <vector>
 
 namespace pigment {
     namespace utils {
 
-        // Color blindness simulation
-        struct ColorBlindness {
-            enum Type {
-                PROTANOPIA,    // Red blind
-                DEUTERANOPIA,  // Green blind
-                TRITANOPIA,    // Blue blind
-                PROTANOMALY,   // Red weak
-                DEUTERANOMALY, // Green weak
-                TRITANOMALY    // Blue weak
-            };
-
-            static RGB simulate(const RGB &color, Type type) {
-                // Simplified simulation using transformation matrices
-                double r = color.r / 255.0;
-                double g = color.g / 255.0;
-                double b = color.b / 255.0;
-
-                double nr, ng, nb;
-
-                switch (type) {
-                case PROTANOPIA:
-                    nr = 0.567 * r + 0.433 * g;
-                    ng = 0.558 * r + 0.442 * g;
-                    nb = 0.242 * g + 0.758 * b;
-                    break;
-                case DEUTERANOPIA:
-                    nr = 0.625 * r + 0.375 * g;
-                    ng = 0.7 * r + 0.3 * g;
-                    nb = 0.3 * g + 0.7 * b;
-                    break;
-                case TRITANOPIA:
-                    nr = 0.95 * r + 0.05 * g;
-                    ng = 0.433 * g + 0.567 * b;
-                    nb = 0.475 * g + 0.525 * b;
-                    break;
-                default: // For anomalies, use a lighter version of the respective type
-                    return simulate(color, static_cast<Type>(type - 3)).mix(color, 0.5);
-                }
-
-                return RGB(std::clamp(static_cast<int>(nr * 255), 0, 255),
-                           std::clamp(static_cast<int>(ng * 255), 0, 255),
-                           std::clamp(static_cast<int>(nb * 255), 0, 255), color.a);
-            }
-        };
-
-        // Contrast calculation
-        inline double contrast_ratio(const RGB &color1, const RGB &color2) {
-            double lum1 = color1.luminance() / 255.0;
-            double lum2 = color2.luminance() / 255.0;
-
-            // Ensure lum1 is the lighter color
-            if (lum1 < lum2)
-                std::swap(lum1, lum2);
-
-            return (lum1 + 0.05) / (lum2 + 0.05);
-        }
-
-        // Check WCAG accessibility compliance
-        struct AccessibilityLevel {
-            enum Level {
-                FAIL,
-                AA_NORMAL,  // 4.5:1
-                AA_LARGE,   // 3:1 for large text
-                AAA_NORMAL, // 7:1
-                AAA_LARGE   // 4.5:1 for large text
-            };
-        };
-
-        inline AccessibilityLevel::Level check_accessibility(const RGB &foreground, const RGB &background,
-                                                             bool large_text = false) {
-            double ratio = contrast_ratio(foreground, background);
-
-            if (ratio >= 7.0)
-                return AccessibilityLevel::AAA_NORMAL;
-            if (ratio >= 4.5) {
-                return large_text ? AccessibilityLevel::AAA_LARGE : AccessibilityLevel::AA_NORMAL;
-            }
-            if (ratio >= 3.0 && large_text)
-                return AccessibilityLevel::AA_LARGE;
-
-            return AccessibilityLevel::FAIL;
-        }
-
-        // Find the best contrasting color (black or white)
-        inline RGB best_contrast_color(const RGB &background) {
-            double contrast_with_white = contrast_ratio(RGB::white(), background);
-            double contrast_with_black = contrast_ratio(RGB::black(), background);
-
-            return (contrast_with_white > contrast_with_black) ? RGB::white() : RGB::black();
-        }
-
         // Color temperature estimation (in Kelvin)
         inline double color_temperature(const RGB &color) {
             // Simplified calculation based on chromaticity
@@ -163,28 +80,29 @@ namespace pigment {
             return colors;
         }
 
-        // Color sorting functions
-        inline void sort_by_hue(std::vector<RGB> &colors) {
-            std::sort(colors.begin(), colors.end(), [](const RGB &a, const RGB &b) {
-                HSL hsl_a = HSL::fromRGB(a);
-                HSL hsl_b = HSL::fromRGB(b);
-                return hsl_a.h < hsl_b.h;
-            });
+        // Color sorting functions. Keys are computed once per color and ties keep their input order; see
+        // sort.hpp for sorting by other keys.
+        template <execution::ExecutionPolicy Policy>
+        void sort_by_hue(const Policy &policy, std::vector<RGB> &colors) {
+            sorting::by_key(policy, colors, sorting::keys::hue);
         }
 
-        inline void sort_by_brightness(std::vector<RGB> &colors) {
-            std::sort(colors.begin(), colors.end(),
-                      [](const RGB &a, const RGB &b) { return a.luminance() < b.luminance(); });
+        inline void sort_by_hue(std::vector<RGB> &colors) { sort_by_hue(execution::seq, colors); }
+
+        template <execution::ExecutionPolicy Policy>
+        void sort_by_brightness(const Policy &policy, std::vector<RGB> &colors) {
+            sorting::by_key(policy, colors, sorting::keys::luminance);
         }
 
-        inline void sort_by_saturation(std::vector<RGB> &colors) {
-            std::sort(colors.begin(), colors.end(), [](const RGB &a, const RGB &b) {
-                HSL hsl_a = HSL::fromRGB(a);
-                HSL hsl_b = HSL::fromRGB(b);
-                return hsl_a.s < hsl_b.s;
-            });
+        inline void sort_by_brightness(std::vector<RGB> &colors) { sort_by_brightness(execution::seq, colors); }
+
+        template <execution::ExecutionPolicy Policy>
+        void sort_by_saturation(const Policy &policy, std::vector<RGB> &colors) {
+            sorting::by_key(policy, colors, sorting::keys::saturation);
         }
 
+        inline void sort_by_saturation(std::vector<RGB> &colors) { sort_by_saturation(execution::seq, colors); }
+
         // Color distance calculation
         inline double color_distance(const RGB &color1, const RGB &color2) {
             LAB lab1 = LAB::fromRGB(color1);
@@ -192,16 +110,23 @@ namespace pigment {
             return lab1.delta_e(lab2);
         }
 
-        // Find the closest color in a palette
+        // Color distance under a chosen metric, e.g. distance::Metric::OKLab
+        inline double color_distance(const RGB &color1, const RGB &color2, distance::Metric metric) {
+            return distance::between(color1, color2, metric);
+        }
+
+        // Find the closest color in a palette. Linear scan; use PaletteIndex when querying the same palette
+        // repeatedly.
         inline RGB find_closest_color(const RGB &target, const std::vector<RGB> &palette) {
             if (palette.empty())
                 return target;
 
+            LAB target_lab = LAB::fromRGB(target);
             RGB closest = palette[0];
-            double min_distance = color_distance(target, closest);
+            double min_distance = target_lab.delta_e(LAB::fromRGB(closest));
 
             for (const auto &color : palette) {
-                double distance = color_distance(target, color);
+                double distance = target_lab.delta_e(LAB::fromRGB(color));
                 if (distance < min_distance) {
                     min_distance = distance;
                     closest = color;
@@ -211,17 +136,40 @@ namespace pigment {
             return closest;
         }
 
-        // Quantize colors to a palette
+        // Quantize colors to a palette. Large inputs go through an exact Quantizer so each distinct color is
+        // searched once; the results are the same either way.
         inline std::vector<RGB> quantize_to_palette(const std::vector<RGB> &colors, const std::vector<RGB> &palette) {
+            if (colors.size() >= 4096) {
+                return Quantizer(palette).quantize(colors);
+            }
+
             std::vector<RGB> quantized;
             quantized.reserve(colors.size());
 
+            PaletteIndex index(palette);
             for (const auto &color : colors) {
-                quantized.push_back(find_closest_color(color, palette));
+                quantized.push_back(index.nearest_color(color));
             }
 
             return quantized;
         }
 
+        // One chunk per thread, each with its own exact Quantizer over one shared index, so every memo table is
+        // set up once and stays warm across its whole chunk
+        template <execution::ExecutionPolicy Policy>
+        std::vector<RGB> quantize_to_palette(const Policy &policy, const std::vector<RGB> &colors,
+                                             const std::vector<RGB> &palette) {
+            std::vector<RGB> quantized(colors.size());
+            const auto index = std::make_shared<const PaletteIndex>(palette);
+            execution::for_each_chunk(policy, colors.size(), execution::worker_chunk(policy, colors.size()),
+                                      [&](size_t lo, size_t hi) {
+                Quantizer quantizer(index);
+                for (size_t i = lo; i < hi; ++i) {
+                    quantized[i] = quantizer.quantize(colors[i]);
+                }
+            });
+            return quantized;
+        }
+
     } // namespace utils
 } // namespace pigment
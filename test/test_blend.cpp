@@ -0,0 +1,132 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include "test_helpers.hpp"
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pigment;
+using namespace test_helpers;
+
+namespace {
+    // W3C separable blend functions in double precision, on [0, 1]
+    double reference(blend::Mode mode, double cb, double cs) {
+        auto hard = [](double b, double s) { return s <= 0.5 ? b * 2 * s : b + (2 * s - 1) - b * (2 * s - 1); };
+        switch (mode) {
+        case blend::Mode::Normal: return cs;
+        case blend::Mode::Multiply: return cb * cs;
+        case blend::Mode::Screen: return cb + cs - cb * cs;
+        case blend::Mode::Overlay: return hard(cs, cb);
+        case blend::Mode::Darken: return std::min(cb, cs);
+        case blend::Mode::Lighten: return std::max(cb, cs);
+        case blend::Mode::ColorDodge: return cb == 0 ? 0 : (cs == 1 ? 1 : std::min(1.0, cb / (1 - cs)));
+        case blend::Mode::ColorBurn: return cb == 1 ? 1 : (cs == 0 ? 0 : 1 - std::min(1.0, (1 - cb) / cs));
+        case blend::Mode::HardLight: return hard(cb, cs);
+        case blend::Mode::SoftLight: {
+            double d = cb <= 0.25 ? ((16 * cb - 12) * cb + 4) * cb : std::sqrt(cb);
+            return cs <= 0.5 ? cb - (1 - 2 * cs) * cb * (1 - cb) : cb + (2 * cs - 1) * (d - cb);
+        }
+        case blend::Mode::Difference: return std::abs(cb - cs);
+        case blend::Mode::Exclusion: return cb + cs - 2 * cb * cs;
+        default: return 0;
+        }
+    }
+} // namespace
+
+TEST_CASE("Blend modes") {
+    const RGBA8 red(255, 0, 0, 255), gray(128, 128, 128, 255), white(255, 255, 255, 255);
+
+    SUBCASE("Known values") {
+        CHECK(blend::apply(blend::Mode::Multiply, white, gray) == gray);
+        CHECK(blend::apply(blend::Mode::Screen, RGBA8(0, 0, 0, 255), gray) == gray);
+        CHECK(blend::apply(blend::Mode::Difference, gray, gray) == RGBA8(0, 0, 0, 255));
+        CHECK(blend::apply(blend::Mode::Normal, red, gray, 0.5) == RGBA8(192, 64, 64, 255));
+        CHECK(blend::apply(blend::Mode::Multiply, red, gray, 0.0) == gray);
+        CHECK(blend::apply(blend::Mode::Multiply, red, gray, 1.0, 0) == gray);
+        // Over a transparent backdrop the blend function drops out
+        CHECK(blend::apply(blend::Mode::Difference, RGBA8(10, 20, 30, 200), RGBA8(0, 0, 0, 0)) ==
+              RGBA8(10, 20, 30, 200));
+        CHECK(blend::apply(blend::Mode::ColorDodge, white, RGBA8(0, 100, 255, 255)) == RGBA8(0, 255, 255, 255));
+        CHECK(blend::apply(blend::Mode::ColorBurn, RGBA8(0, 0, 0, 255), RGBA8(0, 100, 255, 255)) ==
+              RGBA8(0, 0, 255, 255));
+        CHECK(blend::is_separable(blend::Mode::Exclusion));
+        CHECK(!blend::is_separable(blend::Mode::Hue));
+        CHECK(std::string(blend::mode_name(blend::Mode::SoftLight)) == "soft-light");
+    }
+
+    SUBCASE("Separable modes follow the W3C formulas") {
+        std::mt19937 gen(3);
+        for (blend::Mode mode : blend::all_modes) {
+            if (!blend::is_separable(mode)) {
+                continue;
+            }
+            bool close = true;
+            for (int i = 0; i < 3000; ++i) {
+                RGBA8 top(gen() % 256, gen() % 256, gen() % 256, gen() % 256);
+                RGBA8 bottom(gen() % 256, gen() % 256, gen() % 256, gen() % 256);
+                RGBA8 got = blend::apply(mode, top, bottom);
+                double as = top.a / 255.0, ab = bottom.a / 255.0, ao = as + ab * (1 - as);
+                const uint8_t cs[3] = {top.r, top.g, top.b}, cb[3] = {bottom.r, bottom.g, bottom.b};
+                const uint8_t co[3] = {got.r, got.g, got.b};
+                close = close && std::abs(got.a - ao * 255) <= 0.5 + 1e-4;
+                for (int k = 0; k < 3 && ao > 0; ++k) {
+                    double s = cs[k] / 255.0, b = cb[k] / 255.0;
+                    double mixed = (1 - ab) * s + ab * reference(mode, b, s);
+                    double expected = (as * mixed + (1 - as) * ab * b) / ao * 255;
+                    close = close && std::abs(co[k] - expected) <= 0.5 + 1e-3;
+                }
+            }
+            INFO(blend::mode_name(mode));
+            CHECK(close);
+        }
+    }
+
+    SUBCASE("HSL modes take components from each layer") {
+        std::mt19937 gen(4);
+        bool close = true;
+        for (int i = 0; i < 2000; ++i) {
+            RGB top(gen() % 256, gen() % 256, gen() % 256), bottom(gen() % 256, gen() % 256, gen() % 256);
+            HSL t = HSL::fromRGB(top), b = HSL::fromRGB(bottom);
+            auto check = [&](blend::Mode mode, const HSL &expected) {
+                RGBA8 got = blend::apply(mode, RGBA8(top.r, top.g, top.b, 255), RGBA8(bottom.r, bottom.g, bottom.b, 255));
+                RGB want = expected.to_rgb();
+                close = close && std::abs(got.r - want.r) <= 1 && std::abs(got.g - want.g) <= 1 &&
+                        std::abs(got.b - want.b) <= 1;
+            };
+            check(blend::Mode::Hue, HSL(t.h, b.s, b.l));
+            check(blend::Mode::Saturation, HSL(b.h, t.s, b.l));
+            check(blend::Mode::Color, HSL(t.h, t.s, b.l));
+            check(blend::Mode::Luminosity, HSL(b.h, b.s, t.l));
+        }
+        CHECK(close);
+    }
+
+    SUBCASE("Buffer kernels match per-pixel at every level") {
+        const PixelBuffer top = random_image(203, 5, 1, false), bottom = random_image(203, 5, 2, false);
+        std::vector<uint8_t> mask(top.size());
+        for (size_t i = 0; i < mask.size(); ++i) {
+            mask[i] = static_cast<uint8_t>(i * 37);
+        }
+        for (simd::Level level : all_levels) {
+            bool same = true;
+            for (blend::Mode mode : blend::all_modes) {
+                PixelBuffer plain = bottom, masked = bottom;
+                blend::apply(mode, top, plain, 0.8, {}, level);
+                blend::apply(execution::par.with_chunk(64), mode, top, masked, 0.8, mask, level);
+                for (size_t i = 0; i < bottom.size(); ++i) {
+                    same = same && plain.get(i) == blend::apply(mode, top.get(i), bottom.get(i), 0.8) &&
+                           masked.get(i) == blend::apply(mode, top.get(i), bottom.get(i), 0.8, mask[i]);
+                }
+            }
+            INFO(simd::level_name(level));
+            CHECK(same);
+        }
+
+        PixelBuffer small(2, 2);
+        CHECK_THROWS_AS(blend::apply(blend::Mode::Screen, top, small), std::invalid_argument);
+        PixelBuffer target = bottom;
+        CHECK_THROWS_AS(blend::apply(blend::Mode::Screen, top, target, 1.0, std::span<const uint8_t>(mask).first(3)),
+                        std::invalid_argument);
+    }
+}
@@ -0,0 +1,100 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include "test_helpers.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace pigment;
+using namespace test_helpers;
+using CB = utils::ColorBlindness;
+
+namespace {
+    const CB::Type all_types[] = {CB::PROTANOPIA,  CB::DEUTERANOPIA,  CB::TRITANOPIA,
+                                  CB::PROTANOMALY, CB::DEUTERANOMALY, CB::TRITANOMALY};
+
+    // The same simulation in double precision with the exact transfer functions
+    RGB reference(const RGB &color, CB::Type type, double severity) {
+        const CB::Matrix m = CB::matrix(type, severity);
+        const double lin[3] = {transfer::srgb_to_linear_exact(color.r / 255.0),
+                               transfer::srgb_to_linear_exact(color.g / 255.0),
+                               transfer::srgb_to_linear_exact(color.b / 255.0)};
+        int out[3];
+        for (int k = 0; k < 3; ++k) {
+            double v = m[3 * k] * lin[0] + m[3 * k + 1] * lin[1] + m[3 * k + 2] * lin[2];
+            out[k] = static_cast<int>(std::lround(transfer::linear_to_srgb_exact(std::clamp(v, 0.0, 1.0)) * 255));
+        }
+        return RGB(out[0], out[1], out[2], color.a);
+    }
+} // namespace
+
+TEST_CASE("Color blindness simulation") {
+    SUBCASE("Matrices") {
+        // Rows sum to one at every tabulated severity, so grays stay gray
+        bool rows = true;
+        for (const auto &cone : utils::detail::machado) {
+            for (const auto &m : cone) {
+                for (int k = 0; k < 3; ++k) {
+                    rows = rows && std::abs(m[3 * k] + m[3 * k + 1] + m[3 * k + 2] - 1.0f) < 2e-6f;
+                }
+            }
+        }
+        CHECK(rows);
+
+        CHECK(CB::matrix(CB::DEUTERANOPIA, 0.0) == CB::Matrix{1, 0, 0, 0, 1, 0, 0, 0, 1});
+        CHECK(CB::matrix(CB::PROTANOPIA, 0.5)[0] == 0.458064f);
+        CHECK(CB::matrix(CB::PROTANOPIA, 0.5) == CB::matrix(CB::PROTANOMALY, 0.5));
+        CHECK(CB::matrix(CB::TRITANOPIA, 2.0) == CB::matrix(CB::TRITANOPIA, 1.0));
+        CHECK(CB::matrix(CB::TRITANOPIA, 0.25)[8] == doctest::Approx((0.882266 + 0.838294) / 2).epsilon(1e-6));
+        CHECK(CB::default_severity(CB::PROTANOPIA) == 1.0);
+        CHECK(CB::default_severity(CB::TRITANOMALY) == 0.5);
+    }
+
+    SUBCASE("Known values") {
+        const RGB color(200, 60, 90, 17);
+        for (CB::Type type : all_types) {
+            CHECK(CB::simulate(color, type, 0.0) == color);
+            for (int v : {0, 77, 128, 255}) {
+                CHECK(CB::simulate(RGB(v, v, v), type) == RGB(v, v, v));
+            }
+        }
+        // Red and green land close together on the red-green axis for a deuteranope
+        RGB red = CB::simulate(RGB(255, 0, 0), CB::DEUTERANOPIA), green = CB::simulate(RGB(0, 160, 0), CB::DEUTERANOPIA);
+        CHECK(std::abs(red.r - green.r) < 20);
+        CHECK(std::abs(red.g - green.g) < 20);
+        CHECK(CB::simulate(color, CB::PROTANOMALY) == CB::simulate(color, CB::PROTANOPIA, 0.5));
+    }
+
+    SUBCASE("Per-color results follow the double-precision reference") {
+        std::mt19937 gen(5);
+        for (CB::Type type : all_types) {
+            bool close = true;
+            for (int i = 0; i < 4000; ++i) {
+                RGB color(gen() % 256, gen() % 256, gen() % 256);
+                double severity = (gen() % 1001) / 1000.0;
+                RGB got = CB::simulate(color, type, severity), want = reference(color, type, severity);
+                close = close && std::abs(got.r - want.r) <= 1 && std::abs(got.g - want.g) <= 1 &&
+                        std::abs(got.b - want.b) <= 1;
+            }
+            CHECK(close);
+        }
+    }
+
+    SUBCASE("Buffers match per-color at every level") {
+        const PixelBuffer image = random_image(203, 5, 2);
+        for (simd::Level level : all_levels) {
+            bool same = true;
+            for (CB::Type type : all_types) {
+                PixelBuffer out, in_place = image;
+                CB::simulate(image, out, type, 0.7, level);
+                CB::simulate(execution::par.with_chunk(64), in_place, type, 0.7, level);
+                for (size_t i = 0; i < image.size(); ++i) {
+                    RGB want = CB::simulate(image.get(i), type, 0.7);
+                    same = same && out.get(i) == want && in_place.get(i) == want;
+                }
+            }
+            INFO(simd::level_name(level));
+            CHECK(same);
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include "test_helpers.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace pigment;
+using namespace test_helpers;
+
+namespace {
+    const composite::Op all_ops[] = {composite::Op::Over, composite::Op::In, composite::Op::Out,
+                                     composite::Op::Atop, composite::Op::Xor};
+
+    // Random premultiplied image
+    PixelBuffer layer(size_t width, size_t height, unsigned seed) {
+        PixelBuffer image = random_image(width, height, seed);
+        composite::premultiply(image);
+        return image;
+    }
+
+    RGBA8 pixel_or_clear(const PixelBuffer &image, ptrdiff_t x, ptrdiff_t y) {
+        if (x < 0 || y < 0 || x >= static_cast<ptrdiff_t>(image.width()) ||
+            y >= static_cast<ptrdiff_t>(image.height())) {
+            return RGBA8(0, 0, 0, 0);
+        }
+        return image.at(static_cast<size_t>(x), static_cast<size_t>(y));
+    }
+} // namespace
+
+TEST_CASE("Porter-Duff compositing") {
+    SUBCASE("Premultiply and unpremultiply") {
+        CHECK(composite::premultiply(RGBA8(255, 128, 0, 128)) == RGBA8(128, 64, 0, 128));
+        CHECK(composite::unpremultiply(RGBA8(128, 64, 0, 128)) == RGBA8(255, 128, 0, 128));
+        CHECK(composite::unpremultiply(RGBA8(3, 3, 3, 0)) == RGBA8(0, 0, 0, 0));
+
+        // Every (channel, alpha) pair, including channels above alpha
+        PixelBuffer all(256, 256);
+        for (size_t i = 0; i < all.size(); ++i) {
+            all.set(i, RGBA8(i % 256, 255 - i % 256, (i % 256) / 2, i / 256));
+        }
+        for (simd::Level level : all_levels) {
+            PixelBuffer pre = all, back = all;
+            composite::premultiply(pre, level);
+            composite::unpremultiply(execution::par, back, level);
+            bool same = true;
+            for (size_t i = 0; i < all.size(); ++i) {
+                same = same && pre.get(i) == composite::premultiply(all.get(i)) &&
+                       back.get(i) == composite::unpremultiply(all.get(i));
+            }
+            CHECK(same);
+        }
+
+        // Opaque pixels round-trip exactly, translucent ones to within the 8-bit precision of c * a
+        bool close = true;
+        for (int c = 0; c < 256; ++c) {
+            for (int a = 1; a < 256; ++a) {
+                RGBA8 back = composite::unpremultiply(composite::premultiply(RGBA8(c, c, c, a)));
+                close = close && std::abs(back.r - c) <= 255.0 / (2 * a) + 0.5 && (a != 255 || back.r == c);
+            }
+        }
+        CHECK(close);
+    }
+
+    SUBCASE("Operators") {
+        const RGBA8 red(255, 0, 0, 255), half_blue = composite::premultiply(RGBA8(0, 0, 255, 128));
+        const RGBA8 clear(0, 0, 0, 0);
+        CHECK(composite::apply(composite::Op::Over, half_blue, red) == RGBA8(127, 0, 128, 255));
+        CHECK(composite::apply(composite::Op::Over, red, half_blue) == red);
+        CHECK(composite::apply(composite::Op::In, red, half_blue) == RGBA8(128, 0, 0, 128));
+        CHECK(composite::apply(composite::Op::Out, red, half_blue) == RGBA8(127, 0, 0, 127));
+        CHECK(composite::apply(composite::Op::Atop, half_blue, red) == RGBA8(127, 0, 128, 255));
+        CHECK(composite::apply(composite::Op::Xor, red, red) == clear);
+        CHECK(composite::apply(composite::Op::Over, red, clear, 128) == RGBA8(128, 0, 0, 128));
+
+        // Over agrees with the floating-point formula
+        bool close = true;
+        std::mt19937 gen(5);
+        for (int i = 0; i < 5000; ++i) {
+            RGBA8 s = composite::premultiply(RGBA8(gen() % 256, gen() % 256, gen() % 256, gen() % 256));
+            RGBA8 d = composite::premultiply(RGBA8(gen() % 256, gen() % 256, gen() % 256, gen() % 256));
+            RGBA8 o = composite::apply(composite::Op::Over, s, d);
+            close = close && std::abs(o.g - (s.g + d.g * (1.0 - s.a / 255.0))) <= 0.5 + 1e-9 &&
+                    std::abs(o.a - (s.a + d.a * (1.0 - s.a / 255.0))) <= 0.5 + 1e-9;
+        }
+        CHECK(close);
+    }
+
+    SUBCASE("Buffer kernels match per-pixel at every level") {
+        const PixelBuffer src = layer(301, 7, 1), dst = layer(301, 7, 2);
+        for (simd::Level level : all_levels) {
+            bool same = true;
+            for (composite::Op op : all_ops) {
+                PixelBuffer out = dst;
+                composite::apply(execution::par.with_chunk(100), op, src, out, 0.6, level);
+                for (size_t i = 0; i < out.size(); ++i) {
+                    same = same && out.get(i) == composite::apply(op, src.get(i), dst.get(i), 153);
+                }
+            }
+            CHECK(same);
+        }
+        PixelBuffer small(2, 2);
+        CHECK_THROWS_AS(composite::apply(composite::Op::Over, src, small), std::invalid_argument);
+    }
+
+    SUBCASE("Flattening layers") {
+        const PixelBuffer base = layer(600, 90, 3), sticker = layer(130, 40, 4), wash = layer(700, 100, 5),
+                          mask = layer(300, 70, 6);
+        std::vector<composite::Layer> layers = {
+            {base},
+            {sticker, composite::Op::Over, 0.8, 250, 30},
+            {wash, composite::Op::Atop, 0.3, -20, -5},
+            {sticker, composite::Op::Xor, 1.0, 500, 70},
+            {mask, composite::Op::In, 1.0, 100, 10},
+            {sticker, composite::Op::Over, 1.0, -60, -10},
+        };
+
+        // Reference: every layer over the whole canvas, pixel by pixel
+        PixelBuffer expected(580, 85);
+        for (size_t y = 0; y < expected.height(); ++y) {
+            for (size_t x = 0; x < expected.width(); ++x) {
+                RGBA8 canvas(0, 0, 0, 0);
+                for (const auto &l : layers) {
+                    RGBA8 s = pixel_or_clear(*l.image, static_cast<ptrdiff_t>(x) - l.x, static_cast<ptrdiff_t>(y) - l.y);
+                    canvas = composite::apply(l.op, s, canvas,
+                                              static_cast<uint8_t>(std::round(l.opacity * 255)));
+                }
+                expected.set(y * expected.width() + x, canvas);
+            }
+        }
+
+        for (simd::Level level : all_levels) {
+            PixelBuffer seq = composite::flatten(layers, 580, 85, level);
+            PixelBuffer par = composite::flatten(execution::par, layers, 580, 85, level);
+            CHECK(seq.to_rgba8() == expected.to_rgba8());
+            CHECK(par.to_rgba8() == expected.to_rgba8());
+        }
+
+        // Onto an existing canvas
+        PixelBuffer canvas = base;
+        composite::flatten(std::span<const composite::Layer>(layers).subspan(1, 1), canvas);
+        CHECK(canvas.at(260, 35) == composite::apply(composite::Op::Over, sticker.at(10, 5), base.at(260, 35), 204));
+        CHECK(canvas.at(10, 5) == base.at(10, 5));
+
+        CHECK_THROWS_AS(composite::flatten(std::vector<composite::Layer>(1), canvas), std::invalid_argument);
+    }
+}
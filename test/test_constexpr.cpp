@@ -0,0 +1,79 @@
+#include <doctest/doctest.h>
+#include <pigment/named_colors.hpp>
+#include <pigment/pigment.hpp>
+#include <array>
+#include <cmath>
+
+using namespace pigment;
+using namespace pigment::literals;
+
+// Everything below is checked by the compiler; the test cases repeat a few at run time
+static_assert("#ff8000"_rgb == RGB(255, 128, 0));
+static_assert("#f80"_rgb == RGB(255, 136, 0));
+static_assert("#11223344"_rgb == RGB(0x11, 0x22, 0x33, 0x44));
+static_assert(RGB("00ff00") == RGB::green());
+static_assert(colors::crimson() == RGB(0xDC, 0x14, 0x3C));
+static_assert(RGB(200, 100, 50) + RGB(100, 100, 100) == RGB(255, 200, 150));
+static_assert(RGB(10, 20, 30).invert() == RGB(245, 235, 225));
+static_assert(RGB(100, 100, 100).mix(RGB(200, 200, 200)) == RGB(150, 150, 150));
+static_assert(RGB::white().is_light());
+static_assert(RGBA8(RGB(300, -5, 7)) == RGBA8(255, 0, 7));
+static_assert(RGB(RGBA8(1, 2, 3, 4)) == RGB(1, 2, 3, 4));
+static_assert(MONO(RGB::white()) == MONO(255));
+static_assert(HSL::fromRGB(RGB(255, 0, 0)).to_rgb() == RGB(255, 0, 0));
+static_assert(HSL(480.0, 0.5, 0.5).h == 120.0);
+static_assert(HSV::fromRGB(RGB(0, 0, 255)).h == 240.0f);
+static_assert(HSV::fromRGB(RGB(12, 34, 56)).toRGB() == RGB(12, 34, 56));
+static_assert(HSV(-30.0f, 1.0f, 1.0f).h == 330.0f);
+static_assert(LAB(50, 10, 20).mix(LAB(70, 30, 40)).l == 60.0);
+
+TEST_CASE("Compile-time colors") {
+    SUBCASE("Constant expressions match run-time results") {
+        constexpr RGB orange = "#FF8000"_rgb;
+        std::string hex = "#FF8000";
+        CHECK(orange == RGB(hex));
+        CHECK(orange == RGB(std::string_view(hex)));
+
+        constexpr HSL hsl = HSL::fromRGB(RGB(12, 200, 77));
+        RGB input(12, 200, 77);
+        HSL runtime = HSL::fromRGB(input);
+        CHECK(hsl.h == runtime.h);
+        CHECK(hsl.s == runtime.s);
+        CHECK(hsl.l == runtime.l);
+    }
+
+    SUBCASE("Constexpr rounding helpers agree with <cmath>") {
+        constexpr std::array<double, 11> values = {-2.5, -1.5, -0.5, -0.49, 0.0, 0.5, 1.5, 2.4999, 2.5, 1e17, -7.25};
+        constexpr auto rounded = [&] {
+            std::array<double, 11> out{};
+            for (size_t i = 0; i < values.size(); ++i) {
+                out[i] = detail::round(values[i]);
+            }
+            return out;
+        }();
+        constexpr auto floored = [&] {
+            std::array<double, 11> out{};
+            for (size_t i = 0; i < values.size(); ++i) {
+                out[i] = detail::floor(values[i]);
+            }
+            return out;
+        }();
+        for (size_t i = 0; i < values.size(); ++i) {
+            CHECK(rounded[i] == std::round(values[i]));
+            CHECK(floored[i] == std::floor(values[i]));
+        }
+        static_assert(detail::round(2.5) == 3.0 && detail::round(-2.5) == -3.0);
+        static_assert(detail::floor(-0.25f) == -1.0f);
+        static_assert(detail::fmod(725.5f, 360.0f) == 5.5f);
+        static_assert(detail::fmod(-725.5, 360.0) == -5.5);
+        constexpr float wrapped = detail::fmod(1e7f, 360.0f);
+        CHECK(wrapped == std::fmod(1e7f, 360.0f));
+    }
+
+    SUBCASE("Invalid hex digits throw at run time") {
+        CHECK_THROWS_AS(RGB("#12345G"), std::invalid_argument);
+        CHECK_THROWS_AS(RGB("#GGG"), std::invalid_argument);
+        CHECK_THROWS_AS(RGB("#12345"), std::invalid_argument);
+        CHECK_THROWS_AS(RGB(""), std::invalid_argument);
+    }
+}
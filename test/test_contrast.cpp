@@ -0,0 +1,107 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include "test_helpers.hpp"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+using namespace pigment;
+using namespace test_helpers;
+
+namespace {
+    // WCAG 2.x definition, straight from the formula
+    double wcag_luminance(const RGB &c) {
+        auto channel = [](int v) {
+            double s = v / 255.0;
+            return s <= 0.03928 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+        };
+        return 0.2126 * channel(c.r) + 0.7152 * channel(c.g) + 0.0722 * channel(c.b);
+    }
+} // namespace
+
+TEST_CASE("WCAG contrast") {
+    SUBCASE("Relative luminance and known ratios") {
+        bool exact = true;
+        for (const RGB &c : random_colors(2000, 1)) {
+            exact = exact && std::abs(utils::relative_luminance(c) - wcag_luminance(c)) < 1e-12;
+        }
+        CHECK(exact);
+        CHECK(utils::relative_luminance(RGB::white()) == doctest::Approx(1.0));
+        CHECK(utils::contrast_ratio(RGB::black(), RGB::white()) == doctest::Approx(21.0));
+
+        // The usual threshold grays: #767676 is the lightest gray passing AA on white, #777777 fails it
+        CHECK(utils::contrast_ratio(RGB(0x76, 0x76, 0x76), RGB::white()) == doctest::Approx(4.54).epsilon(1e-3));
+        CHECK(utils::contrast_ratio(RGB(0x77, 0x77, 0x77), RGB::white()) == doctest::Approx(4.48).epsilon(1e-3));
+        CHECK(utils::check_accessibility(RGB(0x76, 0x76, 0x76), RGB::white()) == utils::AccessibilityLevel::AA_NORMAL);
+        CHECK(utils::check_accessibility(RGB(0x77, 0x77, 0x77), RGB::white()) == utils::AccessibilityLevel::FAIL);
+        CHECK(utils::check_accessibility(RGB(0x77, 0x77, 0x77), RGB::white(), true) ==
+              utils::AccessibilityLevel::AA_LARGE);
+
+        // Pure green is far brighter than pure blue, which gamma-space luma understates
+        CHECK(utils::contrast_ratio(RGB(0, 255, 0), RGB::black()) == doctest::Approx(15.3).epsilon(1e-2));
+        CHECK(utils::contrast_ratio(RGB(0, 0, 255), RGB::black()) == doctest::Approx(2.44).epsilon(1e-2));
+        CHECK(utils::best_contrast_color(RGB(0, 0, 255)) == RGB::white());
+        CHECK(utils::best_contrast_color(RGB(0, 200, 0)) == RGB::black());
+    }
+
+    SUBCASE("Matrix matches per-pair ratios") {
+        const std::vector<RGB> text = random_colors(37, 2), surfaces = random_colors(53, 3);
+        utils::ContrastMatrix seq = utils::contrast_matrix(text, surfaces);
+        utils::ContrastMatrix par = utils::contrast_matrix(execution::par, text, surfaces);
+        CHECK(seq.rows() == 37);
+        CHECK(seq.cols() == 53);
+        CHECK(par.data() == seq.data());
+
+        bool same = true;
+        size_t below = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            for (size_t j = 0; j < surfaces.size(); ++j) {
+                double ratio = utils::contrast_ratio(text[i], surfaces[j]);
+                same = same && seq(i, j) == ratio &&
+                       seq.level(i, j, true) == utils::check_accessibility(text[i], surfaces[j], true);
+                below += ratio < 4.5;
+            }
+        }
+        CHECK(same);
+
+        auto failing = seq.failing();
+        CHECK(failing.size() == below);
+        bool ordered = true, failing_ok = true;
+        for (size_t k = 0; k < failing.size(); ++k) {
+            const auto &p = failing[k];
+            failing_ok = failing_ok && p.ratio < 4.5 && p.ratio == seq(p.foreground, p.background) &&
+                         p.level == utils::AccessibilityLevel::FAIL;
+            if (k > 0) {
+                const auto &q = failing[k - 1];
+                ordered = ordered && std::pair(q.foreground, q.background) < std::pair(p.foreground, p.background);
+            }
+        }
+        CHECK(failing_ok);
+        CHECK(ordered);
+        CHECK(seq.failing(1.0).empty());
+
+        utils::ContrastMatrix empty = utils::contrast_matrix({}, surfaces);
+        CHECK(empty.rows() == 0);
+        CHECK(empty.failing().empty());
+    }
+
+    SUBCASE("Pair lists") {
+        const std::vector<RGB> tokens = {RGB::white(), RGB::black(), RGB(0x76, 0x76, 0x76), RGB(0x77, 0x77, 0x77)};
+        const std::vector<std::pair<uint32_t, uint32_t>> pairs = {{1, 0}, {2, 0}, {3, 0}, {3, 3}};
+        auto result = utils::contrast_pairs(tokens, pairs);
+        REQUIRE(result.size() == 4);
+        CHECK(result[0].level == utils::AccessibilityLevel::AAA_NORMAL);
+        CHECK(result[1].level == utils::AccessibilityLevel::AA_NORMAL);
+        CHECK(result[2].level == utils::AccessibilityLevel::FAIL);
+        CHECK(result[3].ratio == 1.0);
+        CHECK(result[2].foreground == 3);
+        CHECK(result[2].ratio == utils::contrast_ratio(tokens[3], tokens[0]));
+
+        auto large = utils::contrast_pairs(execution::par, tokens, pairs, true);
+        CHECK(large[1].level == utils::AccessibilityLevel::AAA_LARGE);
+        CHECK(large[2].level == utils::AccessibilityLevel::AA_LARGE);
+
+        const std::vector<std::pair<uint32_t, uint32_t>> bad = {{0, 4}};
+        CHECK_THROWS_AS(utils::contrast_pairs(tokens, bad), std::invalid_argument);
+    }
+}
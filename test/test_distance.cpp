@@ -0,0 +1,120 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <cmath>
+#include <vector>
+
+using namespace pigment;
+
+namespace {
+    // More than two tiles, with a ragged last tile
+    std::vector<RGB> sample_colors(size_t n) {
+        std::vector<RGB> colors;
+        for (size_t i = 0; i < n; ++i) {
+            colors.push_back(RGB((i * 37) % 256, (i * 101) % 256, (i * 13 + i / 7) % 256));
+        }
+        return colors;
+    }
+
+    double expected(const RGB &x, const RGB &y, distance::Metric metric) {
+        LAB a = LAB::fromRGB(x), b = LAB::fromRGB(y);
+        switch (metric) {
+        case distance::Metric::CIE94: return a.delta_e_94(b);
+        case distance::Metric::CIEDE2000: return a.delta_e_2000(b);
+        default: return a.delta_e(b);
+        }
+    }
+
+    const distance::Metric all_metrics[] = {distance::Metric::CIE76, distance::Metric::CIE94,
+                                            distance::Metric::CIEDE2000};
+} // namespace
+
+TEST_CASE("Distance matrices") {
+    const auto colors = sample_colors(2 * distance::tile_size + 37);
+    const size_t n = colors.size();
+
+    SUBCASE("CIE94") {
+        LAB gray(50.0, 0.0, 0.0);
+        CHECK(gray.delta_e_94(LAB(60.0, 0.0, 0.0)) == doctest::Approx(10.0));
+        // Chroma differences are scaled by the reference chroma
+        LAB saturated(50.0, 40.0, 0.0);
+        CHECK(saturated.delta_e_94(LAB(50.0, 50.0, 0.0)) == doctest::Approx(10.0 / 2.8));
+        CHECK(saturated.delta_e_94(saturated) == 0.0);
+    }
+
+    SUBCASE("Dense matrix matches per-pair distances") {
+        for (auto metric : all_metrics) {
+            distance::Matrix m = distance::matrix(colors, metric);
+            REQUIRE(m.size() == n);
+            double max_error = 0.0;
+            bool symmetric = true;
+            for (size_t i = 0; i < n; ++i) {
+                CHECK(m(i, i) == 0.0);
+                for (size_t j = i + 1; j < n; ++j) {
+                    max_error = std::max(max_error, std::abs(m(i, j) - expected(colors[i], colors[j], metric)));
+                    symmetric = symmetric && m(i, j) == m(j, i);
+                }
+            }
+            CHECK(max_error < 1e-9);
+            CHECK(symmetric);
+        }
+    }
+
+    SUBCASE("Condensed matrix matches dense") {
+        distance::Matrix dense = distance::matrix(colors);
+        distance::Condensed packed = distance::condensed(colors);
+        CHECK(packed.data().size() == n * (n - 1) / 2);
+        bool same = true;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                same = same && packed(i, j) == dense(i, j);
+            }
+        }
+        CHECK(same);
+        CHECK(packed.index(0, 1) == 0);
+        CHECK(packed.index(1, 2) == n - 1);
+    }
+
+    SUBCASE("Sparse pairs under a threshold") {
+        std::vector<RGB> brand = {RGB(200, 30, 30), RGB(40, 40, 200), RGB(201, 31, 30), RGB(40, 41, 199),
+                                  RGB(0, 0, 0)};
+        auto pairs = distance::pairs_within(brand, 2.0);
+        REQUIRE(pairs.size() == 2);
+        CHECK(pairs[0].first == 0);
+        CHECK(pairs[0].second == 2);
+        CHECK(pairs[1].first == 1);
+        CHECK(pairs[1].second == 3);
+        CHECK(pairs[0].distance == doctest::Approx(LAB::fromRGB(brand[0]).delta_e_2000(LAB::fromRGB(brand[2]))));
+
+        distance::Matrix dense = distance::matrix(colors, distance::Metric::CIE76);
+        auto all = distance::pairs_within(colors, 20.0, distance::Metric::CIE76);
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i + 1; j < n; ++j) {
+                count += dense(i, j) < 20.0;
+            }
+        }
+        CHECK(all.size() == count);
+        CHECK(std::is_sorted(all.begin(), all.end(), [](const distance::Pair &x, const distance::Pair &y) {
+            return x.first != y.first ? x.first < y.first : x.second < y.second;
+        }));
+    }
+
+    SUBCASE("LAB input and parallel policies give identical results") {
+        std::vector<LAB> labs;
+        for (const auto &c : colors) {
+            labs.push_back(LAB::fromRGB(c));
+        }
+        execution::ThreadPool pool(4);
+        auto par = execution::par.on(pool);
+        CHECK(distance::matrix(par, colors).data() == distance::matrix(labs).data());
+        CHECK(distance::condensed(par, colors, distance::Metric::CIE94).data() ==
+              distance::condensed(colors, distance::Metric::CIE94).data());
+        CHECK(distance::pairs_within(par, labs, 15.0) == distance::pairs_within(colors, 15.0));
+    }
+
+    SUBCASE("Degenerate sizes") {
+        CHECK(distance::matrix(std::vector<RGB>{}).size() == 0);
+        CHECK(distance::condensed(std::vector<RGB>{RGB(1, 2, 3)}).data().empty());
+        CHECK(distance::pairs_within(std::vector<RGB>{RGB(1, 2, 3)}, 10.0).empty());
+    }
+}
@@ -0,0 +1,168 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+using namespace pigment;
+
+namespace {
+    PixelBuffer gray_image(size_t width, size_t height, uint8_t level) {
+        PixelBuffer image(width, height);
+        for (size_t i = 0; i < image.size(); ++i) {
+            image.set(i, RGBA8(level, level, level, 200));
+        }
+        return image;
+    }
+
+    PixelBuffer gradient_image(size_t width, size_t height) {
+        PixelBuffer image(width, height);
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                image.set(y * width + x, RGBA8(static_cast<uint8_t>(x * 255 / (width - 1)),
+                                               static_cast<uint8_t>(y * 255 / (height - 1)), 90));
+            }
+        }
+        return image;
+    }
+
+    double white_fraction(const PixelBuffer &image) {
+        size_t white = 0;
+        for (size_t i = 0; i < image.size(); ++i) {
+            white += image.get(i).r == 255;
+        }
+        return static_cast<double>(white) / image.size();
+    }
+
+    bool same_pixels(const PixelBuffer &a, const PixelBuffer &b) { return a.to_rgba8() == b.to_rgba8(); }
+} // namespace
+
+TEST_CASE("Dithering") {
+    PaletteIndex black_white(std::vector<RGB>{RGB::black(), RGB::white()});
+
+    SUBCASE("Error diffusion keeps the average level") {
+        PixelBuffer gray = gray_image(64, 64, 64);
+        for (auto type : {dither::Diffusion::FloydSteinberg, dither::Diffusion::Sierra}) {
+            PixelBuffer out;
+            dither::diffuse(gray, out, black_white, type);
+            CHECK(std::abs(white_fraction(out) - 0.25) < 0.02);
+            // Only palette colors, alpha untouched
+            for (size_t i = 0; i < out.size(); ++i) {
+                RGBA8 p = out.get(i);
+                CHECK((p.r == 0 || p.r == 255));
+                CHECK(p.a == 200);
+            }
+        }
+        // Atkinson drops a quarter of the error, so it only approximately preserves the level
+        PixelBuffer atkinson;
+        dither::diffuse(gray, atkinson, black_white, dither::Diffusion::Atkinson);
+        CHECK(white_fraction(atkinson) > 0.15);
+        CHECK(white_fraction(atkinson) < 0.3);
+    }
+
+    SUBCASE("Floyd-Steinberg on a single row") {
+        // 7/16 of the error moves right: 128 -> white (err -127), next 128 - 55.6 -> black, ...
+        PixelBuffer row = gray_image(4, 1, 128);
+        dither::diffuse(row, row, black_white);
+        CHECK(row.get(0).r == 255);
+        CHECK(row.get(1).r == 0);
+    }
+
+    SUBCASE("In-place and serpentine options") {
+        PixelBuffer image = gradient_image(50, 40);
+        PixelBuffer copy = image;
+        PixelBuffer out;
+        PaletteIndex palette(Palette::material_design_colors());
+        dither::diffuse(image, out, palette);
+        dither::diffuse(copy, copy, palette);
+        CHECK(same_pixels(out, copy));
+
+        PixelBuffer raster;
+        dither::diffuse(image, raster, palette, dither::Diffusion::FloydSteinberg, {false, 0});
+        CHECK_FALSE(same_pixels(out, raster));
+    }
+
+    SUBCASE("Tiled diffusion is identical under every policy") {
+        PixelBuffer image = gradient_image(80, 70);
+        PaletteIndex palette(Palette::material_design_colors());
+        dither::Options tiled{true, 16};
+        execution::ThreadPool pool(3);
+        for (auto type : {dither::Diffusion::FloydSteinberg, dither::Diffusion::Atkinson, dither::Diffusion::Sierra}) {
+            PixelBuffer seq, par;
+            dither::diffuse(image, seq, palette, type, tiled);
+            dither::diffuse(execution::par.on(pool), image, par, palette, type, tiled);
+            CHECK(same_pixels(seq, par));
+        }
+    }
+
+    SUBCASE("Default tiling lets tall frames run in parallel") {
+        CHECK(dither::Options{}.tile_height == 256);
+        PixelBuffer image = gradient_image(24, 600);
+        PaletteIndex palette(Palette::material_design_colors());
+        execution::ThreadPool pool(3);
+        PixelBuffer seq, par, whole;
+        dither::diffuse(image, seq, palette);
+        dither::diffuse(execution::par.on(pool), image, par, palette);
+        dither::diffuse(image, whole, palette, dither::Diffusion::FloydSteinberg, {true, 0});
+        CHECK(same_pixels(seq, par));
+        CHECK_FALSE(same_pixels(seq, whole));
+    }
+
+    SUBCASE("Bayer matrices") {
+        auto bayer2 = dither::ThresholdMap::bayer(2);
+        CHECK(bayer2.at(0, 0) == doctest::Approx(0.125));
+        CHECK(bayer2.at(1, 0) == doctest::Approx(0.625));
+        CHECK(bayer2.at(0, 1) == doctest::Approx(0.875));
+        CHECK(bayer2.at(1, 1) == doctest::Approx(0.375));
+        CHECK(bayer2.at(2, 3) == bayer2.at(0, 1));
+
+        auto bayer8 = dither::ThresholdMap::bayer(8);
+        std::set<float> values;
+        for (size_t y = 0; y < 8; ++y) {
+            for (size_t x = 0; x < 8; ++x) {
+                values.insert(bayer8.at(x, y));
+            }
+        }
+        CHECK(values.size() == 64);
+        CHECK_THROWS_AS(dither::ThresholdMap::bayer(6), std::invalid_argument);
+    }
+
+    SUBCASE("Blue noise map") {
+        auto noise = dither::ThresholdMap::blue_noise(16, 7);
+        CHECK(noise.size() == 16);
+        std::set<float> values;
+        double adjacent = 0.0;
+        for (size_t y = 0; y < 16; ++y) {
+            for (size_t x = 0; x < 16; ++x) {
+                values.insert(noise.at(x, y));
+                adjacent += std::abs(noise.at(x, y) - noise.at(x + 1, y));
+            }
+        }
+        // Every rank used once, and neighbours differ more than white noise would (mean 1/3)
+        CHECK(values.size() == 256);
+        CHECK(adjacent / 256 > 0.34);
+
+        auto again = dither::ThresholdMap::blue_noise(16, 7);
+        CHECK(again.at(3, 5) == noise.at(3, 5));
+    }
+
+    SUBCASE("Ordered dithering") {
+        PixelBuffer gray = gray_image(64, 64, 128);
+        auto bayer = dither::ThresholdMap::bayer(8);
+        PixelBuffer out;
+        dither::ordered(gray, out, black_white, bayer, 255.0f);
+        // Nearest colors are picked in LAB, where mid-gray 128 sits slightly closer to white
+        CHECK(white_fraction(out) >= 0.5);
+        CHECK(white_fraction(out) < 0.6);
+        CHECK(out.get(0).a == 200);
+
+        auto noise = dither::ThresholdMap::blue_noise(32);
+        PixelBuffer seq, par;
+        PixelBuffer image = gradient_image(90, 33);
+        PaletteIndex palette(Palette::warm_colors());
+        dither::ordered(image, seq, palette, noise);
+        dither::ordered(execution::par.with_chunk(4), image, par, palette, noise);
+        CHECK(same_pixels(seq, par));
+        CHECK_THROWS_AS(dither::ordered(image, seq, PaletteIndex(), noise), std::invalid_argument);
+    }
+}
@@ -0,0 +1,155 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include "test_helpers.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace pigment;
+using namespace test_helpers;
+
+TEST_CASE("Execution Policies") {
+    execution::ThreadPool pool(4);
+    // Small chunks so even modest inputs are split across many tasks
+    const auto par = execution::par.on(pool).with_chunk(257);
+    // A user executor that runs tasks in reverse order on the calling thread
+    const auto reversed = execution::executor([](size_t count, const std::function<void(size_t)> &task) {
+        for (size_t i = count; i-- > 0;) {
+            task(i);
+        }
+    }).with_chunk(100);
+
+    SUBCASE("Thread pool runs every task once") {
+        CHECK(pool.size() == 4);
+        std::vector<std::atomic<int>> hits(10000);
+        pool.run(hits.size(), [&](size_t i) { hits[i]++; });
+        bool all_once = true;
+        for (auto &h : hits) {
+            all_once = all_once && h.load() == 1;
+        }
+        CHECK(all_once);
+
+        // Nested runs from inside a task complete
+        std::atomic<int> inner{0};
+        pool.run(8, [&](size_t) { pool.run(8, [&](size_t) { inner++; }); });
+        CHECK(inner.load() == 64);
+    }
+
+    SUBCASE("Exceptions propagate after all tasks finish") {
+        std::atomic<int> ran{0};
+        CHECK_THROWS_AS(pool.run(100,
+                                 [&](size_t i) {
+                                     ran++;
+                                     if (i == 13) {
+                                         throw std::runtime_error("task failed");
+                                     }
+                                 }),
+                        std::runtime_error);
+        CHECK(ran.load() == 100);
+        // The pool is still usable
+        std::atomic<int> after{0};
+        pool.run(10, [&](size_t) { after++; });
+        CHECK(after.load() == 10);
+    }
+
+    SUBCASE("for_each_chunk covers the range in fixed chunks") {
+        std::vector<int> owner(1000, -1);
+        execution::for_each_chunk(par, owner.size(), 0, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                owner[i] = static_cast<int>(lo / 257);
+            }
+        });
+        CHECK(owner.front() == 0);
+        CHECK(owner[256] == 0);
+        CHECK(owner[257] == 1);
+        CHECK(owner.back() == 3);
+        size_t calls = 0;
+        execution::for_each_chunk(execution::seq, 5000, 64, [&](size_t, size_t) { ++calls; });
+        CHECK(calls == 1);
+    }
+
+    SUBCASE("worker_chunk gives each thread one chunk") {
+        CHECK(execution::concurrency(execution::seq) == 1);
+        CHECK(execution::concurrency(execution::par.on(pool)) == 4);
+        CHECK(execution::concurrency(reversed) >= 1);
+        CHECK(execution::worker_chunk(execution::par.on(pool), 1000) == 250);
+        CHECK(execution::worker_chunk(execution::par.on(pool), 1001) == 251);
+        CHECK(execution::worker_chunk(execution::par.on(pool), 0) == 1);
+        CHECK(execution::worker_chunk(execution::seq, 1000) == 1000);
+    }
+
+    SUBCASE("quantize_to_palette is identical under every policy") {
+        auto palette = random_colors(40, 1);
+        auto colors = random_colors(5000, 2);
+        auto expected = utils::quantize_to_palette(colors, palette);
+        CHECK(utils::quantize_to_palette(execution::seq, colors, palette) == expected);
+        CHECK(utils::quantize_to_palette(par, colors, palette) == expected);
+        CHECK(utils::quantize_to_palette(reversed, colors, palette) == expected);
+        CHECK(utils::quantize_to_palette(execution::par, colors, palette) == expected);
+    }
+
+    SUBCASE("Sorting is stable and identical under every policy") {
+        // Few distinct hues, so there are many ties
+        std::vector<RGB> colors;
+        for (int i = 0; i < 3000; ++i) {
+            int v = (i * 37) % 256;
+            colors.push_back(i % 3 == 0 ? RGB(v, 0, 0) : (i % 3 == 1 ? RGB(0, v, 0) : RGB(v, v, 0)));
+        }
+        auto expected = colors;
+        utils::sort_by_hue(expected);
+        for (size_t i = 1; i < expected.size(); ++i) {
+            CHECK(HSL::fromRGB(expected[i - 1]).h <= HSL::fromRGB(expected[i]).h);
+        }
+        // Ties keep input order
+        CHECK(expected[0] == colors[0]);
+
+        auto parallel = colors;
+        utils::sort_by_hue(par, parallel);
+        CHECK(parallel == expected);
+        auto custom = colors;
+        utils::sort_by_hue(reversed, custom);
+        CHECK(custom == expected);
+
+        auto by_saturation = random_colors(2000, 3);
+        auto sat_expected = by_saturation;
+        utils::sort_by_saturation(sat_expected);
+        utils::sort_by_saturation(par, by_saturation);
+        CHECK(by_saturation == sat_expected);
+    }
+
+    SUBCASE("Gradients") {
+        auto expected = Palette::gradient(RGB::red(), RGB::blue(), 1000);
+        auto parallel = Palette::gradient(par, RGB::red(), RGB::blue(), 1000);
+        CHECK(std::equal(expected.begin(), expected.end(), parallel.begin(), parallel.end()));
+
+        std::vector<RGB> stops = {RGB::red(), RGB::green(), RGB::blue(), RGB::white()};
+        auto multi = Palette::gradient(stops, 400);
+        auto multi_par = Palette::gradient(reversed, stops, 400);
+        CHECK(multi.size() == 1200);
+        CHECK(std::equal(multi.begin(), multi.end(), multi_par.begin(), multi_par.end()));
+    }
+
+    SUBCASE("Bulk conversions") {
+        auto pixels = random_colors(64 * 50, 4);
+        PixelBuffer image = PixelBuffer::from_pixels(pixels, 64, 50);
+        LABBuffer lab_seq, lab_par;
+        bulk::rgb_to_lab(image, lab_seq);
+        bulk::rgb_to_lab(par, image, lab_par);
+        CHECK(std::equal(lab_seq.channel(1).begin(), lab_seq.channel(1).end(), lab_par.channel(1).begin()));
+
+        HSVBuffer hsv;
+        bulk::rgb_to_hsv(reversed, image, hsv);
+        PixelBuffer back;
+        bulk::hsv_to_rgb(par, hsv, back);
+        CHECK(back.to_rgb() == image.to_rgb());
+
+        HSLBuffer hsl;
+        bulk::rgb_to_hsl(par, image, hsl);
+        PixelBuffer from_lab, from_hsl;
+        bulk::lab_to_rgb(par, lab_par, from_lab);
+        bulk::hsl_to_rgb(par, hsl, from_hsl);
+        CHECK(from_lab.to_rgb() == image.to_rgb());
+        CHECK(from_hsl.to_rgb() == image.to_rgb());
+    }
+}
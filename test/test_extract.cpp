@@ -0,0 +1,120 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using namespace pigment;
+
+namespace {
+    // Three noisy blobs of different sizes: red (50%), green (30%), blue (20%)
+    std::vector<RGB> blob_pixels() {
+        std::vector<RGB> pixels;
+        auto blob = [&](RGB center, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                int d = static_cast<int>(i % 7) - 3;
+                pixels.push_back(RGB(center.r + d, center.g - d, center.b + (d & 1)));
+            }
+        };
+        blob(RGB(220, 30, 30), 5000);
+        blob(RGB(30, 180, 60), 3000);
+        blob(RGB(40, 60, 210), 2000);
+        return pixels;
+    }
+
+    bool near(const RGB &a, const RGB &b, int tolerance) {
+        return std::abs(a.r - b.r) <= tolerance && std::abs(a.g - b.g) <= tolerance && std::abs(a.b - b.b) <= tolerance;
+    }
+} // namespace
+
+TEST_CASE("Palette extraction") {
+    SUBCASE("Histogram deduplicates and skips transparent pixels") {
+        std::vector<RGB> pixels = {RGB(1, 2, 3), RGB(9, 9, 9), RGB(1, 2, 3), RGB(5, 5, 5, 0), RGB(1, 2, 3)};
+        extract::Histogram h = extract::histogram(pixels);
+        REQUIRE(h.size() == 2);
+        CHECK(h.colors[0] == RGB(1, 2, 3));
+        CHECK(h.counts[0] == 3);
+        CHECK(h.counts[1] == 1);
+    }
+
+    SUBCASE("Large histograms are sorted by key on every policy") {
+        std::vector<RGB> pixels;
+        for (int i = 0; i < 50000; ++i) {
+            pixels.push_back(RGB((i * 37) % 256, (i * 11) % 7, (i * 5) % 3, i % 10 == 0 ? 0 : 255));
+        }
+        std::map<uint32_t, uint32_t> expected;
+        for (const RGB &p : pixels) {
+            if (p.a != 0) {
+                ++expected[(uint32_t(p.r) << 16) | (uint32_t(p.g) << 8) | uint32_t(p.b)];
+            }
+        }
+        execution::ThreadPool pool(4);
+        extract::Histogram seq = extract::histogram(pixels);
+        extract::Histogram par = extract::histogram(execution::par.on(pool).with_chunk(1000), pixels);
+        REQUIRE(seq.size() == expected.size());
+        size_t i = 0;
+        bool matches = true;
+        for (const auto &[key, count] : expected) {
+            matches = matches && seq.colors[i] == RGB(key >> 16, (key >> 8) & 255, key & 255) && seq.counts[i] == count;
+            ++i;
+        }
+        CHECK(matches);
+        CHECK(par.colors == seq.colors);
+        CHECK(par.counts == seq.counts);
+    }
+
+    SUBCASE("Few unique colors are returned exactly, heaviest first") {
+        std::vector<RGB> pixels = {RGB(10, 10, 10), RGB(200, 0, 0), RGB(200, 0, 0), RGB(0, 0, 255)};
+        for (auto method : {extract::Method::MedianCut, extract::Method::Octree, extract::Method::KMeans}) {
+            Palette p = Palette::extract(pixels, 8, method);
+            REQUIRE(p.size() == 3);
+            CHECK(p[0] == RGB(200, 0, 0));
+        }
+        CHECK(Palette::extract(pixels, 0).empty());
+        CHECK(Palette::extract(std::vector<RGB>{}, 4).empty());
+    }
+
+    SUBCASE("Every method finds the dominant blobs in order") {
+        const auto pixels = blob_pixels();
+        for (auto method : {extract::Method::MedianCut, extract::Method::Octree, extract::Method::KMeans}) {
+            CAPTURE(static_cast<int>(method));
+            Palette p = Palette::extract(pixels, 3, method);
+            REQUIRE(p.size() == 3);
+            CHECK(near(p[0], RGB(220, 30, 30), 8));
+            CHECK(near(p[1], RGB(30, 180, 60), 8));
+            CHECK(near(p[2], RGB(40, 60, 210), 8));
+        }
+    }
+
+    SUBCASE("Mini-batch k-means") {
+        extract::Options options;
+        options.mini_batch = true;
+        options.batch_size = 256;
+        Palette p = Palette::extract(blob_pixels(), 3, extract::Method::KMeans, options);
+        REQUIRE(p.size() == 3);
+        CHECK(near(p[0], RGB(220, 30, 30), 8));
+    }
+
+    SUBCASE("Parallel result matches sequential") {
+        std::vector<RGB> pixels;
+        for (int i = 0; i < 40000; ++i) {
+            pixels.push_back(RGB(i % 251, (i * 7) % 241, (i * 13) % 239));
+        }
+        execution::ThreadPool pool(4);
+        for (auto method : {extract::Method::MedianCut, extract::Method::Octree, extract::Method::KMeans}) {
+            auto a = extract::palette(pixels, 16, method);
+            auto b = extract::palette(execution::par.on(pool).with_chunk(512), pixels, 16, method);
+            CHECK(a.size() <= 16);
+            CHECK(a.size() >= 9);
+            CHECK(a == b);
+        }
+    }
+
+    SUBCASE("PixelBuffer input") {
+        PixelBuffer image = PixelBuffer::from_pixels(blob_pixels(), 100, 100);
+        Palette p = Palette::extract(image, 3, extract::Method::MedianCut);
+        REQUIRE(p.size() == 3);
+        CHECK(near(p[0], RGB(220, 30, 30), 8));
+        CHECK(near(p[2], RGB(40, 60, 210), 8));
+    }
+}
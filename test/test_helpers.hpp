@@ -0,0 +1,43 @@
+#pragma once
+
+#include <pigment/pigment.hpp>
+#include <random>
+#include <vector>
+
+// Fixtures shared by the test files
+namespace test_helpers {
+
+    inline const pigment::simd::Level all_levels[] = {pigment::simd::Level::Scalar, pigment::simd::Level::SSE41,
+                                                      pigment::simd::Level::AVX2, pigment::simd::Level::AVX512};
+
+    // Opaque colors with uniformly random channels
+    inline std::vector<pigment::RGB> random_colors(std::mt19937 &gen, size_t count) {
+        std::uniform_int_distribution<int> channel(0, 255);
+        std::vector<pigment::RGB> colors;
+        colors.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            colors.push_back(pigment::RGB(channel(gen), channel(gen), channel(gen)));
+        }
+        return colors;
+    }
+
+    inline std::vector<pigment::RGB> random_colors(size_t count, unsigned seed) {
+        std::mt19937 gen(seed);
+        return random_colors(gen, count);
+    }
+
+    // Random straight-alpha image. Unless `opaque`, a quarter of the pixels are opaque and the rest have
+    // random alpha, so both the opaque fast paths and general blending are exercised.
+    inline pigment::PixelBuffer random_image(size_t width, size_t height, unsigned seed, bool opaque = false) {
+        std::mt19937 gen(seed);
+        pigment::PixelBuffer image(width, height);
+        for (size_t i = 0; i < image.size(); ++i) {
+            const uint8_t r = static_cast<uint8_t>(gen() % 256), g = static_cast<uint8_t>(gen() % 256),
+                          b = static_cast<uint8_t>(gen() % 256);
+            const uint8_t a = static_cast<uint8_t>(opaque || gen() % 4 == 0 ? 255 : gen() % 256);
+            image.set(i, pigment::RGBA8(r, g, b, a));
+        }
+        return image;
+    }
+
+} // namespace test_helpers
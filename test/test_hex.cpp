@@ -0,0 +1,144 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <string>
+#include <vector>
+
+using namespace pigment;
+using namespace pigment::literals;
+
+TEST_CASE("Hex Parsing") {
+    SUBCASE("parse_hex reports errors without throwing") {
+        RGB color(1, 2, 3);
+        CHECK(parse_hex("#FF8000", color) == ParseError::Ok);
+        CHECK(color == RGB(255, 128, 0));
+        CHECK(parse_hex("0f08", color) == ParseError::BadLength);
+        CHECK(parse_hex("#", color) == ParseError::Empty);
+        CHECK(parse_hex("", color) == ParseError::Empty);
+        CHECK(parse_hex("#12345G", color) == ParseError::BadDigit);
+        CHECK(parse_hex("#1g3", color) == ParseError::BadDigit);
+        // Failed parses leave the output alone
+        CHECK(color == RGB(255, 128, 0));
+        CHECK(parse_hex("#abc", color) == ParseError::Ok);
+        CHECK(color == RGB(0xAA, 0xBB, 0xCC));
+        CHECK(parse_hex("11223344", color) == ParseError::Ok);
+        CHECK(color == RGB(0x11, 0x22, 0x33, 0x44));
+        static_assert(parse_error_message(ParseError::BadDigit) != nullptr);
+    }
+
+    SUBCASE("parse_hex agrees with the throwing constructor") {
+        const char *inputs[] = {"#000", "#FFFFFF", "c0ffee", "#DeadBeef", "#12", "zzzzzz", "#1234567"};
+        for (const char *input : inputs) {
+            RGB parsed;
+            bool ok = parse_hex(input, parsed) == ParseError::Ok;
+            bool threw = false;
+            RGB constructed;
+            try {
+                constructed = RGB(input);
+            } catch (const std::invalid_argument &) {
+                threw = true;
+            }
+            CHECK(ok != threw);
+            if (ok) {
+                CHECK(parsed == constructed);
+            }
+        }
+    }
+
+    SUBCASE("Bulk parsing into a vector") {
+        std::vector<RGB> colors;
+        auto result = hex::parse_list("#ff0000, #00ff00;;#00F\n#ba!\r\n12345678,\n", colors);
+        CHECK(result.parsed == 4);
+        CHECK(result.failed == 1);
+        CHECK(result.first_error == ParseError::BadDigit);
+        CHECK(result.first_error_offset == 23);
+        REQUIRE(colors.size() == 4);
+        CHECK(colors[0] == RGB::red());
+        CHECK(colors[1] == RGB::green());
+        CHECK(colors[2] == RGB::blue());
+        CHECK(colors[3] == RGB(0x12, 0x34, 0x56, 0x78));
+
+        // Appends to existing contents
+        hex::parse_list("fff", colors);
+        CHECK(colors.size() == 5);
+        CHECK(colors.back() == RGB::white());
+
+        CHECK(hex::count_tokens("#ff0000, #00ff00;;#00F\n#ba!\r\n12345678,\n") == 5);
+        CHECK(hex::count_tokens(",, ;") == 0);
+        CHECK(hex::count_tokens("a|b||c", "|") == 3);
+    }
+
+    SUBCASE("Bulk parsing into RGBA8 with a custom delimiter") {
+        std::vector<RGBA8> pixels;
+        auto result = hex::parse_list("ff000080|00ff00|xyz|", pixels, "|");
+        CHECK(result.parsed == 2);
+        CHECK(result.failed == 1);
+        CHECK(result.first_error == ParseError::BadDigit);
+        REQUIRE(pixels.size() == 2);
+        CHECK(pixels[0] == RGBA8(255, 0, 0, 128));
+        CHECK(pixels[1] == RGBA8(0, 255, 0, 255));
+    }
+
+    SUBCASE("Bulk parsing stops when the output is full") {
+        std::string text = "#111 #222 #333";
+        RGB out[2];
+        auto result = hex::parse_list(text, std::span<RGB>(out));
+        CHECK(result.parsed == 2);
+        CHECK(out[1] == RGB(0x22, 0x22, 0x22));
+        auto rest = hex::parse_list(std::string_view(text).substr(result.consumed), std::span<RGB>(out));
+        CHECK(rest.parsed == 1);
+        CHECK(out[0] == RGB(0x33, 0x33, 0x33));
+    }
+
+    SUBCASE("Large input") {
+        std::string text;
+        for (int i = 0; i < 100000; ++i) {
+            text += RGB(i & 255, (i >> 8) & 255, 7).to_hex();
+            text += (i % 10 == 9) ? "\n" : ",";
+        }
+        std::vector<RGB> colors;
+        auto result = hex::parse_list(text, colors);
+        CHECK(result.parsed == 100000);
+        CHECK(result.failed == 0);
+        CHECK(result.consumed == text.size());
+        CHECK(colors[54321] == RGB(54321 & 255, (54321 >> 8) & 255, 7));
+    }
+
+    SUBCASE("Formatting without streams") {
+        char buffer[RGB::max_hex_length];
+        CHECK(RGB(255, 128, 0).write_hex(buffer) == 7);
+        CHECK(std::string_view(buffer, 7) == "#ff8000");
+        CHECK(RGB(1, 2, 3, 4).write_hex(buffer, true) == 9);
+        CHECK(std::string_view(buffer, 9) == "#01020304");
+        // Opaque colors never get an alpha pair
+        CHECK(RGB(1, 2, 3).write_hex(buffer, true) == 7);
+
+        static_assert(RGB(0xAB, 0xCD, 0xEF).hex() == "#abcdef");
+        static_assert(MONO(200).hex() == "#c8");
+        constexpr HexString h = "#C0FFEE80"_rgb.hex(true);
+        CHECK(std::string(h.c_str()) == "#c0ffee80");
+        CHECK(h.size() == 9);
+
+        // Out-of-range channels are clamped instead of widening the output
+        CHECK(RGB(300, -5, 16).to_hex() == "#ff0010");
+    }
+
+    SUBCASE("Bulk formatting") {
+        std::vector<RGB> colors = {RGB::red(), RGB(0, 0, 0, 0), RGB(18, 52, 86)};
+        CHECK(hex::format_list(colors) == "#ff0000,#000000,#123456");
+        CHECK(hex::format_list(colors, '\n', true) == "#ff0000\n#00000000\n#123456");
+        CHECK(hex::format_list(std::vector<RGB>{}).empty());
+
+        std::vector<RGBA8> pixels = {RGBA8(1, 2, 3), RGBA8(255, 255, 255, 128)};
+        CHECK(hex::format_list(pixels, ' ', true) == "#010203 #ffffff80");
+
+        // Round trip through the bulk parser
+        std::vector<RGB> many;
+        for (int i = 0; i < 5000; ++i) {
+            many.push_back(RGB(i & 255, (i * 7) & 255, (i * 13) & 255, (i * 3) & 255));
+        }
+        std::string text = hex::format_list(many, ';', true);
+        std::vector<RGB> parsed;
+        CHECK(hex::parse_list(text, parsed).failed == 0);
+        CHECK(parsed == many);
+    }
+}
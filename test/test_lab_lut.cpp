@@ -0,0 +1,83 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <thread>
+#include <vector>
+
+using namespace pigment;
+
+TEST_CASE("LAB Lookup Table Tests") {
+    SUBCASE("Construction") {
+        LabLut lut;
+        CHECK(lut.grid_size() == 33);
+        CHECK(lut.method() == interp::Method::Tetrahedral);
+        CHECK_FALSE(lut.is_exact());
+        CHECK(lut.memory_bytes() == 33u * 33u * 33u * 3u * sizeof(float));
+        CHECK_THROWS_AS(LabLut(1), std::invalid_argument);
+        CHECK_THROWS_AS(LabLut(257), std::invalid_argument);
+    }
+
+    SUBCASE("Lookups Track The Exact Path") {
+        LabLut tetrahedral(33, interp::Method::Tetrahedral);
+        LabLut trilinear(33, interp::Method::Trilinear);
+
+        RGB colors[] = {RGB::red(), RGB(180, 120, 200), RGB(12, 200, 99, 128), RGB::white(), RGB::black()};
+        for (const RGB &color : colors) {
+            LAB exact = LAB::fromRGB(color);
+            CHECK(tetrahedral.lookup(color).delta_e(exact) < 1.0);
+            CHECK(trilinear.lookup(color).delta_e(exact) < 1.0);
+            CHECK(tetrahedral.lookup(color).alpha == color.a);
+        }
+
+        // Grid nodes are reproduced exactly up to float storage
+        CHECK(tetrahedral.lookup(RGB(255, 0, 255)).delta_e(LAB::fromRGB(RGB(255, 0, 255))) < 1e-4);
+    }
+
+    SUBCASE("Reported Error Bounds Every Lookup") {
+        LabLut lut(17);
+        double bound = lut.max_delta_e();
+        CHECK(bound > 0.0);
+        CHECK(bound < 2.0);
+        CHECK(lut.max_delta_e() == bound);
+        CHECK(lut.estimate_max_delta_e(7) <= bound);
+
+        // Finer grids are more accurate
+        LabLut fine(65);
+        CHECK(fine.estimate_max_delta_e(3) < lut.estimate_max_delta_e(3));
+    }
+
+    SUBCASE("Exact Mode") {
+        LabLut exact(LabLut::exact);
+        CHECK(exact.is_exact());
+        CHECK(exact.estimate_max_delta_e(5) < 1e-3);
+    }
+
+    SUBCASE("Bulk Conversion") {
+        std::vector<RGB> pixels = {RGB(10, 20, 30), RGB(200, 100, 50), RGB(0, 255, 128), RGB(77, 77, 77)};
+        PixelBuffer buffer = PixelBuffer::from_pixels(pixels, 2, 2);
+        LabLut lut(33);
+        LABBuffer lab;
+        lut.convert(buffer, lab);
+        auto labs = lut.convert(pixels);
+        REQUIRE(labs.size() == 4);
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            CHECK(lab.plane(0)[i] == labs[i].l);
+            CHECK(lab.plane(1)[i] == labs[i].a);
+            CHECK(lab.plane(2)[i] == labs[i].b);
+        }
+    }
+
+    SUBCASE("Concurrent First Use") {
+        LabLut lut(33);
+        std::vector<double> results(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < results.size(); ++t) {
+            threads.emplace_back([&lut, &results, t] { results[t] = lut.lookup(RGB(90, 160, 30)).l; });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        CHECK(results[0] == results[1]);
+        CHECK(results[1] == results[2]);
+        CHECK(results[2] == results[3]);
+    }
+}
@@ -0,0 +1,158 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include "test_helpers.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace pigment;
+using namespace test_helpers;
+
+namespace {
+    // 2x2x2 cube that inverts every channel, with the usual decorations
+    const char *inverting_cube = "# Created by hand\r\n"
+                                 "TITLE \"Invert\"\r\n"
+                                 "\r\n"
+                                 "LUT_3D_SIZE 2\r\n"
+                                 "DOMAIN_MIN 0.0 0.0 0.0\r\n"
+                                 "DOMAIN_MAX 1.0 1.0 1.0\r\n"
+                                 "1.0 1.0 1.0\r\n"
+                                 "0.0 1.0 1.0\r\n"
+                                 "1.0 0.0 1.0\r\n"
+                                 "0 0 1\r\n"
+                                 "1 1 0\r\n"
+                                 "0 1 0\r\n"
+                                 "1 0 0\r\n"
+                                 "  0.0\t0.0 0.0  \r\n";
+} // namespace
+
+TEST_CASE("3D LUTs") {
+    const PixelBuffer image = random_image(97, 31, 1);
+
+    SUBCASE("Identity tables leave colors unchanged") {
+        for (auto method : {interp::Method::Tetrahedral, interp::Method::Trilinear}) {
+            Lut3D lut(17, method);
+            PixelBuffer out;
+            lut.apply(execution::par, image, out);
+            CHECK(out.to_rgba8() == image.to_rgba8());
+        }
+        CHECK(Lut3D(33).memory_bytes() == 33 * 33 * 33 * 4 * sizeof(float));
+        CHECK_THROWS_AS(Lut3D(1), std::invalid_argument);
+    }
+
+    SUBCASE("Parsing .cube text") {
+        Lut3D lut = Lut3D::parse(inverting_cube);
+        CHECK(lut.size() == 2);
+        CHECK(lut.title() == "Invert");
+        CHECK(lut.node(1, 0, 0) == std::array<float, 3>{0.0f, 1.0f, 1.0f});
+        CHECK(lut.node(1, 1, 1) == std::array<float, 3>{0.0f, 0.0f, 0.0f});
+        CHECK(lut(RGB(0, 100, 255, 7)) == RGB(255, 155, 0, 7));
+
+        bool inverted = true;
+        for (auto method : {interp::Method::Tetrahedral, interp::Method::Trilinear}) {
+            lut.set_method(method);
+            for (size_t i = 0; i < image.size(); ++i) {
+                RGB c = image.get(i), out = lut(c);
+                inverted = inverted && out == RGB(255 - c.r, 255 - c.g, 255 - c.b, c.a);
+            }
+        }
+        CHECK(inverted);
+
+        // A domain maps its range onto the grid
+        Lut3D half = Lut3D::parse("LUT_3D_INPUT_RANGE 0 0.5\nLUT_3D_SIZE 2\n"
+                                  "0 0 0\n1 0 0\n0 1 0\n1 1 0\n0 0 1\n1 0 1\n0 1 1\n1 1 1\n");
+        CHECK(half.domain_max() == std::array<float, 3>{0.5f, 0.5f, 0.5f});
+        CHECK(half(RGB(64, 200, 0)) == RGB(128, 255, 0));
+    }
+
+    SUBCASE("Malformed files name the line") {
+        auto fails = [](const std::string &text) {
+            try {
+                Lut3D::parse(text);
+            } catch (const std::invalid_argument &e) {
+                return std::string(e.what());
+            }
+            return std::string();
+        };
+        CHECK(fails("0 0 0\n") == "Lut3D: line 1: data before LUT_3D_SIZE");
+        CHECK(fails("LUT_3D_SIZE 2\n0 0 0\n") == "Lut3D: line 2: expected LUT_3D_SIZE^3 data rows");
+        CHECK(fails("LUT_3D_SIZE 2\n0 0 zero\n") == "Lut3D: line 2: expected a number");
+        CHECK(fails("LUT_3D_SIZE 2\n0 0 0 0\n") == "Lut3D: line 2: too many values");
+        CHECK(fails("# comment\nLUT_3D_SIZE 300\n") ==
+              "Lut3D: line 2: LUT_3D_SIZE must be an integer between 2 and 256");
+        CHECK(fails("LUT_3D_SIZE 1e10\n") == "Lut3D: line 1: LUT_3D_SIZE must be an integer between 2 and 256");
+        CHECK(fails("LUT_3D_SIZE nan\n") == "Lut3D: line 1: LUT_3D_SIZE must be an integer between 2 and 256");
+        CHECK(fails("LUT_3D_SIZE 2.5\n") == "Lut3D: line 1: LUT_3D_SIZE must be an integer between 2 and 256");
+        CHECK(fails("LUT_1D_SIZE 1024\n") == "Lut3D: line 1: 1D LUTs are not supported");
+        CHECK(fails("TITLE \"empty\"\n") == "Lut3D: line 1: missing LUT_3D_SIZE");
+        CHECK(fails(std::string(inverting_cube) + "1 1 1\n").find("more data rows") != std::string::npos);
+        CHECK_THROWS_AS(Lut3D::load("/nonexistent/look.cube"), std::invalid_argument);
+    }
+
+    SUBCASE("Baking a pipeline") {
+        Pipeline grade;
+        grade.cool(0.2).adjust_contrast(0.3).brighten(0.1);
+
+        // size - 1 divides 255, so every node sits on an 8-bit value
+        Lut3D lut = Lut3D::bake(execution::par, 52, grade);
+        bool nodes_exact = true, close = true;
+        for (int v = 0; v < 256; v += 5) {
+            RGB c(v, 255 - v, (v * 3) % 256 / 5 * 5);
+            nodes_exact = nodes_exact && lut(c) == grade(c);
+        }
+        for (size_t i = 0; i < image.size(); ++i) {
+            RGB got = lut(image.get(i)), want = grade(image.get(i));
+            close = close && std::abs(got.r - want.r) <= 2 && std::abs(got.g - want.g) <= 2 &&
+                    std::abs(got.b - want.b) <= 2;
+        }
+        CHECK(nodes_exact);
+        CHECK(close);
+
+        // Bulk matches per-color for every policy and method
+        for (auto method : {interp::Method::Tetrahedral, interp::Method::Trilinear}) {
+            lut.set_method(method);
+            std::vector<RGB> expected;
+            for (size_t i = 0; i < image.size(); ++i) {
+                expected.push_back(lut(image.get(i)));
+            }
+            PixelBuffer seq, par = image;
+            lut.apply(image, seq);
+            lut.apply(execution::par.with_chunk(100), par);
+            CHECK(seq.to_rgb() == expected);
+            CHECK(par.to_rgb() == expected);
+        }
+    }
+
+    SUBCASE("Writing and loading round-trips exactly") {
+        Lut3D lut = Lut3D::bake(33, [](const RGB &c) { return HSL::fromRGB(c).adjust_hue(40).to_rgb(); });
+        std::ostringstream text;
+        lut.write(text);
+
+        const auto path = std::filesystem::temp_directory_path() / "pigment_test_lut3d.cube";
+        {
+            std::ofstream file(path);
+            file << text.str();
+        }
+        Lut3D back = Lut3D::load(path.string());
+        std::filesystem::remove(path);
+
+        bool same = back.size() == 33;
+        for (int b = 0; b < 33 && same; ++b) {
+            for (int g = 0; g < 33; ++g) {
+                for (int r = 0; r < 33; ++r) {
+                    same = same && back.node(r, g, b) == lut.node(r, g, b);
+                }
+            }
+        }
+        CHECK(same);
+
+        std::istringstream stream(text.str());
+        PixelBuffer a, b;
+        Lut3D::parse(stream).apply(image, a);
+        lut.apply(image, b);
+        CHECK(a.to_rgba8() == b.to_rgba8());
+    }
+}
@@ -17,4 +17,12 @@ TEST_CASE("MONO Color Tests") {
         MONO mid_gray = MONO::gray();
         CHECK(mid_gray.v == 128);
     }
+
+    SUBCASE("MONO Fixed-Point Arithmetic") {
+        CHECK(MONO(0, 0).mix(MONO(255, 255)) == MONO(128, 128));
+        CHECK(MONO(100).mix(MONO(200), 0.25).v == 125);
+        CHECK((MONO(201) * 0.5).v == 101);
+        CHECK(MONO(200).brighten(0.5).v == 255);
+        CHECK(MONO(100).darken(0.25).v == 75);
+    }
 }
@@ -173,9 +173,9 @@ TEST_CASE("Named Colors - Color Manipulation") {
         auto blue = pigment::colors::blue();
         auto purple = red.mix(blue);
         
-        CHECK(purple.r == 127);  // Mixing is done with integer arithmetic
+        CHECK(purple.r == 128);  // Fixed-point mixing rounds 127.5 to nearest
         CHECK(purple.g == 0);
-        CHECK(purple.b == 127);  // Mixing is done with integer arithmetic
+        CHECK(purple.b == 128);  // Fixed-point mixing rounds 127.5 to nearest
     }
 
     SUBCASE("Brighten and darken named colors") {
@@ -0,0 +1,143 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <cmath>
+#include <vector>
+
+using namespace pigment;
+
+TEST_CASE("OKLab and OKLCH") {
+    SUBCASE("Reference values") {
+        OKLAB white = OKLAB::fromRGB(RGB::white());
+        CHECK(white.l == doctest::Approx(1.0).epsilon(1e-6));
+        CHECK(std::abs(white.a) < 1e-6);
+        CHECK(std::abs(white.b) < 1e-6);
+
+        // sRGB red from Ottosson's reference implementation
+        OKLAB red = OKLAB::fromRGB(RGB(255, 0, 0));
+        CHECK(red.l == doctest::Approx(0.627955).epsilon(1e-5));
+        CHECK(red.a == doctest::Approx(0.224863).epsilon(1e-5));
+        CHECK(red.b == doctest::Approx(0.125846).epsilon(1e-5));
+
+        OKLAB black = OKLAB::fromRGB(RGB::black());
+        CHECK(std::abs(black.l) < 1e-12);
+    }
+
+    SUBCASE("Round trips") {
+        bool exact = true;
+        for (int r = 0; r < 256; r += 5) {
+            for (int g = 0; g < 256; g += 7) {
+                for (int b = 0; b < 256; b += 3) {
+                    RGB c(r, g, b, 77);
+                    exact = exact && OKLAB::fromRGB(c).to_rgb() == c && OKLCH::fromRGB(c).to_rgb() == c;
+                }
+            }
+        }
+        CHECK(exact);
+
+        // LAB input goes through XYZ without 8-bit rounding
+        RGB teal(0, 128, 128);
+        OKLAB via_lab = OKLAB::fromLAB(LAB::fromRGB(teal));
+        OKLAB direct = OKLAB::fromRGB(teal);
+        CHECK(via_lab.distance(direct) < 1e-4);
+    }
+
+    SUBCASE("OKLCH") {
+        OKLCH blue = OKLCH::fromRGB(RGB(0, 0, 255));
+        CHECK(blue.h == doctest::Approx(264.05).epsilon(1e-3));
+        OKLCH gray = OKLCH::fromRGB(RGB(128, 128, 128));
+        CHECK(gray.c < 1e-6);
+
+        // Hue interpolation takes the short arc through 0 degrees
+        OKLCH a(0.6, 0.1, 350.0), b(0.6, 0.1, 30.0);
+        CHECK(a.mix(b, 0.5).h == doctest::Approx(10.0));
+        // An achromatic end keeps the other end's hue
+        CHECK(OKLCH(0.5, 0.0, 0.0).mix(OKLCH(0.5, 0.1, 120.0), 0.5).h == doctest::Approx(120.0));
+    }
+
+    SUBCASE("Bulk conversions match per-pixel") {
+        std::vector<RGB> pixels;
+        for (int i = 0; i < 5000; ++i) {
+            pixels.emplace_back((i * 37) % 256, (i * 91) % 256, (i * 13) % 256);
+        }
+        PixelBuffer image = PixelBuffer::from_pixels(pixels, 100, 50);
+        OKLABBuffer ok;
+        bulk::rgb_to_oklab(execution::par, image, ok);
+        OKLCHBuffer lch;
+        bulk::rgb_to_oklch(image, lch);
+        bool same = true;
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            OKLAB expected = OKLAB::fromRGB(pixels[i]);
+            OKLCH expected_lch = OKLCH::fromRGB(pixels[i]);
+            same = same && ok.plane(0)[i] == expected.l && ok.plane(1)[i] == expected.a &&
+                   ok.plane(2)[i] == expected.b && lch.plane(1)[i] == expected_lch.c && lch.plane(2)[i] == expected_lch.h;
+        }
+        CHECK(same);
+
+        PixelBuffer back(100, 50), back_lch(100, 50);
+        bulk::oklab_to_rgb(ok, back);
+        bulk::oklch_to_rgb(execution::par, lch, back_lch);
+        CHECK(back.to_rgb() == image.to_rgb());
+        CHECK(back_lch.to_rgb() == image.to_rgb());
+    }
+
+    SUBCASE("Gradients") {
+        RGB blue(0, 0, 255), white = RGB::white();
+        Palette rgb = Palette::gradient(blue, white, 5);
+        Palette ok = Palette::gradient(blue, white, 5, Interpolation::OKLab);
+        REQUIRE(ok.size() == 5);
+        CHECK(ok[0] == blue);
+        CHECK(ok[4] == white);
+        // Lightness steps evenly in Oklab, unlike RGB mixing
+        double step = OKLAB::fromRGB(ok[1]).l - OKLAB::fromRGB(ok[0]).l;
+        for (size_t i = 1; i < 4; ++i) {
+            CHECK(OKLAB::fromRGB(ok[i + 1]).l - OKLAB::fromRGB(ok[i]).l == doctest::Approx(step).epsilon(0.02));
+        }
+        CHECK(rgb[2] != ok[2]);
+
+        Palette lch = Palette::gradient(execution::par, {RGB(255, 0, 0), RGB(0, 0, 255), RGB(0, 255, 0)}, 4,
+                                        Interpolation::OKLCH);
+        CHECK(lch.size() == 8);
+        CHECK(lch[0] == RGB(255, 0, 0));
+
+        // A single step is the start color in every space
+        RGB red(255, 0, 0);
+        CHECK(Palette::gradient(red, blue, 1, Interpolation::OKLab)[0] == red);
+        CHECK(Palette::gradient(red, blue, 1, Interpolation::OKLCH)[0] == red);
+        Palette single = Palette::gradient({red, blue, white}, 1, Interpolation::OKLab);
+        REQUIRE(single.size() == 2);
+        CHECK(single[0] == red);
+        CHECK(single[1] == blue);
+        CHECK(OKLAB::fromRGB(red).mix(OKLAB::fromRGB(blue), std::nan("")).to_rgb() == red);
+        CHECK(OKLCH::fromRGB(red).mix(OKLCH::fromRGB(blue), std::nan("")).to_rgb() == red);
+    }
+
+    SUBCASE("Distances and nearest color in OKLab") {
+        RGB x(200, 30, 30), y(190, 40, 35);
+        CHECK(utils::color_distance(x, y, distance::Metric::OKLab) ==
+              doctest::Approx(OKLAB::fromRGB(x).distance(OKLAB::fromRGB(y))));
+        CHECK(utils::color_distance(x, y, distance::Metric::CIE76) == utils::color_distance(x, y));
+
+        std::vector<RGB> palette;
+        for (int i = 0; i < 300; ++i) {
+            palette.emplace_back((i * 53) % 256, (i * 29) % 256, (i * 71) % 256);
+        }
+        PaletteIndex index(palette, PaletteIndex::Space::OKLab);
+        CHECK(index.space() == PaletteIndex::Space::OKLab);
+        bool matches = true;
+        for (int i = 0; i < 2000; ++i) {
+            RGB target((i * 17) % 256, (i * 101) % 256, (i * 7) % 256);
+            OKLAB t = OKLAB::fromRGB(target);
+            size_t best = 0;
+            for (size_t j = 1; j < palette.size(); ++j) {
+                if (t.distance(OKLAB::fromRGB(palette[j])) < t.distance(OKLAB::fromRGB(palette[best]))) {
+                    best = j;
+                }
+            }
+            matches = matches && index.nearest(target) == best && index.nearest(t) == best;
+        }
+        CHECK(matches);
+
+        auto m = distance::matrix(palette, distance::Metric::OKLab);
+        CHECK(m(3, 7) == doctest::Approx(OKLAB::fromRGB(palette[3]).distance(OKLAB::fromRGB(palette[7]))));
+    }
+}
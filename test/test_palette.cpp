@@ -66,6 +66,19 @@ TEST_CASE("Palette Tests") {
         CHECK(complementary.size() == 2);
     }
 
+    SUBCASE("Predefined Palette Views") {
+        static_assert(Palette::material_design_colors().size() == 16);
+        static_assert(Palette::warm_colors()[0] == RGB(0xFF, 0x6B, 0x6B));
+        static_assert(Palette::cool_colors().back() == RGB(0xDD, 0xA0, 0xDD));
+
+        // Views share the table; owning copies match it
+        CHECK(Palette::warm_colors().data() == Palette::warm_colors().data());
+        auto material = Palette::material_design();
+        auto view = Palette::material_design_colors();
+        CHECK(std::equal(material.begin(), material.end(), view.begin(), view.end()));
+        CHECK(material.colors().data() != view.data());
+    }
+
     SUBCASE("Palette Export") {
         Palette palette({RGB::red(), RGB::green(), RGB::blue()});
         auto hex_colors = palette.to_hex();
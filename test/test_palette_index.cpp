@@ -0,0 +1,83 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include "test_helpers.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace pigment;
+using namespace test_helpers;
+
+namespace {
+    // Reference scan with the same tie-breaking as utils::find_closest_color
+    size_t brute_nearest(const RGB &target, const std::vector<RGB> &palette) {
+        size_t best = 0;
+        for (size_t i = 1; i < palette.size(); ++i) {
+            if (utils::color_distance(target, palette[i]) < utils::color_distance(target, palette[best])) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+} // namespace
+
+TEST_CASE("Palette Index") {
+    std::mt19937 gen(1234);
+
+    SUBCASE("Empty palette") {
+        PaletteIndex index;
+        CHECK(index.empty());
+        CHECK(index.nearest(RGB::red()) == PaletteIndex::npos);
+        CHECK(index.nearest_color(RGB::red()) == RGB::red());
+        CHECK(index.k_nearest(RGB::red(), 3).empty());
+    }
+
+    SUBCASE("Matches the linear scan") {
+        for (size_t palette_size : {1, 2, 7, 16, 100, 1000}) {
+            std::vector<RGB> palette = random_colors(gen, palette_size);
+            PaletteIndex index(palette);
+            for (const RGB &target : random_colors(gen, 500)) {
+                size_t expected = brute_nearest(target, palette);
+                CHECK(index.nearest(target) == expected);
+                CHECK(index.nearest_color(target) == utils::find_closest_color(target, palette));
+            }
+        }
+    }
+
+    SUBCASE("Duplicates resolve to the lowest index") {
+        std::vector<RGB> palette = {RGB::blue(), RGB::red(), RGB(10, 10, 10), RGB::red(), RGB::red()};
+        PaletteIndex index(palette);
+        CHECK(index.nearest(RGB::red()) == 1);
+        CHECK(index.nearest(RGB(250, 5, 5)) == 1);
+        auto three = index.k_nearest(RGB::red(), 3);
+        CHECK(three == std::vector<size_t>{1, 3, 4});
+    }
+
+    SUBCASE("k-nearest matches a full sort") {
+        std::vector<RGB> palette = random_colors(gen, 300);
+        PaletteIndex index{Palette(palette)};
+        for (const RGB &target : random_colors(gen, 100)) {
+            std::vector<size_t> order(palette.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+                return utils::color_distance(target, palette[x]) < utils::color_distance(target, palette[y]);
+            });
+            order.resize(8);
+            CHECK(index.k_nearest(target, 8) == order);
+        }
+        CHECK(index.k_nearest(RGB::white(), 1000).size() == 300);
+    }
+
+    SUBCASE("quantize_to_palette is unchanged") {
+        std::vector<RGB> palette = random_colors(gen, 64);
+        std::vector<RGB> colors = random_colors(gen, 2000);
+        auto quantized = utils::quantize_to_palette(colors, palette);
+        REQUIRE(quantized.size() == colors.size());
+        for (size_t i = 0; i < colors.size(); ++i) {
+            CHECK(quantized[i] == palette[brute_nearest(colors[i], palette)]);
+        }
+    }
+}
@@ -103,6 +103,53 @@ TEST_CASE("Performance Tests") {
         CHECK(total_distance > 0);
         CHECK(duration.count() < 500000); // 500ms threshold
     }
+
+    SUBCASE("Blend Mode Performance") {
+        // One 1024x1024 layer per mode, the size of a large thumbnail stack entry
+        std::mt19937 gen(11);
+        PixelBuffer top(1024, 1024), bottom(1024, 1024);
+        for (size_t i = 0; i < top.size(); ++i) {
+            top.set(i, RGBA8(gen() % 256, gen() % 256, gen() % 256, gen() % 256));
+            bottom.set(i, RGBA8(gen() % 256, gen() % 256, gen() % 256, 255));
+        }
+
+        for (blend::Mode mode : blend::all_modes) {
+            PixelBuffer out = bottom;
+            auto start = std::chrono::high_resolution_clock::now();
+
+            blend::apply(mode, top, out, 0.8);
+
+            auto end = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+            INFO(blend::mode_name(mode) << ": " << duration.count() << " us");
+            CHECK(duration.count() < 200000); // 200ms threshold
+        }
+    }
+
+    SUBCASE("Color Blindness Simulation Performance") {
+        // The accessibility preview: every deficiency type over one 1024x1024 screenshot
+        std::mt19937 gen(12);
+        PixelBuffer screenshot(1024, 1024), preview;
+        for (size_t i = 0; i < screenshot.size(); ++i) {
+            screenshot.set(i, RGBA8(gen() % 256, gen() % 256, gen() % 256, 255));
+        }
+        using CB = utils::ColorBlindness;
+        CB::simulate(screenshot, preview, CB::PROTANOPIA, 1.0); // builds the transfer tables
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (int type = CB::PROTANOPIA; type <= CB::TRITANOMALY; ++type) {
+            CB::simulate(screenshot, preview, static_cast<CB::Type>(type),
+                         CB::default_severity(static_cast<CB::Type>(type)));
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        INFO(duration.count() << " us");
+        CHECK(duration.count() < 500000); // 500ms threshold
+    }
 }
 
 TEST_CASE("Memory Usage Tests") {
@@ -0,0 +1,103 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <cmath>
+#include <vector>
+
+using namespace pigment;
+
+namespace {
+    std::vector<RGB> samples() {
+        std::vector<RGB> colors;
+        for (int i = 0; i < 6000; ++i) {
+            colors.emplace_back((i * 37) % 256, (i * 91) % 256, (i * 13) % 256, (i * 7) % 256);
+        }
+        return colors;
+    }
+} // namespace
+
+TEST_CASE("Fused adjustment pipelines") {
+    const auto colors = samples();
+
+    SUBCASE("PerStep matches chained RGB methods") {
+        Pipeline tone;
+        tone.brighten(0.1).warm(0.2).adjust_contrast(0.3);
+        Pipeline gray;
+        gray.cool(0.3).adjust_contrast(-0.4).to_grayscale().mix(RGB(200, 40, 90, 10), 0.25).warm(0.5).invert();
+        Pipeline twice;
+        twice.invert().to_grayscale().darken(0.3).to_grayscale().brighten(0.7);
+
+        bool same = true;
+        for (const RGB &c : colors) {
+            same = same && tone(c) == c.brighten(0.1).warm(0.2).adjust_contrast(0.3);
+            same = same && gray(c) == c.cool(0.3)
+                                          .adjust_contrast(-0.4)
+                                          .to_grayscale()
+                                          .mix(RGB(200, 40, 90, 10), 0.25)
+                                          .warm(0.5)
+                                          .invert();
+            same = same && twice(c) == c.invert().to_grayscale().darken(0.3).to_grayscale().brighten(0.7);
+        }
+        CHECK(same);
+
+        Pipeline identity;
+        CHECK(identity.empty());
+        CHECK(identity(RGB(1, 2, 3, 4)) == RGB(1, 2, 3, 4));
+        CHECK(gray.size() == 6);
+    }
+
+    SUBCASE("Final rounds once") {
+        Pipeline step, final_(Pipeline::Rounding::Final);
+        step.darken(0.5).brighten(1.0);
+        final_.darken(0.5).brighten(1.0);
+        // 201 * 0.5 rounds to 101 per step
+        CHECK(step(RGB(201, 201, 201)).r == 202);
+        CHECK(final_(RGB(201, 201, 201)).r == 201);
+        // Clamps still apply between steps
+        CHECK(final_(RGB(255, 0, 0)).r == 255);
+
+        Pipeline chain(Pipeline::Rounding::Final);
+        chain.cool(0.2).to_grayscale().invert().mix(RGB(0, 100, 255, 0), 0.3).warm(0.1);
+        bool close = true;
+        for (const RGB &c : colors) {
+            double r = c.r, g = c.g + 255 * 0.2 * 0.1, b = std::min(255.0, c.b + 255 * 0.2 * 0.3);
+            g = std::min(g, 255.0);
+            double y = 255.0 - (0.299 * r + 0.587 * g + 0.114 * b);
+            double out[3] = {std::min(255.0, y * 0.7 + 0.0 * 0.3 + 255 * 0.1 * 0.3),
+                             std::min(255.0, y * 0.7 + 100 * 0.3 + 255 * 0.1 * 0.1), y * 0.7 + 255 * 0.3};
+            RGB got = chain(c);
+            close = close && std::abs(got.r - out[0]) <= 0.5 + 1e-9 && std::abs(got.g - out[1]) <= 0.5 + 1e-9 &&
+                    std::abs(got.b - out[2]) <= 0.5 + 1e-9 && got.a == static_cast<int>(std::round(c.a * 0.7));
+        }
+        CHECK(close);
+    }
+
+    SUBCASE("Bulk matches per-color for every policy") {
+        PixelBuffer image = PixelBuffer::from_pixels(colors, 100, 60);
+        for (auto rounding : {Pipeline::Rounding::PerStep, Pipeline::Rounding::Final}) {
+            Pipeline p(rounding);
+            p.adjust_contrast(0.2).to_grayscale().cool(0.4).mix(RGB::red(), 0.1);
+            Pipeline flat(rounding);
+            flat.brighten(0.3).invert();
+
+            std::vector<RGB> expected, expected_flat;
+            for (const RGB &c : colors) {
+                expected.push_back(p(c));
+                expected_flat.push_back(flat(c));
+            }
+
+            PixelBuffer seq, par(3, 3);
+            p.apply(image, seq);
+            p.apply(execution::par.with_chunk(777), image, par);
+            CHECK(seq.to_rgb() == expected);
+            CHECK(par.to_rgb() == expected);
+
+            PixelBuffer in_place = image;
+            flat.apply(execution::par, in_place);
+            CHECK(in_place.to_rgb() == expected_flat);
+
+            std::vector<RGB> list = colors;
+            p.apply(execution::par, list);
+            CHECK(list == expected);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <random>
+#include <vector>
+
+using namespace pigment;
+
+namespace {
+    PixelBuffer random_buffer(size_t width, size_t height) {
+        std::mt19937 gen(1234);
+        std::uniform_int_distribution<int> dist(0, 255);
+        std::vector<RGB> pixels;
+        for (size_t i = 0; i < width * height; ++i) {
+            pixels.emplace_back(dist(gen), dist(gen), dist(gen), dist(gen));
+        }
+        return PixelBuffer::from_pixels(pixels, width, height);
+    }
+} // namespace
+
+TEST_CASE("PixelBuffer Tests") {
+    SUBCASE("Planar Layout") {
+        PixelBuffer buffer(4, 3);
+        CHECK(buffer.width() == 4);
+        CHECK(buffer.height() == 3);
+        CHECK(buffer.size() == 12);
+        CHECK(buffer.plane(PixelBuffer::G) == buffer.plane(PixelBuffer::R) + 12);
+        CHECK(buffer.row(PixelBuffer::B, 2) == buffer.plane(PixelBuffer::B) + 8);
+        CHECK(buffer.get(0) == RGBA8(0, 0, 0, 255));
+
+        buffer.set(5, RGBA8(1, 2, 3, 4));
+        CHECK(buffer.at(1, 1) == RGBA8(1, 2, 3, 4));
+        CHECK(buffer.channel(PixelBuffer::A)[5] == 4);
+    }
+
+    SUBCASE("Interleaved Round Trip") {
+        std::vector<RGB> pixels = {RGB::red(), RGB::green(), RGB::blue(), RGB(10, 20, 30, 40)};
+        PixelBuffer buffer = PixelBuffer::from_pixels(pixels, 2, 2);
+        CHECK(buffer.to_rgb() == pixels);
+        CHECK(buffer.to_rgba8()[3] == RGBA8(10, 20, 30, 40));
+        CHECK_THROWS_AS(PixelBuffer::from_pixels(pixels, 3, 2), std::invalid_argument);
+    }
+
+    SUBCASE("Bulk LAB Matches Per-Pixel") {
+        PixelBuffer buffer = random_buffer(64, 32);
+        LABBuffer lab;
+        bulk::rgb_to_lab(buffer, lab);
+        CHECK(lab.width() == 64);
+        CHECK(lab.height() == 32);
+
+        PixelBuffer back(64, 32);
+        bulk::lab_to_rgb(lab, back);
+
+        bool all_equal = true;
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            LAB expected = LAB::fromRGB(buffer.get(i));
+            RGB expected_rgb = expected.to_rgb();
+            RGBA8 got = back.get(i);
+            all_equal = all_equal && lab.plane(0)[i] == expected.l && lab.plane(1)[i] == expected.a &&
+                        lab.plane(2)[i] == expected.b && got.r == expected_rgb.r && got.g == expected_rgb.g &&
+                        got.b == expected_rgb.b;
+        }
+        CHECK(all_equal);
+    }
+
+    SUBCASE("Bulk HSL Matches Per-Pixel") {
+        PixelBuffer buffer = random_buffer(64, 32);
+        HSLBuffer hsl;
+        bulk::rgb_to_hsl(buffer, hsl);
+
+        PixelBuffer back = buffer;
+        bulk::hsl_to_rgb(hsl, back);
+
+        bool all_equal = true;
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            HSL expected = HSL::fromRGB(buffer.get(i));
+            RGB expected_rgb = expected.to_rgb();
+            all_equal = all_equal && hsl.plane(0)[i] == expected.h && hsl.plane(1)[i] == expected.s &&
+                        hsl.plane(2)[i] == expected.l && RGB(back.get(i)) == expected_rgb;
+        }
+        CHECK(all_equal);
+    }
+
+    SUBCASE("Bulk HSV Matches Per-Pixel") {
+        PixelBuffer buffer = random_buffer(64, 32);
+        HSVBuffer hsv;
+        bulk::rgb_to_hsv(buffer, hsv);
+
+        PixelBuffer back = buffer;
+        bulk::hsv_to_rgb(hsv, back);
+
+        bool all_equal = true;
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            HSV expected = HSV::fromRGB(buffer.get(i));
+            RGB expected_rgb = expected.toRGB();
+            RGBA8 got = back.get(i);
+            all_equal = all_equal && hsv.plane(0)[i] == expected.h && hsv.plane(1)[i] == expected.s &&
+                        hsv.plane(2)[i] == expected.v && got.r == expected_rgb.r && got.g == expected_rgb.g &&
+                        got.b == expected_rgb.b;
+            // Alpha plane is left as it was
+            all_equal = all_equal && got.a == buffer.get(i).a;
+        }
+        CHECK(all_equal);
+    }
+}
@@ -0,0 +1,111 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace pigment;
+
+TEST_CASE("Quantizer") {
+    std::mt19937 gen(99);
+    std::uniform_int_distribution<int> channel(0, 255);
+    std::vector<RGB> palette;
+    for (int i = 0; i < 48; ++i) {
+        palette.push_back(RGB(channel(gen), channel(gen), channel(gen)));
+    }
+    // An "image" drawn from a few hundred distinct colors
+    std::vector<RGB> distinct;
+    for (int i = 0; i < 300; ++i) {
+        distinct.push_back(RGB(channel(gen), channel(gen), channel(gen)));
+    }
+    std::vector<RGB> image;
+    std::uniform_int_distribution<size_t> pick(0, distinct.size() - 1);
+    for (int i = 0; i < 20000; ++i) {
+        image.push_back(distinct[pick(gen)]);
+    }
+    PaletteIndex index(palette);
+
+    SUBCASE("Exact mode matches the index") {
+        for (int bits : {1, 3, 5, 6}) {
+            Quantizer quantizer(palette, bits);
+            auto out = quantizer.quantize(image);
+            for (size_t i = 0; i < image.size(); ++i) {
+                CHECK(out[i] == palette[index.nearest(image[i])]);
+            }
+            CHECK(quantizer.stats().lookups() == image.size());
+        }
+    }
+
+    SUBCASE("Counters") {
+        Quantizer quantizer(palette, 6);
+        CHECK(quantizer.table_size() == 262144);
+        quantizer.quantize(image);
+        const auto &stats = quantizer.stats();
+        // 300 distinct colors in a 6-bit table rarely share a slot
+        CHECK(stats.misses >= distinct.size() - 5);
+        CHECK(stats.misses <= distinct.size() + stats.evictions);
+        CHECK(stats.hit_rate() > 0.95);
+
+        quantizer.reset_stats();
+        quantizer.quantize(distinct[0]);
+        CHECK(quantizer.stats().lookups() == 1);
+
+        // A 1-bit table has 8 slots, so exact mode keeps evicting
+        Quantizer tiny(palette, 1);
+        tiny.quantize(image);
+        CHECK(tiny.stats().evictions > 1000);
+    }
+
+    SUBCASE("Approximate mode") {
+        Quantizer quantizer(palette, 6, Quantizer::Mode::Approximate);
+        auto out = quantizer.quantize(image);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < image.size(); ++i) {
+            size_t exact = index.nearest(image[i]);
+            if (out[i] != palette[exact]) {
+                ++mismatches;
+                // A near miss: the chosen entry is barely farther than the best one
+                double chosen = utils::color_distance(image[i], out[i]);
+                double best = utils::color_distance(image[i], palette[exact]);
+                CHECK(chosen - best < 3.0);
+            }
+        }
+        CHECK(mismatches < image.size() / 10);
+        // Every color in a cell shares its slot
+        CHECK(quantizer.stats().misses <= distinct.size());
+    }
+
+    SUBCASE("PixelBuffer and edge cases") {
+        PixelBuffer buffer = PixelBuffer::from_pixels(std::vector<RGB>(image.begin(), image.begin() + 100), 10, 10);
+        buffer.set(0, RGBA8(1, 2, 3, 40));
+        Quantizer quantizer(Palette({RGB::black(), RGB::white()}));
+        quantizer.quantize(buffer);
+        CHECK(buffer.get(0) == RGBA8(0, 0, 0, 40));
+
+        Quantizer empty(std::vector<RGB>{});
+        CHECK(empty.quantize(RGB::red()) == RGB::red());
+        CHECK(empty.nearest(RGB::red()) == PaletteIndex::npos);
+        CHECK(quantizer.quantize(RGB(300, 300, 300)) == RGB::white());
+        CHECK_THROWS_AS(Quantizer(palette, 9), std::invalid_argument);
+        CHECK_THROWS_AS(Quantizer(palette, 0), std::invalid_argument);
+        CHECK_THROWS_AS(Quantizer(std::shared_ptr<const PaletteIndex>()), std::invalid_argument);
+    }
+
+    SUBCASE("Quantizers can share one index") {
+        auto shared = std::make_shared<const PaletteIndex>(palette);
+        Quantizer first(shared), second(shared, 6);
+        CHECK(&first.index() == shared.get());
+        CHECK(&second.index() == shared.get());
+        CHECK(first.quantize(image) == second.quantize(image));
+    }
+
+    SUBCASE("quantize_to_palette agrees on both paths") {
+        std::vector<RGB> small(image.begin(), image.begin() + 100);
+        auto large = utils::quantize_to_palette(image, palette);
+        auto direct = utils::quantize_to_palette(small, palette);
+        for (size_t i = 0; i < small.size(); ++i) {
+            CHECK(large[i] == direct[i]);
+            CHECK(large[i] == utils::find_closest_color(small[i], palette));
+        }
+    }
+}
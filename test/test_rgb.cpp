@@ -107,6 +107,26 @@ TEST_CASE("RGB Color Tests") {
         CHECK(scaled.b == 100);
     }
 
+    SUBCASE("RGB Fixed-Point Rounding") {
+        // Channels round to nearest instead of truncating
+        CHECK(RGB(0, 0, 0, 0).mix(RGB(255, 255, 255, 255)) == RGB(128, 128, 128, 128));
+        CHECK((RGB(201, 3, 255) * 0.5) == RGB(101, 2, 128));
+        CHECK((RGB(10, 20, 30) * 1000.0) == RGB(255, 255, 255));
+        CHECK((RGB(10, 20, 30) * -1.0) == RGB(0, 0, 0));
+
+        bool close = true;
+        for (int x = 0; x < 256; x += 5) {
+            for (int y = 0; y < 256; y += 7) {
+                double exact = x * (1 - 0.3) + y * 0.3;
+                close = close && std::abs(RGB(x, y, 0).mix(RGB(y, x, 0), 0.3).r - exact) <= 0.5 + 1e-3;
+                close = close && std::abs(RGB(x, y, y).luma() - RGB(x, y, y).luminance()) <= 0.5 + 1e-3;
+            }
+            close = close && RGB(x, x, x).luma() == x && RGB(x, x, x).to_grayscale() == RGB(x, x, x);
+        }
+        CHECK(close);
+        CHECK(MONO(RGB(255, 0, 0)).v == 76);
+    }
+
     SUBCASE("RGB Brightness and Contrast") {
         RGB base(128, 128, 128);
 
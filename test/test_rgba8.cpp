@@ -0,0 +1,77 @@
+#include <cmath>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <type_traits>
+#include <vector>
+
+using namespace pigment;
+
+TEST_CASE("RGBA8 Packed Pixel Tests") {
+    SUBCASE("RGBA8 Layout") {
+        CHECK(sizeof(RGBA8) == 4);
+        CHECK(alignof(RGBA8) == 4);
+        CHECK(std::is_trivially_copyable_v<RGBA8>);
+
+        std::vector<RGBA8> frame(3840 * 2160);
+        CHECK(frame.size() * sizeof(RGBA8) == 3840u * 2160u * 4u);
+    }
+
+    SUBCASE("RGBA8 Construction") {
+        RGBA8 px;
+        CHECK(px.r == 0);
+        CHECK(px.g == 0);
+        CHECK(px.b == 0);
+        CHECK(px.a == 255);
+
+        RGBA8 orange(255, 128, 0, 200);
+        CHECK(orange.r == 255);
+        CHECK(orange.g == 128);
+        CHECK(orange.b == 0);
+        CHECK(orange.a == 200);
+    }
+
+    SUBCASE("RGBA8 RGB Round Trip") {
+        RGB original(12, 34, 56, 78);
+        RGBA8 packed(original);
+        RGB back = packed;
+        CHECK(back == original);
+
+        // Out of range channels are clamped when narrowing
+        RGBA8 clamped(RGB(300, -50, 128, 400));
+        CHECK(clamped.r == 255);
+        CHECK(clamped.g == 0);
+        CHECK(clamped.b == 128);
+        CHECK(clamped.a == 255);
+    }
+
+    SUBCASE("RGBA8 Bit Cast") {
+        RGBA8 px(0x11, 0x22, 0x33, 0x44);
+        uint32_t word = px.to_u32();
+
+        uint32_t expected;
+        std::memcpy(&expected, &px, sizeof(expected));
+        CHECK(word == expected);
+        CHECK(RGBA8::from_u32(word) == px);
+        CHECK(RGBA8::from_u32(word + 1) != px);
+    }
+
+    SUBCASE("RGBA8 With Color Spaces And Utils") {
+        RGBA8 px(180, 120, 200);
+        RGB rgb(180, 120, 200);
+
+        HSL hsl = HSL::fromRGB(px);
+        CHECK(hsl.h == HSL::fromRGB(rgb).h);
+        CHECK(hsl.s == HSL::fromRGB(rgb).s);
+
+        HSV hsv = HSV::fromRGB(px);
+        CHECK(hsv.v == HSV::fromRGB(rgb).v);
+
+        LAB lab = LAB::fromRGB(px);
+        CHECK(lab.l == LAB::fromRGB(rgb).l);
+
+        CHECK(utils::color_distance(px, rgb) == 0.0);
+        CHECK(utils::contrast_ratio(px, RGBA8(0, 0, 0)) == utils::contrast_ratio(rgb, RGB::black()));
+        CHECK(rgb == px);
+    }
+}
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include "test_helpers.hpp"
+#include <random>
+#include <vector>
+
+using namespace pigment;
+using namespace test_helpers;
+
+namespace {
+    // Every 3rd value per channel plus a ragged tail so each kernel also runs its one-lane remainder
+    PixelBuffer sample_buffer() {
+        std::vector<RGB> pixels;
+        for (int r = 0; r < 256; r += 3)
+            for (int g = 0; g < 256; g += 3)
+                for (int b = 0; b < 256; b += 3)
+                    pixels.emplace_back(r, g, b);
+        pixels.emplace_back(255, 255, 255);
+        pixels.emplace_back(255, 0, 1);
+        pixels.emplace_back(0, 0, 0);
+        return PixelBuffer::from_pixels(pixels, pixels.size(), 1);
+    }
+} // namespace
+
+TEST_CASE("SIMD Batch Kernel Tests") {
+    PixelBuffer buffer = sample_buffer();
+
+    SUBCASE("Level Detection") {
+        simd::Level detected = simd::detected_level();
+        CHECK(simd::usable_level(simd::Level::AVX512) == detected);
+        CHECK(simd::usable_level(simd::Level::Scalar) == simd::Level::Scalar);
+        CHECK(std::string(simd::level_name(simd::Level::AVX2)) == "avx2");
+    }
+
+    SUBCASE("HSV Matches Per-Pixel At Every Level") {
+        for (simd::Level level : all_levels) {
+            HSVBuffer hsv;
+            simd::rgb_to_hsv(buffer, hsv, level);
+            PixelBuffer back(buffer.width(), buffer.height());
+            simd::hsv_to_rgb(hsv, back, level);
+
+            bool all_equal = true;
+            for (size_t i = 0; i < buffer.size(); ++i) {
+                HSV expected = HSV::fromRGB(buffer.get(i));
+                RGB expected_rgb = expected.toRGB();
+                RGBA8 got = back.get(i);
+                all_equal = all_equal && hsv.plane(0)[i] == expected.h && hsv.plane(1)[i] == expected.s &&
+                            hsv.plane(2)[i] == expected.v && got.r == expected_rgb.r && got.g == expected_rgb.g &&
+                            got.b == expected_rgb.b;
+            }
+            CHECK(all_equal);
+        }
+    }
+
+    SUBCASE("HSL Matches Per-Pixel At Every Level") {
+        for (simd::Level level : all_levels) {
+            simd::HSLfBuffer hsl;
+            simd::rgb_to_hsl(buffer, hsl, level);
+            PixelBuffer back(buffer.width(), buffer.height());
+            simd::hsl_to_rgb(hsl, back, level);
+
+            double max_hue_error = 0.0;
+            double max_error = 0.0;
+            bool round_trip = true;
+            for (size_t i = 0; i < buffer.size(); ++i) {
+                HSL expected = HSL::fromRGB(buffer.get(i));
+                double dh = std::abs(hsl.plane(0)[i] - expected.h);
+                max_hue_error = std::max(max_hue_error, std::min(dh, 360.0 - dh));
+                max_error = std::max(max_error, std::abs(hsl.plane(1)[i] - expected.s));
+                max_error = std::max(max_error, std::abs(hsl.plane(2)[i] - expected.l));
+
+                RGBA8 original = buffer.get(i);
+                RGBA8 got = back.get(i);
+                round_trip = round_trip && got.r == original.r && got.g == original.g && got.b == original.b;
+            }
+            CHECK(max_hue_error < 2e-4);
+            CHECK(max_error < 2e-6);
+            CHECK(round_trip);
+        }
+    }
+
+    SUBCASE("Raw Pointer Interface") {
+        const uint8_t r[5] = {255, 0, 0, 128, 10};
+        const uint8_t g[5] = {0, 255, 0, 128, 200};
+        const uint8_t b[5] = {0, 0, 255, 128, 30};
+        float h[5], s[5], v[5];
+        simd::rgb_to_hsv(r, g, b, h, s, v, 5);
+        CHECK(h[0] == 0.0f);
+        CHECK(h[1] == 120.0f);
+        CHECK(h[2] == 240.0f);
+        CHECK(s[3] == 0.0f);
+        CHECK(v[1] == 1.0f);
+    }
+
+    SUBCASE("Fixed-Point Blend And Scale Match RGB At Every Level") {
+        std::vector<RGBA8> flipped(buffer.size());
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            RGBA8 c = buffer.get(i);
+            flipped[i] = RGBA8(c.b, c.r, c.g, static_cast<uint8_t>(i % 256));
+        }
+        PixelBuffer other = PixelBuffer::from_pixels(flipped, buffer.width(), buffer.height());
+        const std::vector<RGBA8> pixels = buffer.to_rgba8();
+
+        for (simd::Level level : all_levels) {
+            PixelBuffer mixed, scaled, brighter;
+            simd::mix(buffer, other, 0.3, mixed, level);
+            simd::scale(buffer, 0.7, scaled, level);
+            simd::scale(other, 1.35, brighter, level);
+            std::vector<RGBA8> interleaved(pixels.size());
+            simd::mix(pixels, flipped, 0.3, interleaved, level);
+
+            bool all_equal = true;
+            for (size_t i = 0; i < buffer.size(); ++i) {
+                RGB a = buffer.get(i), b = other.get(i);
+                all_equal = all_equal && RGB(mixed.get(i)) == a.mix(b, 0.3) && RGB(interleaved[i]) == a.mix(b, 0.3) &&
+                            RGB(scaled.get(i)) == a * 0.7 && RGB(brighter.get(i)) == b.brighten(0.35);
+            }
+            CHECK(all_equal);
+        }
+
+        PixelBuffer small(3, 3);
+        CHECK_THROWS_AS(simd::mix(buffer, small, 0.5, small), std::invalid_argument);
+    }
+
+    SUBCASE("CIEDE2000 Batch Matches Per-Pair At Every Level") {
+        // Random LAB values plus chroma-zero and opposite-hue pairs, which exercise the hue branches
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<double> lightness(0.0, 100.0), chroma(-128.0, 127.0);
+        std::vector<LAB> first, second;
+        for (int i = 0; i < 2003; ++i) {
+            first.emplace_back(lightness(gen), chroma(gen), chroma(gen));
+            second.emplace_back(lightness(gen), chroma(gen), chroma(gen));
+        }
+        first.emplace_back(50.0, 0.0, 0.0);
+        second.emplace_back(50.0, -1.0, 2.0);
+        first.emplace_back(50.0, 2.49, -0.001);
+        second.emplace_back(50.0, -2.49, 0.0011);
+        first.emplace_back(50.0, -0.001, 2.49);
+        second.emplace_back(50.0, 0.0009, -2.49);
+        first.emplace_back(20.0, 0.0, -30.0);
+        second.emplace_back(20.0, 0.0, -30.0);
+
+        for (simd::Level level : all_levels) {
+            std::vector<double> pairs(first.size());
+            simd::delta_e_2000(first, second, pairs, level);
+            std::vector<double> against = simd::delta_e_2000(first[0], second, level);
+            double max_error = 0.0;
+            for (size_t i = 0; i < first.size(); ++i) {
+                max_error = std::max(max_error, std::abs(pairs[i] - first[i].delta_e_2000(second[i])));
+                max_error = std::max(max_error, std::abs(against[i] - first[0].delta_e_2000(second[i])));
+            }
+            CHECK(max_error < 1e-9);
+        }
+
+        LABBuffer planar(second.size(), 1);
+        for (size_t i = 0; i < second.size(); ++i) {
+            planar.plane(0)[i] = second[i].l;
+            planar.plane(1)[i] = second[i].a;
+            planar.plane(2)[i] = second[i].b;
+        }
+        std::vector<double> from_planar;
+        simd::delta_e_2000(first[1], planar, from_planar);
+        CHECK(from_planar == simd::delta_e_2000(first[1], second));
+
+        std::vector<double> too_small(1);
+        CHECK_THROWS_AS(simd::delta_e_2000(first[0], second, too_small), std::invalid_argument);
+    }
+}
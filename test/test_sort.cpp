@@ -0,0 +1,85 @@
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace pigment;
+
+namespace {
+    std::vector<RGB> swatches(size_t n) {
+        std::mt19937 gen(11);
+        std::vector<RGB> colors;
+        for (size_t i = 0; i < n; ++i) {
+            // Coarse channels so many colors share a key and stability matters
+            colors.emplace_back(gen() % 16 * 17, gen() % 16 * 17, gen() % 16 * 17, static_cast<int>(i % 256));
+        }
+        return colors;
+    }
+
+    template <typename Key> std::vector<RGB> reference_sort(std::vector<RGB> colors, Key key) {
+        std::stable_sort(colors.begin(), colors.end(), [&](const RGB &x, const RGB &y) { return key(x) < key(y); });
+        return colors;
+    }
+} // namespace
+
+TEST_CASE("Sorting by extracted keys") {
+    const auto colors = swatches(20000);
+
+    SUBCASE("Radix sort matches a stable comparison sort") {
+        auto expect_same = [&](auto key) {
+            std::vector<RGB> sorted = colors;
+            sorting::by_key(sorted, key);
+            CHECK(sorted == reference_sort(colors, key));
+        };
+        expect_same(sorting::keys::hue);
+        expect_same(sorting::keys::saturation);
+        expect_same(sorting::keys::luminance);
+        expect_same(sorting::keys::lab_lightness);
+        expect_same(sorting::keys::oklab_lightness);
+        expect_same(sorting::keys::oklch_hue);
+        // Integer and negative keys
+        expect_same([](const RGB &c) { return c.g - c.r; });
+        expect_same([](const RGB &c) { return -static_cast<double>(c.b) / 7.0; });
+        expect_same([](const RGB &c) { return static_cast<uint8_t>(c.r); });
+    }
+
+    SUBCASE("Stable for equal keys, including signed zeros") {
+        std::vector<double> values(5000);
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = i % 3 == 0 ? -0.0 : (i % 3 == 1 ? 0.0 : -1.5);
+        }
+        auto perm = sorting::order(values, [](double v) { return v; });
+        std::vector<size_t> expected(values.size());
+        std::iota(expected.begin(), expected.end(), size_t(0));
+        std::stable_sort(expected.begin(), expected.end(), [&](size_t x, size_t y) { return values[x] < values[y]; });
+        CHECK(perm == expected);
+    }
+
+    SUBCASE("Parallel and chunked policies give the same order") {
+        execution::ThreadPool pool(4);
+        std::vector<RGB> seq = colors, par = colors, chunked = colors;
+        sorting::by_key(seq, sorting::keys::oklch_hue);
+        sorting::by_key(execution::par.on(pool), par, sorting::keys::oklch_hue);
+        sorting::by_key(execution::seq.with_chunk(1000), chunked, sorting::keys::oklch_hue);
+        CHECK(par == seq);
+        CHECK(chunked == seq);
+    }
+
+    SUBCASE("utils sorts use the same path") {
+        std::vector<RGB> by_hue = colors, by_brightness = colors;
+        utils::sort_by_hue(by_hue);
+        CHECK(by_hue == reference_sort(colors, sorting::keys::hue));
+        utils::sort_by_brightness(execution::par, by_brightness);
+        CHECK(by_brightness == reference_sort(colors, sorting::keys::luminance));
+
+        std::vector<RGB> small = {RGB(0, 0, 255), RGB(255, 0, 0), RGB(0, 255, 0)};
+        utils::sort_by_hue(small);
+        CHECK(small[0] == RGB(255, 0, 0));
+        CHECK(small[2] == RGB(0, 0, 255));
+
+        std::vector<RGB> empty;
+        utils::sort_by_saturation(empty);
+        CHECK(empty.empty());
+    }
+}
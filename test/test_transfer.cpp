@@ -0,0 +1,66 @@
+#include <cmath>
+#include <doctest/doctest.h>
+#include <pigment/pigment.hpp>
+
+using namespace pigment;
+
+TEST_CASE("Transfer Function Tests") {
+    SUBCASE("Decode Table Is Exact") {
+        bool exact = true;
+        for (int v = 0; v < 256; ++v) {
+            exact = exact && transfer::srgb_to_linear(v) == transfer::srgb_to_linear_exact(v / 255.0);
+        }
+        CHECK(exact);
+        CHECK(transfer::srgb_to_linear(0) == 0.0);
+        CHECK(transfer::srgb_to_linear(255) == 1.0);
+
+        // Out of range channels still follow the formula
+        CHECK(transfer::srgb_to_linear(300) == transfer::srgb_to_linear_exact(300 / 255.0));
+        CHECK(transfer::srgb_to_linear(-20) == transfer::srgb_to_linear_exact(-20 / 255.0));
+    }
+
+    SUBCASE("Encode Error Bound") {
+        double max_error = 0.0;
+        for (int i = 0; i <= 200000; ++i) {
+            double v = i / 200000.0;
+            max_error = std::max(max_error, std::abs(transfer::linear_to_srgb(v) - transfer::linear_to_srgb_exact(v)));
+        }
+        CHECK(max_error < 6e-7);
+        CHECK(transfer::linear_to_srgb(0.001) == transfer::linear_to_srgb_exact(0.001));
+        CHECK(transfer::linear_to_srgb(1.5) == transfer::linear_to_srgb_exact(1.5));
+        CHECK(std::isnan(transfer::linear_to_srgb(std::nan(""))));
+
+        // Decode then encode reproduces every 8-bit value
+        bool round_trip = true;
+        for (int v = 0; v < 256; ++v) {
+            round_trip = round_trip && std::lround(transfer::linear_to_srgb(transfer::srgb_to_linear(v)) * 255) == v;
+        }
+        CHECK(round_trip);
+    }
+
+    SUBCASE("Cube Root Error Bound") {
+        double max_error = 0.0;
+        for (int i = 1; i <= 200000; ++i) {
+            double x = i / 20000.0;
+            max_error = std::max(max_error, std::abs(transfer::fast_cbrt(x) - std::cbrt(x)) / std::cbrt(x));
+        }
+        CHECK(max_error < 1e-14);
+        CHECK(transfer::fast_cbrt(0.0) == 0.0);
+        CHECK(transfer::fast_cbrt(-8.0) == -2.0);
+        CHECK(std::abs(transfer::fast_cbrt(1e-150) - 1e-50) < 1e-63);
+    }
+
+    SUBCASE("LAB Uses The Transfer Layer") {
+        // White maps to L = 100 and grays stay neutral
+        LAB white = LAB::fromRGB(RGB::white());
+        CHECK(std::abs(white.l - 100.0) < 1e-4);
+        CHECK(std::abs(white.a) < 1e-4);
+
+        bool round_trip = true;
+        for (int v = 0; v < 256; v += 5) {
+            RGB color(v, 255 - v, (v * 7) % 256);
+            round_trip = round_trip && LAB::fromRGB(color).to_rgb() == color;
+        }
+        CHECK(round_trip);
+    }
+}